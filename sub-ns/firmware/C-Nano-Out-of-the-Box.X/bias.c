@@ -0,0 +1,720 @@
+/*********************************************************************
+ *
+ *              Water Monitor Bias DAC and ADC
+ *
+ *********************************************************************
+ * FileName:        bias.c
+ * Dependencies:    bias.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * DAC0 and ADC0 drivers, moved out of main.c so the sequencer and
+ * other interrupt driven code can set the bias too.
+ *
+ * ADC0 runs free on AIN1 and accumulates 2^depth samples in hardware
+ * per result.  RES is 16 bits, so above 16 samples the LSBs are
+ * dropped by the ADC.  Each result is scaled to 16 bits full scale in
+ * the RESRDY interrupt, so readers never wait.
+ *
+ * Calibration maps drive (BIAS_DAC_MAX - code) and ADC counts linearly
+ * to millivolts.  It is stored with a CRC so a blank or corrupt EEPROM
+ * falls back to nominal.
+ *
+ ********************************************************************/
+
+#include "bias.h"
+#include "protocol.h"
+#include "profile.h"
+#include <avr/eeprom.h>
+#include <util/delay.h>
+
+#define VREF_STARTUP_TIME   (50)                                                // VREF start-up time - microseconds
+#define LSB_MASK            (0x03)                                              // Mask needed to get the 2 LSb for DAC Data Register
+#define ADC_CLOCK_MAX       750000UL                                            // CLK_ADC at 24MHz / 32
+#define ADC_DIVIDERS        16
+
+static volatile uint16_t bias_dac = BIAS_DAC_MAX;
+static volatile uint16_t bias_adc = 0;                                          // Latest result, 16 bit full scale
+static uint8_t bias_adc_depth = BIAS_ADC_DEPTH_DEFAULT;                         // Only changed with ADC0 off
+static const uint8_t bias_adc_dividers[ADC_DIVIDERS] =                          // ADC_PRESC_DIVx_gc order
+{
+    2, 4, 6, 8, 10, 12, 14, 16, 20, 24, 28, 32, 40, 48, 56, 64
+};
+
+static bias_calibration_t bias_calibration = {BIAS_MV_NOMINAL, 0, BIAS_MV_NOMINAL, 0};
+
+typedef struct
+{
+    bias_calibration_t calibration;
+    uint16_t crc;
+} bias_calibration_block_t;
+
+static EEMEM bias_calibration_block_t bias_calibration_eeprom;
+
+static void VREF_init(void);
+static void DAC0_init(void);
+static void DAC0_setVal(uint16_t val);
+static void ADC0_init(void);
+static void ADC0_start(void);
+static uint16_t BIAS_CalibrationCRC(const bias_calibration_t *calibration);
+
+
+/*********************************************************************
+ * Function:        void BIAS_Initialize(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Bias DAC set to 1023 (off)
+ *
+ * Overview:        Loads calibration, starts VREF, DAC0 and ADC0
+ *
+ ********************************************************************/
+
+void BIAS_Initialize(void)
+{
+    bias_calibration_block_t block;
+
+    eeprom_read_block(&block, &bias_calibration_eeprom, sizeof(block));
+    if((block.crc == BIAS_CalibrationCRC(&block.calibration)) &&
+       (block.calibration.dac_gain != 0) && (block.calibration.adc_gain != 0))
+    {
+        bias_calibration = block.calibration;
+    }
+
+    VREF_init();
+    DAC0_init();
+    BIAS_SetDAC(BIAS_DAC_MAX);                                                  // Make sure set low to start
+    ADC0_init();
+}
+
+
+/*********************************************************************
+ * Function:        void BIAS_SetDAC(uint16_t value)
+ *
+ * PreCondition:    BIAS_Initialize()
+ *
+ * Input:           value - 0 to BIAS_DAC_MAX
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        DATAL and DATAH written together, so a write from
+ *                  an interrupt can't split a write from the main loop
+ *
+ ********************************************************************/
+
+void BIAS_SetDAC(uint16_t value)
+{
+    ENTER_CRITICAL(D);
+    DAC0_setVal(value);
+    bias_dac = value;
+    EXIT_CRITICAL(D);
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t BIAS_GetDAC(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Last value written to DAC0
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+uint16_t BIAS_GetDAC(void)
+{
+    uint16_t value;
+
+    ENTER_CRITICAL(G);
+    value = bias_dac;
+    EXIT_CRITICAL(G);
+
+    return value;
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t BIAS_ReadADC(void)
+ *
+ * PreCondition:    BIAS_Initialize(), interrupts on
+ *
+ * Input:           None
+ *
+ * Output:          12 bit BIAS_READ, averaged
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Latest accumulator result, does not wait
+ *
+ ********************************************************************/
+
+uint16_t BIAS_ReadADC(void)
+{
+    return BIAS_ReadADC16() >> 4;
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t BIAS_ReadADC16(void)
+ *
+ * PreCondition:    BIAS_Initialize(), interrupts on
+ *
+ * Input:           None
+ *
+ * Output:          BIAS_READ scaled to 16 bits, 65535 = VDD
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Same result as BIAS_ReadADC() with the extra bits
+ *                  from oversampling kept.  Below 16 samples the low
+ *                  bits are zero.
+ *
+ ********************************************************************/
+
+uint16_t BIAS_ReadADC16(void)
+{
+    uint16_t value;
+
+    ENTER_CRITICAL(A);
+    value = bias_adc;
+    EXIT_CRITICAL(A);
+
+    return value;
+}
+
+
+/*********************************************************************
+ * Function:        bool BIAS_SetAveraging(uint8_t depth)
+ *
+ * PreCondition:    BIAS_Initialize()
+ *
+ * Input:           depth - 0 to BIAS_ADC_DEPTH_MAX, 2^depth samples
+ *
+ * Output:          false if out of range
+ *
+ * Side Effects:    Restarts ADC0, the old result stays until the
+ *                  first new one
+ *
+ * Overview:        Sets the accumulator depth (SAMPNUM)
+ *
+ ********************************************************************/
+
+bool BIAS_SetAveraging(uint8_t depth)
+{
+    if(depth > BIAS_ADC_DEPTH_MAX)
+    {
+        return false;
+    }
+    ADC0.CTRLA &= ~ADC_ENABLE_bm;                                               // Aborts the conversion in progress
+    bias_adc_depth = depth;
+    ADC0_start();
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        void BIAS_EnableADC(bool enable)
+ *
+ * PreCondition:    BIAS_Initialize()
+ *
+ * Input:           enable - false stops ADC0
+ *
+ * Output:          None
+ *
+ * Side Effects:    The last result stays readable while stopped
+ *
+ * Overview:        Gates the free running conversions
+ *
+ ********************************************************************/
+
+void BIAS_EnableADC(bool enable)
+{
+    ADC0.CTRLA &= ~ADC_ENABLE_bm;
+    if(enable)
+    {
+        ADC0_start();
+    }
+}
+
+
+/*********************************************************************
+ * Function:        void BIAS_SetClock(uint32_t hz)
+ *
+ * PreCondition:    BIAS_Initialize()
+ *
+ * Input:           hz - new CLK_PER
+ *
+ * Output:          None
+ *
+ * Side Effects:    Restarts ADC0 if it was running
+ *
+ * Overview:        Smallest prescaler that keeps CLK_ADC at or below
+ *                  ADC_CLOCK_MAX, so conversion timing stays close to
+ *                  the 24MHz setting
+ *
+ ********************************************************************/
+
+void BIAS_SetClock(uint32_t hz)
+{
+    bool running = ADC0.CTRLA & ADC_ENABLE_bm;
+    uint8_t i;
+
+    for(i = 0; (i < ADC_DIVIDERS - 1) && ((hz / bias_adc_dividers[i]) > ADC_CLOCK_MAX); i++)
+    {
+        ;
+    }
+    ADC0.CTRLA &= ~ADC_ENABLE_bm;                                               // PRESC only changes while off
+    ADC0.CTRLC = i;
+    if(running)
+    {
+        ADC0_start();
+    }
+}
+
+
+/*********************************************************************
+ * Function:        uint8_t BIAS_GetAveraging(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Accumulator depth, 2^depth samples per result
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+uint8_t BIAS_GetAveraging(void)
+{
+    return bias_adc_depth;
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t BIAS_ReadMillivolts(void)
+ *
+ * PreCondition:    BIAS_Initialize(), interrupts on
+ *
+ * Input:           None
+ *
+ * Output:          BIAS_READ in mV, 0 if calibration says below 0
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Averaged ADC through the ADC calibration
+ *
+ ********************************************************************/
+
+uint16_t BIAS_ReadMillivolts(void)
+{
+    return BIAS_ADCToMillivolts(BIAS_ReadADC16());
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t BIAS_ADCToMillivolts(uint16_t counts)
+ *
+ * PreCondition:    None
+ *
+ * Input:           counts - BIAS_ReadADC16() scale
+ *
+ * Output:          mV, 0 if calibration says below 0
+ *
+ * Side Effects:    None
+ *
+ * Overview:        ADC calibration
+ *
+ ********************************************************************/
+
+uint16_t BIAS_ADCToMillivolts(uint16_t counts)
+{
+    int32_t mv;
+
+    mv = (int32_t)(((uint32_t)counts * bias_calibration.adc_gain + 0x8000) >> 16)
+       + bias_calibration.adc_offset;
+    if(mv < 0)
+    {
+        return 0;
+    }
+    return (mv > 0xFFFF) ? 0xFFFF : mv;
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t BIAS_DACFromMillivolts(uint16_t mv)
+ *
+ * PreCondition:    None
+ *
+ * Input:           mv - bias wanted
+ *
+ * Output:          DAC code, clamped to 0 - BIAS_DAC_MAX
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Inverse of the DAC calibration, rounded
+ *
+ ********************************************************************/
+
+uint16_t BIAS_DACFromMillivolts(uint16_t mv)
+{
+    int32_t span = (int32_t)mv - bias_calibration.dac_offset;
+    uint32_t drive;
+
+    if(span <= 0)
+    {
+        return BIAS_DAC_MAX;
+    }
+    drive = (((uint32_t)span << 10) + (bias_calibration.dac_gain / 2)) / bias_calibration.dac_gain;
+    if(drive > BIAS_DAC_MAX)
+    {
+        return 0;
+    }
+    return BIAS_DAC_MAX - drive;
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t BIAS_DACToMillivolts(uint16_t dac)
+ *
+ * PreCondition:    None
+ *
+ * Input:           dac - DAC code
+ *
+ * Output:          Expected bias in mV, 0 if below 0
+ *
+ * Side Effects:    None
+ *
+ * Overview:        DAC calibration
+ *
+ ********************************************************************/
+
+uint16_t BIAS_DACToMillivolts(uint16_t dac)
+{
+    int32_t mv;
+
+    if(dac > BIAS_DAC_MAX)
+    {
+        dac = BIAS_DAC_MAX;
+    }
+    mv = (int32_t)((((uint32_t)(BIAS_DAC_MAX - dac) * bias_calibration.dac_gain) + 512) >> 10)
+       + bias_calibration.dac_offset;
+    if(mv < 0)
+    {
+        return 0;
+    }
+    return (mv > 0xFFFF) ? 0xFFFF : mv;
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t BIAS_ADCFromMillivolts(uint16_t mv)
+ *
+ * PreCondition:    None
+ *
+ * Input:           mv - bias
+ *
+ * Output:          BIAS_ReadADC16() counts, clamped to 1 - 65535
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Inverse of the ADC calibration, for loop setpoints
+ *
+ ********************************************************************/
+
+uint16_t BIAS_ADCFromMillivolts(uint16_t mv)
+{
+    int32_t span = (int32_t)mv - bias_calibration.adc_offset;
+    uint32_t counts;
+
+    if(span <= 0)
+    {
+        return 1;
+    }
+    if(span >= bias_calibration.adc_gain)
+    {
+        return 0xFFFF;
+    }
+    counts = (((uint32_t)span << 16) + (bias_calibration.adc_gain / 2)) / bias_calibration.adc_gain;
+    return (counts == 0) ? 1 : counts;
+}
+
+
+/*********************************************************************
+ * Function:        bool BIAS_SetCalibration(const bias_calibration_t *calibration)
+ *
+ * PreCondition:    None
+ *
+ * Input:           calibration - new gains and offsets
+ *
+ * Output:          false if either gain is 0
+ *
+ * Side Effects:    Not saved, see BIAS_SaveCalibration()
+ *
+ * Overview:        Used from the next conversion on
+ *
+ ********************************************************************/
+
+bool BIAS_SetCalibration(const bias_calibration_t *calibration)
+{
+    if((calibration->dac_gain == 0) || (calibration->adc_gain == 0))
+    {
+        return false;
+    }
+    bias_calibration = *calibration;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        void BIAS_GetCalibration(bias_calibration_t *calibration)
+ *
+ * PreCondition:    None
+ *
+ * Input:           calibration - receives the gains and offsets in use
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+void BIAS_GetCalibration(bias_calibration_t *calibration)
+{
+    *calibration = bias_calibration;
+}
+
+
+/*********************************************************************
+ * Function:        void BIAS_SaveCalibration(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits for the EEPROM writes, only changed bytes
+ *                  are written
+ *
+ * Overview:        Keeps the calibration over power cycles
+ *
+ ********************************************************************/
+
+void BIAS_SaveCalibration(void)
+{
+    bias_calibration_block_t block;
+
+    block.calibration = bias_calibration;
+    block.crc = BIAS_CalibrationCRC(&bias_calibration);
+    eeprom_update_block(&block, &bias_calibration_eeprom, sizeof(block));
+    eeprom_busy_wait();
+}
+
+
+/*********************************************************************
+ * Function:        static uint16_t BIAS_CalibrationCRC(const bias_calibration_t *calibration)
+ *
+ * PreCondition:    None
+ *
+ * Input:           calibration - block to check
+ *
+ * Output:          CRC16 of the block
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Same CRC as the binary protocol
+ *
+ ********************************************************************/
+
+static uint16_t BIAS_CalibrationCRC(const bias_calibration_t *calibration)
+{
+    const uint8_t *data = (const uint8_t *)calibration;
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    for(i = 0; i < sizeof(*calibration); i++)
+    {
+        crc = PROTOCOL_CRC16(crc, data[i]);
+    }
+    return crc;
+}
+
+
+/*********************************************************************
+ * Function:        static void VREF_init(void); 
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Unknown yet
+ *
+ * Overview:        Configures VREF for DAC0 and ADC0 to VDD (3.3V)
+ *                  
+ ********************************************************************/
+
+static void VREF_init(void)
+{
+    VREF.DAC0REF = VREF_REFSEL_VDD_gc /* Select 3.3V VDD Voltage Reference for DAC */
+                 | VREF_ALWAYSON_bm;    /* Set the Voltage Reference in Always On mode */   
+    VREF.ADC0REF = VREF_REFSEL_VDD_gc /* Select 3.3V VDD Voltage Reference for ADC */
+                 | VREF_ALWAYSON_bm;    /* Set the Voltage Reference in Always On mode */
+    /* Wait VREF start-up time */
+    _delay_us(VREF_STARTUP_TIME);
+}
+
+
+/*********************************************************************
+ * Function:        static void DAC0_init(void); 
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Unknown yet
+ *
+ * Overview:        Enables DAC0 (the only DAC) PD6
+ *                  
+ ********************************************************************/
+
+static void DAC0_init(void)
+{
+    /* Disable digital input buffer */
+    PORTD.PIN6CTRL &= ~PORT_ISC_gm;
+    PORTD.PIN6CTRL |= PORT_ISC_INPUT_DISABLE_gc;
+    /* Disable pull-up resistor */
+    PORTD.PIN6CTRL &= ~PORT_PULLUPEN_bm;   
+    DAC0.CTRLA = DAC_ENABLE_bm          /* Enable DAC */
+               | DAC_OUTEN_bm           /* Enable output buffer */
+               | DAC_RUNSTDBY_bm;       /* Enable Run in Standby mode */
+}
+
+
+/*********************************************************************
+ * Function:        static void DAC0_setVal(uint16_t val); 
+ *
+ * PreCondition:    None
+ *
+ * Input:           DAC value to be set
+ *
+ * Output:          None
+ *
+ * Side Effects:    Unknown yet
+ *
+ * Overview:        Sets DAC Value
+ *                  
+ ********************************************************************/
+
+
+static void DAC0_setVal(uint16_t value)
+{
+    /* Store the two LSbs in DAC0.DATAL */
+    DAC0.DATAL = (value & LSB_MASK) << 6;
+    /* Store the eight MSbs in DAC0.DATAH */
+    DAC0.DATAH = value >> 2;
+}
+
+
+/*********************************************************************
+ * Function:        static void ADC0_init(void); 
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Starts free running conversions
+ *
+ * Overview:        Enables ADC
+ *                  
+ ********************************************************************/
+
+
+static void ADC0_init(void)
+{
+    
+    ADC0.CTRLC = ADC_PRESC_DIV32_gc;    // CLK_PER divided by 32, 750kHz
+    ADC0.SAMPCTRL = 32;                 // Long sample time for the divider on BIAS_READ
+    ADC0.MUXPOS = ADC_MUXPOS_AIN1_gc;   // Select ADC channel as PD1: AIN1
+    ADC0.INTCTRL = ADC_RESRDY_bm;
+    ADC0_start();
+}
+
+
+/*********************************************************************
+ * Function:        static void ADC0_start(void); 
+ *
+ * PreCondition:    ADC0 disabled
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Sets SAMPNUM and starts free running, one
+ *                  RESRDY interrupt per accumulated result
+ *                  
+ ********************************************************************/
+
+
+static void ADC0_start(void)
+{
+    ADC0.CTRLB = bias_adc_depth;        // SAMPNUM, 2^depth samples
+    ADC0.CTRLA = ADC_ENABLE_bm          // Enable ADC
+               | ADC_RESSEL_12BIT_gc    // Use 12-bit resolution
+               | ADC_FREERUN_bm;        // Next conversion starts when one ends
+    ADC0.COMMAND = ADC_STCONV_bm;
+}
+
+
+/*********************************************************************
+ * Function:        ISR(ADC0_RESRDY_vect)
+ *
+ * PreCondition:    ADC0 free running
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Reading RES clears RESRDY
+ *
+ * Overview:        Scales the accumulated result to 16 bits
+ *
+ ********************************************************************/
+
+ISR(ADC0_RESRDY_vect)
+{
+    PROFILE_START(A);
+    uint16_t result = ADC0.RES;                                                 // Clears RESRDY
+
+    if(bias_adc_depth < 4)
+    {
+        result <<= (4 - bias_adc_depth);                                        // 12 + depth bits up to 16
+    }
+    bias_adc = result;
+    PROFILE_STOP(A, PROFILE_ADC);
+}
@@ -0,0 +1,59 @@
+/*********************************************************************
+ *
+ *              Water Monitor Bias DAC and ADC Header
+ *
+ *********************************************************************
+ * FileName:        bias.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * BIAS_ADJUST = DAC0 on PD6 (10 bit, 1023 = bias off), BIAS_READ =
+ * AIN1 on PD1 (12 bit, oversampled).  Both referenced to VDD (3.3V).
+ *
+ * Millivolt conversions use a per-board gain and offset for each,
+ * kept in EEPROM.  Until a board is calibrated the nominal values
+ * assume the divide by 5 on BIAS_READ and the same span on the DAC.
+ *
+ ********************************************************************/
+
+#ifndef BIAS_H
+#define BIAS_H
+
+#include "mcc_generated_files/mcc.h"
+
+#define BIAS_DAC_MAX        1023                                                // Also the bias off value
+#define BIAS_UNCHANGED      0xFFFF                                              // Leave the DAC as it is
+#define BIAS_ADC_DEPTH_MAX      7                                               // 128 samples per result
+#define BIAS_ADC_DEPTH_DEFAULT  4                                               // 16 samples, about 1kHz results
+#define BIAS_MV_NOMINAL     16500                                               // 3.3V x 5, full scale both ways
+
+typedef struct
+{
+    uint16_t dac_gain;                                                          // mV at full drive, DAC code 0
+    int16_t dac_offset;                                                         // mV at no drive, DAC code 1023
+    uint16_t adc_gain;                                                          // mV at ADC full scale
+    int16_t adc_offset;                                                         // mV at ADC zero
+} bias_calibration_t;
+
+void BIAS_Initialize(void);                                                     // VREF, DAC0 (off) and ADC0
+void BIAS_SetDAC(uint16_t value);                                               // Safe from interrupts
+uint16_t BIAS_GetDAC(void);
+uint16_t BIAS_ReadADC(void);                                                    // 12 bit average, does not wait
+uint16_t BIAS_ReadADC16(void);                                                  // Oversampled, 16 bit full scale
+bool BIAS_SetAveraging(uint8_t depth);                                          // 2^depth samples per result
+uint8_t BIAS_GetAveraging(void);
+void BIAS_EnableADC(bool enable);                                               // Off in standby to save power
+void BIAS_SetClock(uint32_t hz);                                                // CLK_PER changed, keeps CLK_ADC
+uint16_t BIAS_ReadMillivolts(void);                                             // Calibrated BIAS_READ
+uint16_t BIAS_DACFromMillivolts(uint16_t mv);                                   // Nearest DAC code
+uint16_t BIAS_DACToMillivolts(uint16_t dac);
+uint16_t BIAS_ADCFromMillivolts(uint16_t mv);                                   // BIAS_ReadADC16() counts
+uint16_t BIAS_ADCToMillivolts(uint16_t counts);
+bool BIAS_SetCalibration(const bias_calibration_t *calibration);                // False if a gain is 0
+void BIAS_GetCalibration(bias_calibration_t *calibration);
+void BIAS_SaveCalibration(void);                                                // Writes EEPROM, waits
+
+#endif /* BIAS_H */
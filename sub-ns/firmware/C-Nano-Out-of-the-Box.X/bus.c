@@ -0,0 +1,176 @@
+/*********************************************************************
+ *
+ *              Water Monitor RS-485 Bus
+ *
+ *********************************************************************
+ * FileName:        bus.c
+ * Dependencies:    bus.h, lowpower.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * With BUS_RS485 USART0 runs 9 bit frames in multi-processor
+ * communication mode.  While MPCM is set the receiver drops every
+ * data frame in hardware, without an interrupt, so traffic for other
+ * boards never reaches the CLI.  An address frame matching this board
+ * clears MPCM until the next address frame.  The broadcast address
+ * also clears MPCM but keeps the transmitter muted, so every board
+ * acts on the command (E, D, TS...) and none of them answers.
+ *
+ * The USART drives the transceiver direction through XDIR, high from
+ * the start bit of the first frame until the last stop bit.  XDIR is
+ * not available on the ALT3 pins (PD7 is the 3V3 enable), so the bus
+ * uses the ALT1 pins: TXD PA4, RXD PA5, XDIR PA7.
+ *
+ * The host waits for the reply before addressing another board,
+ * otherwise two boards could drive the pair at once.
+ *
+ ********************************************************************/
+
+#include "bus.h"
+#include "hal.h"
+#include "lowpower.h"
+#include <avr/eeprom.h>
+
+#if BUS_RS485 && (LOWPOWER_WAKE == LOWPOWER_WAKE_PIN)
+#error LOWPOWER_WAKE_PIN watches PD5, RS-485 receives on PA5
+#endif
+
+typedef struct
+{
+    uint8_t address;
+    uint8_t check;                                                              // ~address
+} bus_address_block_t;
+
+static EEMEM bus_address_block_t bus_address_eeprom;
+static uint8_t bus_address = BUS_ADDRESS_DEFAULT;
+
+#if BUS_RS485
+static void BUS_Address(uint8_t address);
+#endif
+
+
+/*********************************************************************
+ * Function:        void BUS_Initialize(void)
+ *
+ * PreCondition:    USART0 initialized, before sei()
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    With BUS_RS485 USART0 moves to PA4/PA5/PA7 and
+ *                  stays silent until addressed
+ *
+ * Overview:        Loads the board address and sets up the bus
+ *
+ ********************************************************************/
+
+void BUS_Initialize(void)
+{
+    bus_address_block_t block;
+
+    eeprom_read_block(&block, &bus_address_eeprom, sizeof(block));
+    if(((block.check ^ block.address) == 0xFF) &&
+       (block.address >= BUS_ADDRESS_MIN) && (block.address <= BUS_ADDRESS_MAX))
+    {
+        bus_address = block.address;
+    }
+
+#if BUS_RS485
+    HAL_PinInput(&PORTD, PIN4_bm);                                              // ALT3 TXD released
+    HAL_PinOutput(&PORTA, PIN4_bm | PIN7_bm);                                   // TXD, XDIR
+    PORTMUX.USARTROUTEA = (PORTMUX.USARTROUTEA & ~PORTMUX_USART0_gm) | PORTMUX_USART0_ALT1_gc;
+    USART0.CTRLA |= USART_RS485_bm;                                             // XDIR high while transmitting
+    USART0_SetTxMute(true);
+    USART0_SetAddressMode(BUS_Address);
+#endif
+}
+
+
+/*********************************************************************
+ * Function:        bool BUS_SetAddress(uint8_t address)
+ *
+ * PreCondition:    None
+ *
+ * Input:           address - BUS_ADDRESS_MIN to BUS_ADDRESS_MAX
+ *
+ * Output:          false if out of range
+ *
+ * Side Effects:    Waits for the EEPROM write.  Takes effect from the
+ *                  next address frame, the reply in progress still
+ *                  goes out
+ *
+ * Overview:        Sets and stores the board address
+ *
+ ********************************************************************/
+
+bool BUS_SetAddress(uint8_t address)
+{
+    bus_address_block_t block;
+
+    if((address < BUS_ADDRESS_MIN) || (address > BUS_ADDRESS_MAX))
+    {
+        return false;
+    }
+    bus_address = address;
+    block.address = address;
+    block.check = ~address;
+    eeprom_update_block(&block, &bus_address_eeprom, sizeof(block));
+    eeprom_busy_wait();
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        uint8_t BUS_GetAddress(void)
+ *
+ * PreCondition:    BUS_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          Board address
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Address in use, also without BUS_RS485
+ *
+ ********************************************************************/
+
+uint8_t BUS_GetAddress(void)
+{
+    return bus_address;
+}
+
+
+#if BUS_RS485
+/*********************************************************************
+ * Function:        static void BUS_Address(uint8_t address)
+ *
+ * PreCondition:    USART0_SetAddressMode(BUS_Address)
+ *
+ * Input:           address - received address frame
+ *
+ * Output:          None
+ *
+ * Side Effects:    Changes MPCM and the transmit mute
+ *
+ * Overview:        Called from the USART0 receive interrupt
+ *
+ ********************************************************************/
+
+static void BUS_Address(uint8_t address)
+{
+    if((address == bus_address) || (address == BUS_BROADCAST))
+    {
+        USART0.CTRLB &= ~USART_MPCM_bm;                                         // Receive the data frames that follow
+        USART0_SetTxMute(address == BUS_BROADCAST);
+    }
+    else
+    {
+        USART0.CTRLB |= USART_MPCM_bm;                                          // Another board, ignore in hardware
+        USART0_SetTxMute(true);
+    }
+}
+#endif
@@ -0,0 +1,36 @@
+/*********************************************************************
+ *
+ *              Water Monitor RS-485 Bus Header
+ *
+ *********************************************************************
+ * FileName:        bus.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Several boards share one RS-485 pair.  The host sends a 9 bit address
+ * frame before each command, and only the addressed board receives it.
+ *
+ ********************************************************************/
+
+#ifndef BUS_H
+#define BUS_H
+
+#include "mcc_generated_files/mcc.h"
+
+#ifndef BUS_RS485
+#define BUS_RS485           0                                                   // 1 on boards wired for RS-485
+#endif
+
+#define BUS_BROADCAST       0                                                   // Every board listens, none replies
+#define BUS_ADDRESS_MIN     1
+#define BUS_ADDRESS_MAX     254
+#define BUS_ADDRESS_DEFAULT 1                                                   // Blank EEPROM
+
+void BUS_Initialize(void);
+bool BUS_SetAddress(uint8_t address);                                           // Stored in EEPROM
+uint8_t BUS_GetAddress(void);
+
+#endif /* BUS_H */
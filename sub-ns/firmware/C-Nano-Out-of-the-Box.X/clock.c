@@ -0,0 +1,570 @@
+/*********************************************************************
+ *
+ *              Water Monitor System Clock
+ *
+ *********************************************************************
+ * FileName:        clock.c
+ * Dependencies:    clock.h, systick.h, bias.h, trigger.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Changes the main clock, and then everything whose timing comes from
+ * CLK_PER: the USART0 BAUD register, the TCA0 trigger rate and the
+ * ADC0 prescaler.  TCB0 and TCB1 only count events and the system
+ * tick runs from 32.768kHz, so neither needs to change.
+ *
+ * On OSCHF the frequency select changes.  On EXTCLK the main clock
+ * prescaler divides by 6 instead, and OSCHF is left at 24MHz so that
+ * when clock failure detection falls back to it nothing else changes.
+ *
+ * A switch waits for the transmitter to finish so no byte changes
+ * speed part way, a byte being received at that moment is lost.
+ *
+ * The measurement counts TCB2 cycles over CLOCK_MEASURE_TICKS ticks
+ * of the RTC, so it is only as good as the RTC clock: the internal
+ * 32kHz oscillator unless the crystal is fitted.
+ *
+ ********************************************************************/
+
+#include "clock.h"
+#include "hal.h"
+#include "systick.h"
+#include "bias.h"
+#include "trigger.h"
+
+static clock_speed_t clock_speed = CLOCK_FAST;                                  // CLKCTRL_Initialize() setting
+static volatile clock_source_t clock_source = CLOCK_INTERNAL;
+static volatile bool clock_failed = false;
+static bool clock_crystal = false;
+static volatile uint16_t clock_measure_ticks = 0;                               // Left to count, first one only starts
+static volatile uint16_t clock_measure_last;
+static volatile uint32_t clock_measure_cycles;
+static bool clock_measuring = false;
+
+static void CLOCK_Internal(void);
+static bool CLOCK_Wait_Status(uint8_t mask);
+static void CLOCK_Tick(void);
+
+
+/*********************************************************************
+ * Function:        void CLOCK_Initialize(void)
+ *
+ * PreCondition:    SYSTICK_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    TCB2 claimed, one systick callback used
+ *
+ * Overview:        Starts the free running cycle counter
+ *
+ ********************************************************************/
+
+void CLOCK_Initialize(void)
+{
+    TCB2.CCMP = 0xFFFF;                                                         // Full 16 bit wrap
+    TCB2.CTRLB = TCB_CNTMODE_INT_gc;
+    TCB2.CTRLA = TCB_CLKSEL_DIV1_gc
+               | TCB_ENABLE_bm;
+    SYSTICK_AddCallback(CLOCK_Tick);
+}
+
+
+/*********************************************************************
+ * Function:        void CLOCK_Set(clock_speed_t speed)
+ *
+ * PreCondition:    USART0, ADC0 and TCA0 initialized, interrupts on
+ *
+ * Input:           speed - CLOCK_SLOW or CLOCK_FAST
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits for queued TX data to go out, restarts ADC0
+ *
+ * Overview:        Sets the clock and recomputes the clock derived
+ *                  settings, does nothing if already at that speed.
+ *                  Stays fast while the baud rate needs it
+ *
+ ********************************************************************/
+
+void CLOCK_Set(clock_speed_t speed)
+{
+    uint8_t frqsel = (speed == CLOCK_FAST) ? CLKCTRL_FRQSEL_24M_gc : CLKCTRL_FRQSEL_4M_gc;
+    uint32_t hz = (speed == CLOCK_FAST) ? CLOCK_FAST_HZ : CLOCK_SLOW_HZ;
+    int32_t error;
+    bool clk2x;
+
+    if(speed == clock_speed)
+    {
+        return;
+    }
+    if(!USART0_CheckBaud(hz, USART0_GetBaud(), &error, &clk2x))                 // 4MHz tops out at 500kbaud
+    {
+        return;
+    }
+    USART0_Flush();
+
+    ENTER_CRITICAL(C);                                                          // No RX interrupt at the old baud rate
+    if(clock_source == CLOCK_EXTERNAL)
+    {
+        ccp_write_io((void *)&(CLKCTRL.MCLKCTRLB), (speed == CLOCK_FAST) ? 0 : (CLKCTRL_PDIV_6X_gc | CLKCTRL_PEN_bm));
+    }
+    else
+    {
+        ccp_write_io((void *)&(CLKCTRL.MCLKCTRLB), 0);                          // Left set by a clock failure
+        ccp_write_io((void *)&(CLKCTRL.OSCHFCTRLA), (CLKCTRL.OSCHFCTRLA & ~CLKCTRL_FRQSEL_gm) | frqsel);
+        while(!(CLKCTRL.MCLKSTATUS & CLKCTRL_OSCHFS_bm))                        // Wait for OSCHF to settle
+        {
+            ;
+        }
+    }
+    USART0_SetBaud(hz, USART0_GetBaud());
+    clock_speed = speed;
+    EXIT_CRITICAL(C);
+
+    TRIGGER_SetClock(hz);
+    BIAS_SetClock(hz);
+}
+
+
+/*********************************************************************
+ * Function:        clock_speed_t CLOCK_Get(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          CLOCK_SLOW or CLOCK_FAST
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+clock_speed_t CLOCK_Get(void)
+{
+    return clock_speed;
+}
+
+
+/*********************************************************************
+ * Function:        uint32_t CLOCK_Hz(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          CLK_PER in Hz
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Nominal frequency of the current setting, the
+ *                  same for every source
+ *
+ ********************************************************************/
+
+uint32_t CLOCK_Hz(void)
+{
+    return (clock_speed == CLOCK_FAST) ? CLOCK_FAST_HZ : CLOCK_SLOW_HZ;
+}
+
+
+/*********************************************************************
+ * Function:        bool CLOCK_SetSource(clock_source_t source)
+ *
+ * PreCondition:    CLOCK_Initialize(), interrupts on
+ *
+ * Input:           source - CLOCK_INTERNAL, CLOCK_AUTOTUNE or
+ *                  CLOCK_EXTERNAL
+ *
+ * Output:          false if the source is not built in or did not
+ *                  start within CLOCK_START_TIMEOUT, the clock is then
+ *                  left on OSCHF without autotune
+ *
+ * Side Effects:    Clock goes to CLOCK_FAST, the main loop drops it
+ *                  again in standby.  Waits for TX to finish and for
+ *                  the source to start, up to CLOCK_START_TIMEOUT
+ *
+ * Overview:        Selects where the main clock comes from.  Once the
+ *                  crystal runs it also stays the RTC reference
+ *
+ ********************************************************************/
+
+bool CLOCK_SetSource(clock_source_t source)
+{
+    if(source > CLOCK_EXTERNAL)
+    {
+        return false;
+    }
+#if !CLOCK_XOSC32K
+    if(source == CLOCK_AUTOTUNE)
+    {
+        return false;
+    }
+#endif
+    if(source == clock_source)
+    {
+        return true;
+    }
+    CLOCK_Set(CLOCK_FAST);
+    USART0_Flush();
+    CLOCK_Internal();
+
+    if(source == CLOCK_AUTOTUNE)
+    {
+        if(!clock_crystal)
+        {
+            ccp_write_io((void *)&(CLKCTRL.XOSC32KCTRLA), CLKCTRL_CSUT_1K_gc
+                                                         | CLKCTRL_RUNSTDBY_bm   // RTC runs from it in standby
+                                                         | CLKCTRL_ENABLE_bm);
+            if(!CLOCK_Wait_Status(CLKCTRL_XOSC32KS_bm))
+            {
+                ccp_write_io((void *)&(CLKCTRL.XOSC32KCTRLA), 0);
+                return false;
+            }
+            SYSTICK_SetSource(RTC_CLKSEL_XOSC32K_gc);
+            clock_crystal = true;
+        }
+        ccp_write_io((void *)&(CLKCTRL.OSCHFCTRLA), CLKCTRL.OSCHFCTRLA | CLKCTRL_AUTOTUNE_bm);
+    }
+    else if(source == CLOCK_EXTERNAL)
+    {
+        ccp_write_io((void *)&(CLKCTRL.XOSCHFCTRLA), CLKCTRL_SELHF_EXTCLOCK_gc
+                                                    | CLKCTRL_ENABLE_bm);
+        if(!CLOCK_Wait_Status(CLKCTRL_EXTS_bm))
+        {
+            ccp_write_io((void *)&(CLKCTRL.XOSCHFCTRLA), 0);
+            return false;
+        }
+        ENTER_CRITICAL(S);
+        ccp_write_io((void *)&(CLKCTRL.MCLKCTRLA), CLKCTRL_CLKSEL_EXTCLK_gc);
+        while(CLKCTRL.MCLKSTATUS & CLKCTRL_SOSC_bm)                             // Wait for the switch
+        {
+            ;
+        }
+        HAL_ClearFlags(&CLKCTRL.MCLKINTFLAGS, CLKCTRL_CFD_bm);
+        ccp_write_io((void *)&(CLKCTRL.MCLKCTRLC), CLKCTRL_CFDSRC_CLKMAIN_gc   // Back to OSCHF if EXTCLK stops
+                                                  | CLKCTRL_CFDEN_bm);
+        ccp_write_io((void *)&(CLKCTRL.MCLKINTCTRL), CLKCTRL_CFD_bm);
+        EXIT_CRITICAL(S);
+    }
+    clock_source = source;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        clock_source_t CLOCK_GetSource(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Current main clock source
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+clock_source_t CLOCK_GetSource(void)
+{
+    return clock_source;
+}
+
+
+/*********************************************************************
+ * Function:        bool CLOCK_Crystal(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          true if the RTC runs from the 32.768kHz crystal
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Says what a measurement is against
+ *
+ ********************************************************************/
+
+bool CLOCK_Crystal(void)
+{
+    return clock_crystal;
+}
+
+
+/*********************************************************************
+ * Function:        bool CLOCK_Failed(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          true once after EXTCLK failed
+ *
+ * Side Effects:    Clears the failure
+ *
+ * Overview:        Polled from the main loop to report the fall back
+ *
+ ********************************************************************/
+
+bool CLOCK_Failed(void)
+{
+    bool failed;
+
+    ENTER_CRITICAL(F);
+    failed = clock_failed;
+    clock_failed = false;
+    EXIT_CRITICAL(F);
+
+    return failed;
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t CLOCK_Cycles(void)
+ *
+ * PreCondition:    CLOCK_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          TCB2 count, CLK_PER cycles, wraps at 65536
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For timing short code paths, subtract two reads
+ *
+ ********************************************************************/
+
+uint16_t CLOCK_Cycles(void)
+{
+    uint16_t count;
+
+    ENTER_CRITICAL(Y);
+    count = TCB2.CNT;                                                           // 16 bit read through TEMP
+    EXIT_CRITICAL(Y);
+
+    return count;
+}
+
+
+/*********************************************************************
+ * Function:        void CLOCK_Measure(void)
+ *
+ * PreCondition:    CLOCK_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Restarts a measurement in progress
+ *
+ * Overview:        Counts CLK_PER over the next CLOCK_MEASURE_TICKS
+ *                  ticks, CLOCK_MeasureDone() gives the result.  The
+ *                  clock must not change or stop meanwhile, so the
+ *                  main loop stays out of standby
+ *
+ ********************************************************************/
+
+void CLOCK_Measure(void)
+{
+    ENTER_CRITICAL(M);
+    clock_measure_cycles = 0;
+    clock_measure_ticks = CLOCK_MEASURE_TICKS + 1;                              // First tick takes the start count
+    EXIT_CRITICAL(M);
+    clock_measuring = true;
+}
+
+
+/*********************************************************************
+ * Function:        bool CLOCK_Measuring(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          true from CLOCK_Measure() until the result is read
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Keeps the clock fixed while counting
+ *
+ ********************************************************************/
+
+bool CLOCK_Measuring(void)
+{
+    return clock_measuring;
+}
+
+
+/*********************************************************************
+ * Function:        bool CLOCK_MeasureDone(uint32_t *hz, int32_t *ppm)
+ *
+ * PreCondition:    None
+ *
+ * Input:           hz - receives the measured CLK_PER
+ *                  ppm - receives (measured - CLOCK_Hz()) / CLOCK_Hz()
+ *
+ * Output:          true once per finished measurement
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Polled from the main loop
+ *
+ ********************************************************************/
+
+bool CLOCK_MeasureDone(uint32_t *hz, int32_t *ppm)
+{
+    uint32_t cycles;
+    uint16_t ticks;
+    int32_t nominal;
+
+    if(!clock_measuring)
+    {
+        return false;
+    }
+    ENTER_CRITICAL(D);
+    ticks = clock_measure_ticks;
+    cycles = clock_measure_cycles;
+    EXIT_CRITICAL(D);
+    if(ticks)
+    {
+        return false;
+    }
+    clock_measuring = false;
+
+    cycles = (uint64_t)cycles * SYSTICK_HZ / CLOCK_MEASURE_TICKS;              // Per second
+    nominal = CLOCK_Hz();
+    *hz = cycles;
+    *ppm = ((int64_t)cycles - nominal) * 1000000 / nominal;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        static void CLOCK_Internal(void)
+ *
+ * PreCondition:    CLOCK_FAST, TX finished
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    EXTCLK and clock failure detection off
+ *
+ * Overview:        Back to plain OSCHF, the crystal keeps running
+ *
+ ********************************************************************/
+
+static void CLOCK_Internal(void)
+{
+    ENTER_CRITICAL(I);
+    ccp_write_io((void *)&(CLKCTRL.MCLKINTCTRL), 0);
+    ccp_write_io((void *)&(CLKCTRL.MCLKCTRLC), 0);
+    ccp_write_io((void *)&(CLKCTRL.MCLKCTRLA), CLKCTRL_CLKSEL_OSCHF_gc);
+    while(CLKCTRL.MCLKSTATUS & CLKCTRL_SOSC_bm)                                 // Wait for the switch
+    {
+        ;
+    }
+    ccp_write_io((void *)&(CLKCTRL.XOSCHFCTRLA), 0);
+    ccp_write_io((void *)&(CLKCTRL.OSCHFCTRLA), CLKCTRL.OSCHFCTRLA & ~CLKCTRL_AUTOTUNE_bm);
+    clock_source = CLOCK_INTERNAL;
+    EXIT_CRITICAL(I);
+}
+
+
+/*********************************************************************
+ * Function:        static bool CLOCK_Wait_Status(uint8_t mask)
+ *
+ * PreCondition:    Interrupts on
+ *
+ * Input:           mask - MCLKSTATUS bit of the oscillator
+ *
+ * Output:          false if it is not stable by CLOCK_START_TIMEOUT
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Waits for an oscillator to start
+ *
+ ********************************************************************/
+
+static bool CLOCK_Wait_Status(uint8_t mask)
+{
+    uint32_t start = SYSTICK_Get();
+
+    while(!(CLKCTRL.MCLKSTATUS & mask))
+    {
+        if(SYSTICK_Expired(start, CLOCK_START_TIMEOUT))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        static void CLOCK_Tick(void)
+ *
+ * PreCondition:    Systick callback
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Adds up TCB2 cycles per tick, under 65536 at
+ *                  24MHz so the 16 bit difference never wraps
+ *
+ ********************************************************************/
+
+static void CLOCK_Tick(void)
+{
+    uint16_t now = TCB2.CNT;
+
+    if(clock_measure_ticks == 0)
+    {
+        return;
+    }
+    if(clock_measure_ticks <= CLOCK_MEASURE_TICKS)
+    {
+        clock_measure_cycles += (uint16_t)(now - clock_measure_last);
+    }
+    clock_measure_last = now;
+    clock_measure_ticks--;
+}
+
+
+/*********************************************************************
+ * Function:        ISR(CLKCTRL_CFD_vect)
+ *
+ * PreCondition:    Running from EXTCLK
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    EXTCLK switched off
+ *
+ * Overview:        Hardware has already moved the main clock to
+ *                  OSCHF at the same frequency, only the source
+ *                  changes.  CLOCK_Failed() reports it
+ *
+ ********************************************************************/
+
+ISR(CLKCTRL_CFD_vect)
+{
+    HAL_ClearFlags(&CLKCTRL.MCLKINTFLAGS, CLKCTRL_CFD_bm);
+    ccp_write_io((void *)&(CLKCTRL.MCLKINTCTRL), 0);
+    ccp_write_io((void *)&(CLKCTRL.MCLKCTRLC), 0);
+    ccp_write_io((void *)&(CLKCTRL.XOSCHFCTRLA), 0);
+    clock_source = CLOCK_INTERNAL;
+    clock_failed = true;
+}
@@ -0,0 +1,55 @@
+/*********************************************************************
+ *
+ *              Water Monitor System Clock Header
+ *
+ *********************************************************************
+ * FileName:        clock.h
+ * Dependencies:    mcc_generated_files/mcc.h, systick.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * OSCHF runs at 24MHz while the board is enabled and drops to 4MHz in
+ * standby.  F_CPU stays the 24MHz start up value, anything timed from
+ * CLK_PER at run time asks CLOCK_Hz().
+ *
+ * The main clock can instead come from a 24MHz clock on EXTCLK (PA0),
+ * or OSCHF can be autotuned to a 32.768kHz crystal.  The crystal pins
+ * are TOSC1/TOSC2 = PF0/PF1, OE0 and OE1 on this board, so autotune
+ * is only built with CLOCK_XOSC32K set for a board modified for it.
+ *
+ * TCB2 counts CLK_PER cycles, free running, for measuring the clock
+ * against the RTC.
+ *
+ ********************************************************************/
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include "mcc_generated_files/mcc.h"
+#include "systick.h"
+
+#define CLOCK_FAST_HZ       24000000UL                                          // Same as F_CPU, MCC setting
+#define CLOCK_SLOW_HZ       4000000UL                                           // 115200 baud within 0.1%
+#define CLOCK_XOSC32K       0                                                   // 1 if a crystal replaces OE0 and OE1
+#define CLOCK_START_TIMEOUT SYSTICK_MS(1000)                                    // Crystal or EXTCLK not running
+#define CLOCK_MEASURE_TICKS SYSTICK_HZ                                          // 1s gate
+
+typedef enum {CLOCK_SLOW, CLOCK_FAST} clock_speed_t;
+typedef enum {CLOCK_INTERNAL, CLOCK_AUTOTUNE, CLOCK_EXTERNAL} clock_source_t;
+
+void CLOCK_Initialize(void);                                                    // Cycle counter, after SYSTICK_Initialize()
+void CLOCK_Set(clock_speed_t speed);                                            // Waits for TX to finish
+clock_speed_t CLOCK_Get(void);
+uint32_t CLOCK_Hz(void);                                                        // CLK_PER now
+bool CLOCK_SetSource(clock_source_t source);                                    // False if not fitted or not running
+clock_source_t CLOCK_GetSource(void);
+bool CLOCK_Crystal(void);                                                       // RTC reference is the crystal
+bool CLOCK_Failed(void);                                                        // True once after EXTCLK stopped
+uint16_t CLOCK_Cycles(void);                                                    // CLK_PER cycles, wraps at 65536
+void CLOCK_Measure(void);                                                       // Starts a CLOCK_MEASURE_TICKS count
+bool CLOCK_Measuring(void);
+bool CLOCK_MeasureDone(uint32_t *hz, int32_t *ppm);                             // True once per measurement
+
+#endif /* CLOCK_H */
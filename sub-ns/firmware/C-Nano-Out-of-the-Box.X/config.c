@@ -0,0 +1,119 @@
+/*********************************************************************
+ *
+ *              Water Monitor Configuration
+ *
+ *********************************************************************
+ * FileName:        config.c
+ * Dependencies:    config.h, protocol.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * The block carries CONFIG_VERSION and a CRC16.  A blank EEPROM, a
+ * block from older firmware or a write cut short by power loss all
+ * fail the check, and the board then starts in standby as before.
+ *
+ ********************************************************************/
+
+#include "config.h"
+#include "protocol.h"
+#include <avr/eeprom.h>
+#include <stddef.h>
+
+typedef struct
+{
+    uint8_t version;
+    config_t config;
+    uint16_t crc;
+} config_block_t;
+
+static EEMEM config_block_t config_eeprom;
+
+static uint16_t CONFIG_CRC(const config_block_t *block);
+
+
+/*********************************************************************
+ * Function:        bool CONFIG_Load(config_t *config)
+ *
+ * PreCondition:    None
+ *
+ * Input:           config - receives the stored block
+ *
+ * Output:          false if there is no valid block, config undefined
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Reads and checks the stored configuration
+ *
+ ********************************************************************/
+
+bool CONFIG_Load(config_t *config)
+{
+    config_block_t block;
+
+    eeprom_read_block(&block, &config_eeprom, sizeof(block));
+    if((block.version != CONFIG_VERSION) || (block.crc != CONFIG_CRC(&block)))
+    {
+        return false;
+    }
+    *config = block.config;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        void CONFIG_Save(const config_t *config)
+ *
+ * PreCondition:    None
+ *
+ * Input:           config - operating point to keep
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits for the EEPROM writes, only changed bytes
+ *                  are written
+ *
+ * Overview:        Stores the configuration with version and CRC
+ *
+ ********************************************************************/
+
+void CONFIG_Save(const config_t *config)
+{
+    config_block_t block;
+
+    block.version = CONFIG_VERSION;
+    block.config = *config;
+    block.crc = CONFIG_CRC(&block);
+    eeprom_update_block(&block, &config_eeprom, sizeof(block));
+    eeprom_busy_wait();
+}
+
+
+/*********************************************************************
+ * Function:        static uint16_t CONFIG_CRC(const config_block_t *block)
+ *
+ * PreCondition:    None
+ *
+ * Input:           block - version and configuration
+ *
+ * Output:          CRC16 of everything before the crc field
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Same CRC as the binary protocol
+ *
+ ********************************************************************/
+
+static uint16_t CONFIG_CRC(const config_block_t *block)
+{
+    const uint8_t *data = (const uint8_t *)block;
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    for(i = 0; i < offsetof(config_block_t, crc); i++)
+    {
+        crc = PROTOCOL_CRC16(crc, data[i]);
+    }
+    return crc;
+}
@@ -0,0 +1,39 @@
+/*********************************************************************
+ *
+ *              Water Monitor Configuration Header
+ *
+ *********************************************************************
+ * FileName:        config.h
+ * Dependencies:    mcc_generated_files/mcc.h, trigger.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Operating point kept in EEPROM so a board can come back up where it
+ * was without the host replaying commands.
+ *
+ ********************************************************************/
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "mcc_generated_files/mcc.h"
+#include "trigger.h"
+
+#define CONFIG_VERSION      2                                                   // Bump when config_t changes
+
+typedef struct
+{
+    bool auto_restore;                                                          // Apply at power up
+    bool active;                                                                // Board state, E or D
+    uint8_t trigger_source;                                                     // 'I' or 'E'
+    trigger_state_t trigger;
+    uint8_t led;                                                                // 0 off, 1 to LED_COUNT
+    uint16_t bias;                                                              // DAC code
+} config_t;
+
+bool CONFIG_Load(config_t *config);                                             // False if blank, old or corrupt
+void CONFIG_Save(const config_t *config);                                       // Writes EEPROM, waits
+
+#endif /* CONFIG_H */
@@ -0,0 +1,88 @@
+/*********************************************************************
+ *
+ *              Water Monitor Hardware Abstraction Header
+ *
+ *********************************************************************
+ * FileName:        hal.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Pin access, write-one-to-clear flags and timer commands for the
+ * application.  On the AVR64DD32 these are single register writes,
+ * inlined, so the code is what it was.  Built with HAL_HOST (see
+ * host/) they go to the peripheral model instead, which applies them
+ * at once and can trace every pin change.  Plain stores can't do that
+ * on the host: a strobe or a flag clear would just sit in memory.
+ * HAL_PortWrite() moves a group of pins together, read-modify-write
+ * of the VPORT so the pins change in one single cycle OUT.
+ *
+ * Timers, DAC, ADC and the USART keep their own modules (trigger.c,
+ * bias.c, clock.c, systick.c, usart0.c) as the boundary.  On the host
+ * those build against a register file the model reads and updates.
+ *
+ ********************************************************************/
+
+#ifndef HAL_H
+#define HAL_H
+
+#include "mcc_generated_files/mcc.h"
+
+#if defined(HAL_HOST)
+
+void HAL_PinOutput(PORT_t *port, uint8_t pins);                                 // In host/sim.c
+void HAL_PinInput(PORT_t *port, uint8_t pins);
+void HAL_PinSet(PORT_t *port, uint8_t pins);
+void HAL_PinClear(PORT_t *port, uint8_t pins);
+bool HAL_PinIsSet(PORT_t *port, uint8_t pins);
+void HAL_PortWrite(VPORT_t *vport, uint8_t mask, uint8_t pins);
+void HAL_ClearFlags(register8_t *flags, uint8_t mask);
+void HAL_TimerCommand(TCA_t *timer, uint8_t command);
+
+#else
+
+static inline void HAL_PinOutput(PORT_t *port, uint8_t pins)
+{
+    port->DIRSET = pins;
+}
+
+static inline void HAL_PinInput(PORT_t *port, uint8_t pins)
+{
+    port->DIRCLR = pins;
+}
+
+static inline void HAL_PinSet(PORT_t *port, uint8_t pins)
+{
+    port->OUTSET = pins;
+}
+
+static inline void HAL_PinClear(PORT_t *port, uint8_t pins)
+{
+    port->OUTCLR = pins;
+}
+
+static inline bool HAL_PinIsSet(PORT_t *port, uint8_t pins)                     // Output latch, not the pin
+{
+    return (port->OUT & pins) != 0;
+}
+
+static inline void HAL_PortWrite(VPORT_t *vport, uint8_t mask, uint8_t pins)
+{
+    vport->OUT = (vport->OUT & ~mask) | pins;                                   // One OUT, interrupts off around it
+}
+
+static inline void HAL_ClearFlags(register8_t *flags, uint8_t mask)             // INTFLAGS, write one to clear
+{
+    *flags = mask;
+}
+
+static inline void HAL_TimerCommand(TCA_t *timer, uint8_t command)             // TCA_SINGLE_CMD_xxx_gc
+{
+    timer->SINGLE.CTRLESET = command;
+}
+
+#endif
+
+#endif /* HAL_H */
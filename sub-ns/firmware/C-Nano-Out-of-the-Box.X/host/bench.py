@@ -0,0 +1,307 @@
+#!/usr/bin/env python3
+"""Water Monitor command latency and throughput benchmark.
+
+Drives the ASCII command set over a serial port or the host build's pty
+and writes a JSON report:
+
+  commands.<C>.reply_us        last reply byte after the command was sent
+  commands.<C>.first_byte_us   first reply byte
+  commands.<C>.effect_us       first PIN, DAC or TRIG change (host build only)
+  commands.<C>.tx_bytes / rx_bytes   bytes on the wire per command
+  sustained                    closed loop commands per second over a mix
+  legacy                       back to back Tx/Sxxxx strings, the run fails if
+                               one is not dispatched without a line end
+
+Latencies are p50/p90/p99/max/mean in microseconds.  With no --port the
+host build is started with a trace file, which is where effect_us comes
+from.  The trace uses CLOCK_MONOTONIC, the same clock as
+time.monotonic_ns().
+
+  make -C host bench
+  host/bench.py --port /dev/ttyACM0 --baud 115200 --output board.json
+  host/bench.py --baseline bench.json --tolerance 0.25   # exit 1 on regression
+
+Standard library only.
+"""
+
+import argparse
+import json
+import os
+import re
+import select
+import subprocess
+import sys
+import tempfile
+import termios
+import time
+import tty
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+# Command type -> the two forms used alternately, so every one changes state,
+# and what ends the reply.  E and D wait for the power sequencer's notice.
+COMMANDS = {
+    "E": (["E"], rb"Board Active\r\n"),
+    "D": (["D"], rb"Board Standby\r\n"),
+    "T": (["TE", "TI"], rb"Trigger Source: Set \w+\r\n"),
+    "R": (["RF", "RS"], rb"Trigger Rate: Set [\w.]+\r\n"),
+    "L": (["L1", "L0"], rb"(LED on|LEDs off)\r\n"),
+    "S": (["S0600", "S0500"], rb"Bias DAC Set\r\n"),
+    "Q": (["Q"], rb"Bias ADC = .*\r\n"),
+}
+FAILED = re.compile(rb"Invalid Command!|Please Enable Board|stop first|Power Fault|Command Timeout")
+EFFECT_AFTER_NS = 1000000                                                       # Effects may trail the reply by a model step
+SUSTAINED_MIX = ["T", "R", "L", "S", "Q"]
+# Legacy fixed length commands run back to back in one write, each must
+# dispatch without a line end or the next is taken as its parameter.
+LEGACY_BACK_TO_BACK = [("TIS0700Q", rb"Trigger Source: Set Internal\r\n.*Bias DAC Set\r\n.*Bias ADC = .*\r\n"),
+                       ("S0600L1", rb"Bias DAC Set\r\n.*LED on\r\n")]
+BAUDS = {9600: termios.B9600, 19200: termios.B19200, 38400: termios.B38400,
+         57600: termios.B57600, 115200: termios.B115200, 230400: termios.B230400,
+         460800: termios.B460800, 921600: termios.B921600}
+
+
+class BenchError(Exception):
+    pass
+
+
+class Link:
+    """Raw serial line with a receive buffer, times in monotonic ns."""
+
+    def __init__(self, path, baud=None):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        if baud is not None:
+            attr = termios.tcgetattr(self.fd)
+            attr[4] = attr[5] = BAUDS[baud]
+            termios.tcsetattr(self.fd, termios.TCSANOW, attr)
+        self.rx = b""
+
+    def write(self, data):
+        os.write(self.fd, data)
+
+    def poll(self, timeout):
+        """Reads what arrives within timeout seconds, returns the time of the last read."""
+        if select.select([self.fd], [], [], timeout)[0]:
+            self.rx += os.read(self.fd, 4096)
+            return time.monotonic_ns()
+        return None
+
+    def drain(self, quiet=0.3, limit=5.0):
+        end = time.monotonic() + limit
+        while time.monotonic() < end and self.poll(quiet) is not None:
+            pass
+        self.rx = b""
+
+    def close(self):
+        os.close(self.fd)
+
+
+def run(link, text, done, timeout):
+    """One command and its reply, returns a sample dict."""
+    data = text.encode()
+    link.rx = b""
+    start = time.monotonic_ns()
+    link.write(data)
+    first = last = None
+    end = start + int(timeout * 1e9)
+    while True:
+        now = time.monotonic_ns()
+        if now > end:
+            raise BenchError("%r: no reply, got %r" % (text, link.rx[-200:]))
+        stamp = link.poll((end - now) / 1e9)
+        if stamp is None:
+            continue
+        first = first or stamp
+        last = stamp
+        if FAILED.search(link.rx):
+            link.drain()
+            raise BenchError("%r: failed, got %r" % (text, link.rx[:200] or "error reply"))
+        if re.search(done, link.rx):
+            break
+    return {"start": start, "first": first, "last": last,
+            "tx_bytes": len(data), "rx_bytes": len(link.rx)}
+
+
+def percentiles(values):
+    if not values:
+        return None
+    ordered = sorted(values)
+
+    def rank(p):                                                                # Nearest rank
+        return ordered[max(0, min(len(ordered) - 1, -(-len(ordered) * p // 100) - 1))]
+
+    return {"p50": rank(50), "p90": rank(90), "p99": rank(99), "max": ordered[-1],
+            "mean": round(sum(ordered) / len(ordered), 1), "samples": len(ordered)}
+
+
+def read_trace(path):
+    """(ns, event) for PIN, DAC and TRIG changes."""
+    events = []
+    if path is None or not os.path.exists(path):
+        return events
+    with open(path) as trace:
+        for line in trace:
+            fields = line.split()
+            if len(fields) >= 3 and fields[1] in ("PIN", "DAC", "TRIG"):
+                events.append((int(fields[0]), " ".join(fields[1:])))
+    return events
+
+
+def effect(events, start, stop):
+    for stamp, _ in events:
+        if start <= stamp < stop:
+            return (stamp - start) // 1000
+    return None
+
+
+def measure(link, iterations, timeout):
+    """Samples per command type, in an order that keeps each one valid."""
+    samples = {name: [] for name in COMMANDS}
+
+    def once(name, i):
+        forms, done = COMMANDS[name]
+        samples[name].append(run(link, forms[i % len(forms)], done, timeout))
+
+    for i in range(iterations):
+        once("E", i)
+        once("D", i)
+    once("E", 0)
+    for name in ("T", "L", "R", "S", "Q"):
+        if name == "R":
+            run(link, "L1", COMMANDS["L"][1], timeout)                          # TRIG1 runs, a rate change shows
+        for i in range(iterations):
+            once(name, i)
+    return samples
+
+
+def legacy(link, timeout):
+    """Back to back legacy commands, raises BenchError if one is not dispatched."""
+    for text, done in LEGACY_BACK_TO_BACK:
+        run(link, text, re.compile(done, re.S), timeout)
+    return [text for text, _ in LEGACY_BACK_TO_BACK]
+
+
+def sustained(link, seconds, timeout):
+    count = tx = rx = 0
+    start = time.monotonic_ns()
+    end = start + int(seconds * 1e9)
+    while time.monotonic_ns() < end:
+        name = SUSTAINED_MIX[count % len(SUSTAINED_MIX)]
+        forms, done = COMMANDS[name]
+        sample = run(link, forms[(count // len(SUSTAINED_MIX)) % len(forms)], done, timeout)
+        tx += sample["tx_bytes"]
+        rx += sample["rx_bytes"]
+        count += 1
+    elapsed = (time.monotonic_ns() - start) / 1e9
+    return {"mix": "".join(SUSTAINED_MIX), "commands": count, "seconds": round(elapsed, 3),
+            "commands_per_s": round(count / elapsed, 1),
+            "tx_bytes_per_command": round(tx / max(count, 1), 1),
+            "rx_bytes_per_command": round(rx / max(count, 1), 1)}
+
+
+def report(samples, events):
+    result = {}
+    for name, runs in samples.items():
+        effects = []
+        for sample in runs:
+            delay = effect(events, sample["start"], sample["last"] + EFFECT_AFTER_NS)
+            if delay is not None:
+                effects.append(delay)
+        result[name] = {
+            "reply_us": percentiles([(s["last"] - s["start"]) // 1000 for s in runs]),
+            "first_byte_us": percentiles([(s["first"] - s["start"]) // 1000 for s in runs]),
+            "effect_us": percentiles(effects),
+            "tx_bytes": round(sum(s["tx_bytes"] for s in runs) / len(runs), 1),
+            "rx_bytes": round(sum(s["rx_bytes"] for s in runs) / len(runs), 1),
+        }
+    return result
+
+
+def compare(current, baseline, tolerance):
+    """Regressions against a previous report, as text lines."""
+    failures = []
+    for name, stats in baseline.get("commands", {}).items():
+        for metric in ("reply_us", "effect_us"):
+            for p in ("p50", "p99"):
+                old = (stats.get(metric) or {}).get(p)
+                new = ((current["commands"].get(name) or {}).get(metric) or {}).get(p)
+                if old and new is not None and new > old * (1 + tolerance):
+                    failures.append("%s %s %s: %d us, baseline %d us" % (name, metric, p, new, old))
+    old = baseline.get("sustained", {}).get("commands_per_s")
+    new = current["sustained"]["commands_per_s"]
+    if old and new < old * (1 - tolerance):
+        failures.append("sustained: %.1f commands/s, baseline %.1f" % (new, old))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", help="serial device, default starts the host build")
+    parser.add_argument("--baud", type=int, choices=sorted(BAUDS), help="serial rate for --port")
+    parser.add_argument("--sim", default=os.path.join(HERE, "build", "watmon-sim"), help="host build binary")
+    parser.add_argument("--iterations", type=int, default=50, help="samples per command type")
+    parser.add_argument("--duration", type=float, default=5.0, help="seconds of sustained load")
+    parser.add_argument("--timeout", type=float, default=3.0, help="seconds to wait for a reply")
+    parser.add_argument("--output", help="report file, default stdout")
+    parser.add_argument("--baseline", help="earlier report, exit 1 if this one is worse")
+    parser.add_argument("--tolerance", type=float, default=0.25, help="allowed regression, fraction")
+    args = parser.parse_args()
+
+    sim = trace = None
+    scratch = tempfile.TemporaryDirectory()
+    port = args.port
+    if port is None:
+        trace = os.path.join(scratch.name, "trace.log")
+        port = os.path.join(scratch.name, "watmon")
+        env = dict(os.environ, SIM_PTY_LINK=port, SIM_TRACE=trace,
+                   SIM_EEPROM=os.path.join(scratch.name, "eeprom.bin"))
+        sim = subprocess.Popen([args.sim], env=env, stderr=subprocess.PIPE)
+        sim.stderr.readline()                                                   # "sim: USART0 on ..." once the pty is up
+
+    link = Link(port, args.baud)
+    try:
+        link.drain()                                                            # Menu at power up
+        if args.port is not None:
+            link.write(b"D")                                                    # Known state, a board may be active
+            link.drain()
+        samples = measure(link, args.iterations, args.timeout)
+        checked = legacy(link, args.timeout)
+        load = sustained(link, args.duration, args.timeout)
+        run(link, "D", COMMANDS["D"][1], args.timeout)
+    except BenchError as error:
+        print("bench: %s" % error, file=sys.stderr)
+        return 2
+    finally:
+        link.close()
+        if sim is not None:
+            sim.terminate()
+            sim.wait()
+
+    result = {
+        "target": "port" if args.port else "host",
+        "baud": args.baud,
+        "iterations": args.iterations,
+        "commands": report(samples, read_trace(trace)),
+        "sustained": load,
+        "legacy": checked,
+    }
+    scratch.cleanup()
+    text = json.dumps(result, indent=2, sort_keys=True) + "\n"
+    if args.output:
+        with open(args.output, "w") as out:
+            out.write(text)
+    else:
+        sys.stdout.write(text)
+
+    if args.baseline:
+        with open(args.baseline) as base:
+            failures = compare(result, json.load(base), args.tolerance)
+        for line in failures:
+            print("bench: regression: %s" % line, file=sys.stderr)
+        return 1 if failures else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
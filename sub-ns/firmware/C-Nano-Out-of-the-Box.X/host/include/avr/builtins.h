@@ -0,0 +1,12 @@
+/*********************************************************************
+ *
+ *              Water Monitor Host Build Builtins
+ *
+ *********************************************************************
+ * FileName:        host/include/avr/builtins.h
+ *
+ * Description:
+ *
+ * Nothing from here is used, the header only has to exist.
+ *
+ ********************************************************************/
@@ -0,0 +1,29 @@
+/*********************************************************************
+ *
+ *              Water Monitor Host Build EEPROM
+ *
+ *********************************************************************
+ * FileName:        host/include/avr/eeprom.h
+ *
+ * Description:
+ *
+ * EEMEM variables go to their own section, erased (0xFF) at start-up
+ * and loaded from the SIM_EEPROM file if there is one.  Updates are
+ * written back to the file at once.
+ *
+ ********************************************************************/
+
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define EEMEM   __attribute__((section("sim_eeprom")))
+
+void eeprom_read_block(void *dst, const void *src, size_t n);
+void eeprom_update_block(const void *src, void *dst, size_t n);
+
+#define eeprom_busy_wait()  do { } while(0)
+
+#endif /* HOST_AVR_EEPROM_H */
@@ -0,0 +1,27 @@
+/*********************************************************************
+ *
+ *              Water Monitor Host Build Interrupts
+ *
+ *********************************************************************
+ * FileName:        host/include/avr/interrupt.h
+ * Dependencies:    avr/io.h
+ *
+ * Description:
+ *
+ * An ISR is a plain function named after its vector.  host/sim.c
+ * calls it from the model step while the I bit in SREG is set, with
+ * CPUINT.STATUS LVL0EX set for the duration, like the hardware.
+ *
+ ********************************************************************/
+
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define ISR(vector, ...)    void vector(void); void vector(void)
+
+#define sei()   do { __asm__ __volatile__ ("" ::: "memory"); SREG |= CPU_I_bm; } while(0)
+#define cli()   do { SREG &= ~CPU_I_bm; __asm__ __volatile__ ("" ::: "memory"); } while(0)
+
+#endif /* HOST_AVR_INTERRUPT_H */
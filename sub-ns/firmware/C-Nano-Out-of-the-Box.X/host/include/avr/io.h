@@ -0,0 +1,730 @@
+/*********************************************************************
+ *
+ *              Water Monitor Host Build Device Header
+ *
+ *********************************************************************
+ * FileName:        host/include/avr/io.h
+ * Dependencies:    None
+ * Processor:       Linux host, models the AVR64DD32
+ * Compiler:        GCC
+ *
+ * Description:
+ *
+ * Stands in for the device header when the firmware is built with
+ * HAL_HOST.  Peripherals are plain structs in host memory, laid out
+ * like the AVR64DD32 and with its bit values, defined in host/sim.c.
+ * Only the modules and bits the firmware uses are here.
+ *
+ * The model (host/sim.c) reads the configuration registers every step
+ * and updates counters, flags and data registers the way the hardware
+ * would.  Strobes and write-one-to-clear flags go through hal.h.
+ *
+ ********************************************************************/
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define __AVR64DD32__
+
+typedef volatile uint8_t register8_t;
+typedef volatile uint16_t register16_t;
+typedef volatile uint32_t register32_t;
+
+#define _BV(bit)            (1 << (bit))
+
+#define PIN0_bm             0x01
+#define PIN1_bm             0x02
+#define PIN2_bm             0x04
+#define PIN3_bm             0x08
+#define PIN4_bm             0x10
+#define PIN5_bm             0x20
+#define PIN6_bm             0x40
+#define PIN7_bm             0x80
+
+
+/* CPU */
+
+extern volatile uint8_t SREG;                                                   // Only the I bit is used
+
+#define CPU_I_bm            0x80
+#define CPU_CCP_IOREG_gc    0xD8
+#define CPU_CCP_SPM_gc      0x9D
+#define CCP_IOREG_gc        CPU_CCP_IOREG_gc
+#define CCP_SPM_gc          CPU_CCP_SPM_gc
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t STATUS;
+    register8_t LVL0PRI;
+    register8_t LVL1VEC;
+} CPUINT_t;
+
+#define CPUINT_LVL0EX_bm    0x01
+#define CPUINT_LVL1EX_bm    0x02
+
+
+/* PORT and VPORT */
+
+typedef struct
+{
+    register8_t DIR;
+    register8_t DIRSET;
+    register8_t DIRCLR;
+    register8_t DIRTGL;
+    register8_t OUT;
+    register8_t OUTSET;
+    register8_t OUTCLR;
+    register8_t OUTTGL;
+    register8_t IN;
+    register8_t INTFLAGS;
+    register8_t PORTCTRL;
+    register8_t PINCONFIG;
+    register8_t PINCTRLUPD;
+    register8_t PINCTRLSET;
+    register8_t PINCTRLCLR;
+    register8_t reserved_0x0F;
+    register8_t PIN0CTRL;
+    register8_t PIN1CTRL;
+    register8_t PIN2CTRL;
+    register8_t PIN3CTRL;
+    register8_t PIN4CTRL;
+    register8_t PIN5CTRL;
+    register8_t PIN6CTRL;
+    register8_t PIN7CTRL;
+    register8_t EVGENCTRLA;
+    register8_t reserved_0x19[7];
+} PORT_t;
+
+typedef struct
+{
+    register8_t DIR;
+    register8_t OUT;
+    register8_t IN;
+    register8_t INTFLAGS;
+} VPORT_t;
+
+#define PORT_ISC_gm                 0x07
+#define PORT_ISC_INTDISABLE_gc      0x00
+#define PORT_ISC_BOTHEDGES_gc       0x01
+#define PORT_ISC_RISING_gc          0x02
+#define PORT_ISC_FALLING_gc         0x03
+#define PORT_ISC_INPUT_DISABLE_gc   0x04
+#define PORT_ISC_LEVEL_gc           0x05
+#define PORT_PULLUPEN_bm            0x08
+#define PORT_PULLUPEN_bp            3
+#define PORT_INLVL_bm               0x40
+#define PORT_INVEN_bm               0x80
+#define PORT_INVEN_bp               7
+
+typedef enum PORT_ISC_enum
+{
+    PORT_ISC_INTDISABLE = PORT_ISC_INTDISABLE_gc,
+    PORT_ISC_BOTHEDGES = PORT_ISC_BOTHEDGES_gc,
+    PORT_ISC_RISING = PORT_ISC_RISING_gc,
+    PORT_ISC_FALLING = PORT_ISC_FALLING_gc,
+    PORT_ISC_INPUT_DISABLE = PORT_ISC_INPUT_DISABLE_gc,
+    PORT_ISC_LEVEL = PORT_ISC_LEVEL_gc,
+} PORT_ISC_t;
+
+typedef struct
+{
+    register8_t EVSYSROUTEA;
+    register8_t CCLROUTEA;
+    register8_t USARTROUTEA;
+    register8_t USARTROUTEB;
+    register8_t SPIROUTEA;
+    register8_t TWIROUTEA;
+    register8_t TCAROUTEA;
+    register8_t TCBROUTEA;
+    register8_t TCDROUTEA;
+    register8_t ACROUTEA;
+} PORTMUX_t;
+
+#define PORTMUX_EVOUTA_bm           0x01
+#define PORTMUX_USART0_gm           0x07
+#define PORTMUX_USART0_DEFAULT_gc   0x00
+#define PORTMUX_USART0_ALT1_gc      0x01
+#define PORTMUX_USART0_ALT2_gc      0x02
+#define PORTMUX_USART0_ALT3_gc      0x03
+#define PORTMUX_USART0_ALT4_gc      0x04
+#define PORTMUX_USART0_NONE_gc      0x05
+#define PORTMUX_TCA0_gm             0x07
+#define PORTMUX_TCA0_PORTA_gc       0x00
+#define PORTMUX_TCA0_PORTC_gc       0x02
+#define PORTMUX_TCA0_PORTD_gc       0x03
+#define PORTMUX_TCA0_PORTF_gc       0x05
+
+
+/* CLKCTRL */
+
+typedef struct
+{
+    register8_t MCLKCTRLA;
+    register8_t MCLKCTRLB;
+    register8_t MCLKCTRLC;
+    register8_t MCLKINTCTRL;
+    register8_t MCLKINTFLAGS;
+    register8_t MCLKSTATUS;
+    register8_t MCLKTIMEBASE;
+    register8_t reserved_0x07;
+    register8_t OSCHFCTRLA;
+    register8_t OSCHFTUNE;
+    register8_t reserved_0x0A[14];
+    register8_t OSC32KCTRLA;
+    register8_t reserved_0x19[3];
+    register8_t XOSC32KCTRLA;
+    register8_t reserved_0x1D[3];
+    register8_t XOSCHFCTRLA;
+} CLKCTRL_t;
+
+#define CLKCTRL_CLKSEL_gm           0x0F
+#define CLKCTRL_CLKSEL_OSCHF_gc     0x00
+#define CLKCTRL_CLKSEL_OSC32K_gc    0x01
+#define CLKCTRL_CLKSEL_XOSC32K_gc   0x02
+#define CLKCTRL_CLKSEL_EXTCLK_gc    0x03
+#define CLKCTRL_PEN_bm              0x01
+#define CLKCTRL_PDIV_gm             0x1E
+#define CLKCTRL_PDIV_2X_gc          (0x00 << 1)
+#define CLKCTRL_PDIV_4X_gc          (0x01 << 1)
+#define CLKCTRL_PDIV_8X_gc          (0x02 << 1)
+#define CLKCTRL_PDIV_16X_gc         (0x03 << 1)
+#define CLKCTRL_PDIV_32X_gc         (0x04 << 1)
+#define CLKCTRL_PDIV_64X_gc         (0x05 << 1)
+#define CLKCTRL_PDIV_6X_gc          (0x08 << 1)
+#define CLKCTRL_PDIV_10X_gc         (0x09 << 1)
+#define CLKCTRL_PDIV_12X_gc         (0x0A << 1)
+#define CLKCTRL_PDIV_24X_gc         (0x0B << 1)
+#define CLKCTRL_PDIV_48X_gc         (0x0C << 1)
+#define CLKCTRL_CFDEN_bm            0x01
+#define CLKCTRL_CFDSRC_gm           0x0C
+#define CLKCTRL_CFDSRC_CLKMAIN_gc   (0x00 << 2)
+#define CLKCTRL_CFD_bm              0x01
+#define CLKCTRL_SOSC_bm             0x01
+#define CLKCTRL_OSCHFS_bm           0x02
+#define CLKCTRL_OSC32KS_bm          0x04
+#define CLKCTRL_XOSC32KS_bm         0x08
+#define CLKCTRL_EXTS_bm             0x10
+#define CLKCTRL_AUTOTUNE_bm         0x01
+#define CLKCTRL_FRQSEL_gm           0x3C
+#define CLKCTRL_FRQSEL_gp           2
+#define CLKCTRL_FRQSEL_1M_gc        (0x00 << 2)
+#define CLKCTRL_FRQSEL_2M_gc        (0x01 << 2)
+#define CLKCTRL_FRQSEL_3M_gc        (0x02 << 2)
+#define CLKCTRL_FRQSEL_4M_gc        (0x03 << 2)
+#define CLKCTRL_FRQSEL_8M_gc        (0x05 << 2)
+#define CLKCTRL_FRQSEL_12M_gc       (0x06 << 2)
+#define CLKCTRL_FRQSEL_16M_gc       (0x07 << 2)
+#define CLKCTRL_FRQSEL_20M_gc       (0x08 << 2)
+#define CLKCTRL_FRQSEL_24M_gc       (0x09 << 2)
+#define CLKCTRL_RUNSTDBY_bm         0x80
+#define CLKCTRL_ENABLE_bm           0x01
+#define CLKCTRL_CSUT_gm             0x30
+#define CLKCTRL_CSUT_1K_gc          (0x00 << 4)
+#define CLKCTRL_SELHF_bm            0x02
+#define CLKCTRL_SELHF_XTAL_gc       (0x00 << 1)
+#define CLKCTRL_SELHF_EXTCLOCK_gc   (0x01 << 1)
+
+
+/* SLPCTRL, BOD, WDT, RSTCTRL */
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t VREGCTRL;
+} SLPCTRL_t;
+
+#define SLPCTRL_SEN_bm              0x01
+#define SLPCTRL_SMODE_gm            0x06
+#define SLPCTRL_SMODE_IDLE_gc       (0x00 << 1)
+#define SLPCTRL_SMODE_STDBY_gc      (0x01 << 1)
+#define SLPCTRL_SMODE_PDOWN_gc      (0x02 << 1)
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t CTRLB;
+    register8_t reserved_0x02[6];
+    register8_t VLMCTRLA;
+    register8_t INTCTRL;
+    register8_t INTFLAGS;
+    register8_t STATUS;
+} BOD_t;
+
+#define BOD_VLMIE_bm                0x01
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t STATUS;
+} WDT_t;
+
+typedef struct
+{
+    register8_t RSTFR;
+    register8_t SWRR;
+} RSTCTRL_t;
+
+#define RSTCTRL_PORF_bm             0x01
+#define RSTCTRL_BORF_bm             0x02
+#define RSTCTRL_EXTRF_bm            0x04
+#define RSTCTRL_WDRF_bm             0x08
+#define RSTCTRL_SWRF_bm             0x10
+#define RSTCTRL_UPDIRF_bm           0x20
+#define RSTCTRL_SWRST_bm            0x01
+
+
+/* RTC */
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t STATUS;
+    register8_t INTCTRL;
+    register8_t INTFLAGS;
+    register8_t TEMP;
+    register8_t DBGCTRL;
+    register8_t CALIB;
+    register8_t CLKSEL;
+    register16_t CNT;
+    register16_t PER;
+    register16_t CMP;
+    register8_t reserved_0x0E[2];
+    register8_t PITCTRLA;
+    register8_t PITSTATUS;
+    register8_t PITINTCTRL;
+    register8_t PITINTFLAGS;
+    register8_t reserved_0x14;
+    register8_t PITDBGCTRL;
+    register8_t PITEVGENCTRLA;
+} RTC_t;
+
+#define RTC_RTCEN_bm                0x01
+#define RTC_PRESCALER_gm            0x78
+#define RTC_PRESCALER_DIV1_gc       (0x00 << 3)
+#define RTC_RUNSTDBY_bm             0x80
+#define RTC_CLKSEL_gm               0x03
+#define RTC_CLKSEL_OSC32K_gc        0x00
+#define RTC_CLKSEL_OSC1K_gc         0x01
+#define RTC_CLKSEL_XOSC32K_gc       0x02
+#define RTC_CLKSEL_EXTCLK_gc        0x03
+#define RTC_PITEN_bm                0x01
+#define RTC_PERIOD_gm               0x78
+#define RTC_PERIOD_gp               3
+#define RTC_PERIOD_OFF_gc           (0x00 << 3)
+#define RTC_PERIOD_CYC4_gc          (0x01 << 3)
+#define RTC_PERIOD_CYC8_gc          (0x02 << 3)
+#define RTC_PERIOD_CYC16_gc         (0x03 << 3)
+#define RTC_PERIOD_CYC32_gc         (0x04 << 3)
+#define RTC_PERIOD_CYC64_gc         (0x05 << 3)
+#define RTC_PERIOD_CYC32768_gc      (0x0E << 3)
+#define RTC_CTRLBUSY_bm             0x01
+#define RTC_PI_bm                   0x01
+
+
+/* EVSYS and CCL */
+
+typedef struct
+{
+    register8_t SWEVENTA;
+    register8_t reserved_0x01[15];
+    register8_t CHANNEL0;
+    register8_t CHANNEL1;
+    register8_t CHANNEL2;
+    register8_t CHANNEL3;
+    register8_t CHANNEL4;
+    register8_t CHANNEL5;
+    register8_t reserved_0x16[10];
+    register8_t USERCCLLUT0A;
+    register8_t USERCCLLUT0B;
+    register8_t USERCCLLUT1A;
+    register8_t USERCCLLUT1B;
+    register8_t USERCCLLUT2A;
+    register8_t USERCCLLUT2B;
+    register8_t USERCCLLUT3A;
+    register8_t USERCCLLUT3B;
+    register8_t USERADC0START;
+    register8_t USEREVSYSEVOUTA;
+    register8_t USEREVSYSEVOUTC;
+    register8_t USEREVSYSEVOUTD;
+    register8_t USEREVSYSEVOUTF;
+    register8_t USERUSART0IRDA;
+    register8_t USERUSART1IRDA;
+    register8_t USERTCA0CNTA;
+    register8_t USERTCA0CNTB;
+    register8_t USERTCB0CAPT;
+    register8_t USERTCB0COUNT;
+    register8_t USERTCB1CAPT;
+    register8_t USERTCB1COUNT;
+    register8_t USERTCB2CAPT;
+    register8_t USERTCB2COUNT;
+} EVSYS_t;
+
+#define EVSYS_SWEVENTA_CH0_gc               0x01
+#define EVSYS_SWEVENTA_CH1_gc               0x02
+#define EVSYS_SWEVENTA_CH2_gc               0x04
+#define EVSYS_SWEVENTA_CH3_gc               0x08
+#define EVSYS_SWEVENTA_CH4_gc               0x10
+#define EVSYS_SWEVENTA_CH5_gc               0x20
+#define EVSYS_CHANNEL_OFF_gc                0x00
+#define EVSYS_CHANNEL0_PORTA_PIN3_gc        0x43
+#define EVSYS_CHANNEL1_TCA0_CMP0_LCMP0_gc   0x84
+#define EVSYS_CHANNEL2_PORTC_PIN3_gc        0x43
+#define EVSYS_CHANNEL3_TCB0_OVF_gc          0xA1
+#define EVSYS_CHANNEL4_TCB1_CAPT_gc         0xA2
+#define EVSYS_USER_OFF_gc                   0x00
+#define EVSYS_USER_CHANNEL0_gc              0x01
+#define EVSYS_USER_CHANNEL1_gc              0x02
+#define EVSYS_USER_CHANNEL2_gc              0x03
+#define EVSYS_USER_CHANNEL3_gc              0x04
+#define EVSYS_USER_CHANNEL4_gc              0x05
+#define EVSYS_USER_CHANNEL5_gc              0x06
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t SEQCTRL0;
+    register8_t SEQCTRL1;
+    register8_t reserved_0x03[2];
+    register8_t INTCTRL0;
+    register8_t reserved_0x06;
+    register8_t INTFLAGS;
+    register8_t LUT0CTRLA;
+    register8_t LUT0CTRLB;
+    register8_t LUT0CTRLC;
+    register8_t TRUTH0;
+    register8_t LUT1CTRLA;
+    register8_t LUT1CTRLB;
+    register8_t LUT1CTRLC;
+    register8_t TRUTH1;
+    register8_t LUT2CTRLA;
+    register8_t LUT2CTRLB;
+    register8_t LUT2CTRLC;
+    register8_t TRUTH2;
+    register8_t LUT3CTRLA;
+    register8_t LUT3CTRLB;
+    register8_t LUT3CTRLC;
+    register8_t TRUTH3;
+} CCL_t;
+
+#define CCL_ENABLE_bm               0x01
+#define CCL_OUTEN_bm                0x40
+#define CCL_INSEL0_gm               0x0F
+#define CCL_INSEL0_MASK_gc          0x00
+#define CCL_INSEL0_LINK_gc          0x02
+#define CCL_INSEL0_EVENTA_gc        0x03
+#define CCL_INSEL0_TCA0_gc          0x08
+#define CCL_INSEL1_gm               0xF0
+#define CCL_INSEL1_MASK_gc          0x00
+#define CCL_INSEL1_LINK_gc          0x20
+#define CCL_INSEL1_EVENTA_gc        0x30
+#define CCL_INSEL1_TCA0_gc          0x80
+#define CCL_INSEL2_gm               0x0F
+#define CCL_INSEL2_MASK_gc          0x00
+#define CCL_INSEL2_EVENTA_gc        0x03
+#define CCL_INSEL2_TCA0_gc          0x08
+#define CCL_SEQSEL_gm               0x0F
+#define CCL_SEQSEL_DISABLE_gc       0x00
+#define CCL_SEQSEL_DFF_gc           0x01
+#define CCL_SEQSEL_JK_gc            0x02
+#define CCL_SEQSEL_LATCH_gc         0x03
+#define CCL_SEQSEL_RS_gc            0x04
+
+
+/* TCA */
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t CTRLB;
+    register8_t CTRLC;
+    register8_t CTRLD;
+    register8_t CTRLECLR;
+    register8_t CTRLESET;
+    register8_t CTRLFCLR;
+    register8_t CTRLFSET;
+    register8_t EVCTRL;
+    register8_t INTCTRL;
+    register8_t INTFLAGS;
+    register8_t reserved_0x0B[3];
+    register8_t DBGCTRL;
+    register8_t TEMP;
+    register8_t reserved_0x10[16];
+    register16_t CNT;
+    register8_t reserved_0x22[4];
+    register16_t PER;
+    register16_t CMP0;
+    register16_t CMP1;
+    register16_t CMP2;
+    register8_t reserved_0x2E[8];
+    register16_t PERBUF;
+    volatile uint32_t CMP0BUF;                                                  // Host only, bit 16 set while BUFV is clear
+    register16_t CMP1BUF;
+    register16_t CMP2BUF;
+    register8_t reserved_0x3E[2];
+} TCA_SINGLE_t;
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t CTRLB;
+    register8_t CTRLC;
+    register8_t CTRLD;
+    register8_t CTRLECLR;
+    register8_t CTRLESET;
+    register8_t reserved_0x06[4];
+    register8_t INTCTRL;
+    register8_t INTFLAGS;
+    register8_t reserved_0x0C[2];
+    register8_t DBGCTRL;
+    register8_t reserved_0x0F[17];
+    register8_t LCNT;
+    register8_t HCNT;
+    register8_t reserved_0x22[4];
+    register8_t LPER;
+    register8_t HPER;
+    register8_t LCMP0;
+    register8_t HCMP0;
+    register8_t LCMP1;
+    register8_t HCMP1;
+    register8_t LCMP2;
+    register8_t HCMP2;
+    register8_t reserved_0x2E[18];
+} TCA_SPLIT_t;
+
+typedef union
+{
+    TCA_SINGLE_t SINGLE;
+    TCA_SPLIT_t SPLIT;
+} TCA_t;
+
+#define TCA_SINGLE_ENABLE_bm                    0x01
+#define TCA_SINGLE_CLKSEL_gm                    0x0E
+#define TCA_SINGLE_CLKSEL_gp                    1
+#define TCA_SINGLE_CLKSEL_DIV1_gc               (0x00 << 1)
+#define TCA_SINGLE_CLKSEL_DIV2_gc               (0x01 << 1)
+#define TCA_SINGLE_CLKSEL_DIV4_gc               (0x02 << 1)
+#define TCA_SINGLE_CLKSEL_DIV8_gc               (0x03 << 1)
+#define TCA_SINGLE_CLKSEL_DIV16_gc              (0x04 << 1)
+#define TCA_SINGLE_CLKSEL_DIV64_gc              (0x05 << 1)
+#define TCA_SINGLE_CLKSEL_DIV256_gc             (0x06 << 1)
+#define TCA_SINGLE_CLKSEL_DIV1024_gc            (0x07 << 1)
+#define TCA_SINGLE_RUNSTDBY_bm                  0x80
+#define TCA_SINGLE_WGMODE_gm                    0x07
+#define TCA_SINGLE_WGMODE_NORMAL_gc             0x00
+#define TCA_SINGLE_WGMODE_SINGLESLOPE_gc        0x03
+#define TCA_SINGLE_CMP0EN_bm                    0x10
+#define TCA_SINGLE_CMP2EN_bm                    0x40
+#define TCA_SINGLE_SPLITM_bm                    0x01
+#define TCA_SINGLE_CMD_gm                       0x0C
+#define TCA_SINGLE_CMD_NONE_gc                  (0x00 << 2)
+#define TCA_SINGLE_CMD_UPDATE_gc                (0x01 << 2)
+#define TCA_SINGLE_CMD_RESTART_gc               (0x02 << 2)
+#define TCA_SINGLE_CMD_RESET_gc                 (0x03 << 2)
+#define TCA_SINGLE_CNTAEI_bm                    0x01
+#define TCA_SINGLE_CNTBEI_bm                    0x10
+#define TCA_SINGLE_EVACTB_gm                    0xE0
+#define TCA_SINGLE_EVACTB_RESTART_POSEDGE_gc    (0x04 << 5)
+#define TCA_SINGLE_OVF_bm                       0x01
+#define TCA_SINGLE_CMP0_bm                      0x10
+
+#define TCA_SPLIT_ENABLE_bm                     0x01
+#define TCA_SPLIT_CLKSEL_gm                     0x0E
+#define TCA_SPLIT_CLKSEL_DIV1_gc                (0x00 << 1)
+#define TCA_SPLIT_CLKSEL_DIV2_gc                (0x01 << 1)
+#define TCA_SPLIT_CLKSEL_DIV4_gc                (0x02 << 1)
+#define TCA_SPLIT_CLKSEL_DIV8_gc                (0x03 << 1)
+#define TCA_SPLIT_CLKSEL_DIV16_gc               (0x04 << 1)
+#define TCA_SPLIT_CLKSEL_DIV64_gc               (0x05 << 1)
+#define TCA_SPLIT_CLKSEL_DIV256_gc              (0x06 << 1)
+#define TCA_SPLIT_CLKSEL_DIV1024_gc             (0x07 << 1)
+#define TCA_SPLIT_SPLITM_bm                     0x01
+#define TCA_SPLIT_HCMP0EN_bm                    0x10
+#define TCA_SPLIT_HUNF_bm                       0x02
+
+
+/* TCB */
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t CTRLB;
+    register8_t reserved_0x02[2];
+    register8_t EVCTRL;
+    register8_t INTCTRL;
+    register8_t INTFLAGS;
+    register8_t STATUS;
+    register8_t DBGCTRL;
+    register8_t TEMP;
+    register16_t CNT;
+    register16_t CCMP;
+    register8_t reserved_0x0E[2];
+} TCB_t;
+
+#define TCB_ENABLE_bm               0x01
+#define TCB_CLKSEL_gm               0x0E
+#define TCB_CLKSEL_DIV1_gc          (0x00 << 1)
+#define TCB_CLKSEL_DIV2_gc          (0x01 << 1)
+#define TCB_CLKSEL_TCA0_gc          (0x02 << 1)
+#define TCB_CLKSEL_EVENT_gc         (0x07 << 1)
+#define TCB_SYNCUPD_bm              0x10
+#define TCB_CASCADE_bm              0x20
+#define TCB_RUNSTDBY_bm             0x40
+#define TCB_CNTMODE_gm              0x07
+#define TCB_CNTMODE_INT_gc          0x00
+#define TCB_CAPT_bm                 0x01
+#define TCB_OVF_bm                  0x02
+
+
+/* USART */
+
+typedef struct
+{
+    register8_t RXDATAL;
+    register8_t RXDATAH;
+    register8_t TXDATAL;
+    register8_t TXDATAH;
+    register8_t STATUS;
+    register8_t CTRLA;
+    register8_t CTRLB;
+    register8_t CTRLC;
+    register16_t BAUD;
+    register8_t CTRLD;
+    register8_t DBGCTRL;
+    register8_t EVCTRL;
+    register8_t TXPLCTRL;
+    register8_t RXPLCTRL;
+    register8_t reserved_0x0F;
+} USART_t;
+
+#define USART_DATA8_bm              0x01
+#define USART_RXCIF_bm              0x80
+#define USART_TXCIF_bm              0x40
+#define USART_DREIF_bm              0x20
+#define USART_RXSIF_bm              0x10
+#define USART_RXCIE_bm              0x80
+#define USART_TXCIE_bm              0x40
+#define USART_DREIE_bm              0x20
+#define USART_RXSIE_bm              0x10
+#define USART_RS485_bm              0x01
+#define USART_RXEN_bm               0x80
+#define USART_TXEN_bm               0x40
+#define USART_SFDEN_bm              0x10
+#define USART_RXMODE_gm             0x06
+#define USART_RXMODE_NORMAL_gc      (0x00 << 1)
+#define USART_RXMODE_CLK2X_gc       (0x01 << 1)
+#define USART_MPCM_bm               0x01
+#define USART_CHSIZE_gm             0x07
+#define USART_CHSIZE_8BIT_gc        0x03
+#define USART_CHSIZE_9BITL_gc       0x06
+#define USART_CHSIZE_9BITH_gc       0x07
+
+
+/* VREF, DAC and ADC */
+
+typedef struct
+{
+    register8_t ADC0REF;
+    register8_t reserved_0x01;
+    register8_t DAC0REF;
+    register8_t reserved_0x03;
+    register8_t ACREF;
+} VREF_t;
+
+#define VREF_REFSEL_gm              0x07
+#define VREF_REFSEL_VDD_gc          0x05
+#define VREF_ALWAYSON_bm            0x80
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t reserved_0x01;
+    union
+    {
+        register16_t DATA;                                                      // 10 bit, left adjusted
+        struct
+        {
+            register8_t DATAL;
+            register8_t DATAH;
+        };
+    };
+} DAC_t;
+
+#define DAC_ENABLE_bm               0x01
+#define DAC_OUTEN_bm                0x40
+#define DAC_RUNSTDBY_bm             0x80
+
+typedef struct
+{
+    register8_t CTRLA;
+    register8_t CTRLB;
+    register8_t CTRLC;
+    register8_t CTRLD;
+    register8_t CTRLE;
+    register8_t SAMPCTRL;
+    register8_t reserved_0x06[2];
+    register8_t MUXPOS;
+    register8_t MUXNEG;
+    register8_t COMMAND;
+    register8_t EVCTRL;
+    register8_t INTCTRL;
+    register8_t INTFLAGS;
+    register8_t DBGCTRL;
+    register8_t TEMP;
+    register16_t RES;
+    register16_t WINLT;
+    register16_t WINHT;
+} ADC_t;
+
+#define ADC_ENABLE_bm               0x01
+#define ADC_FREERUN_bm              0x02
+#define ADC_RESSEL_gm               0x0C
+#define ADC_RESSEL_12BIT_gc         (0x00 << 2)
+#define ADC_RESSEL_10BIT_gc         (0x01 << 2)
+#define ADC_RUNSTBY_bm              0x80
+#define ADC_SAMPNUM_gm              0x07
+#define ADC_PRESC_gm                0x0F
+#define ADC_PRESC_DIV2_gc           0x00
+#define ADC_PRESC_DIV4_gc           0x01
+#define ADC_PRESC_DIV8_gc           0x03
+#define ADC_PRESC_DIV16_gc          0x07
+#define ADC_PRESC_DIV32_gc          0x0B
+#define ADC_PRESC_DIV64_gc          0x0F
+#define ADC_MUXPOS_gm               0x7F
+#define ADC_MUXPOS_AIN1_gc          0x01
+#define ADC_STCONV_bm               0x01
+#define ADC_RESRDY_bm               0x01
+
+
+/* Instances, in host/sim.c */
+
+extern CPUINT_t CPUINT;
+extern PORT_t PORTA, PORTC, PORTD, PORTF;
+extern VPORT_t VPORTA, VPORTC, VPORTD, VPORTF;
+extern PORTMUX_t PORTMUX;
+extern CLKCTRL_t CLKCTRL;
+extern SLPCTRL_t SLPCTRL;
+extern BOD_t BOD;
+extern WDT_t WDT;
+extern RSTCTRL_t RSTCTRL;
+extern RTC_t RTC;
+extern EVSYS_t EVSYS;
+extern CCL_t CCL;
+extern TCA_t TCA0;
+extern TCB_t TCB0, TCB1, TCB2;
+extern USART_t USART0;
+extern VREF_t VREF;
+extern DAC_t DAC0;
+extern ADC_t ADC0;
+
+
+/* Model entry points the host headers use */
+
+FILE *SIM_Stream(int (*put)(char, FILE *));                                     // stdout for USART0
+void SIM_Sleep(void);                                                           // sleep_cpu()
+void SIM_Delay(uint32_t us);                                                    // _delay_us()
+
+#endif /* HOST_AVR_IO_H */
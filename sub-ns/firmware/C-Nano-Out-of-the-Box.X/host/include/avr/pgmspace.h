@@ -0,0 +1,26 @@
+/*********************************************************************
+ *
+ *              Water Monitor Host Build Program Memory
+ *
+ *********************************************************************
+ * FileName:        host/include/avr/pgmspace.h
+ *
+ * Description:
+ *
+ * One address space on the host, flash strings are ordinary const
+ * data and the pgm_read_ functions plain loads.
+ *
+ ********************************************************************/
+
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+
+#define PROGMEM
+#define PSTR(s)             ((const char *)(s))
+#define pgm_read_byte(a)    (*(const uint8_t *)(a))
+#define pgm_read_word(a)    (*(const uint16_t *)(a))
+#define pgm_read_dword(a)   (*(const uint32_t *)(a))
+
+#endif /* HOST_AVR_PGMSPACE_H */
@@ -0,0 +1,30 @@
+/*********************************************************************
+ *
+ *              Water Monitor Host Build Sleep
+ *
+ *********************************************************************
+ * FileName:        host/include/avr/sleep.h
+ * Dependencies:    avr/io.h
+ *
+ * Description:
+ *
+ * Sleep waits for the next model step.  Every mode behaves as idle,
+ * peripherals keep running.
+ *
+ ********************************************************************/
+
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE     SLPCTRL_SMODE_IDLE_gc
+#define SLEEP_MODE_STANDBY  SLPCTRL_SMODE_STDBY_gc
+#define SLEEP_MODE_PWR_DOWN SLPCTRL_SMODE_PDOWN_gc
+
+#define set_sleep_mode(mode)    (SLPCTRL.CTRLA = (SLPCTRL.CTRLA & ~SLPCTRL_SMODE_gm) | (mode))
+#define sleep_enable()          (SLPCTRL.CTRLA |= SLPCTRL_SEN_bm)
+#define sleep_disable()         (SLPCTRL.CTRLA &= ~SLPCTRL_SEN_bm)
+#define sleep_cpu()             SIM_Sleep()
+
+#endif /* HOST_AVR_SLEEP_H */
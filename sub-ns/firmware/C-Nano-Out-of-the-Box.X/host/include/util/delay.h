@@ -0,0 +1,19 @@
+/*********************************************************************
+ *
+ *              Water Monitor Host Build Delays
+ *
+ *********************************************************************
+ * FileName:        host/include/util/delay.h
+ * Dependencies:    avr/io.h
+ *
+ ********************************************************************/
+
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#include <avr/io.h>
+
+#define _delay_us(us)   SIM_Delay((uint32_t)(us))
+#define _delay_ms(ms)   SIM_Delay((uint32_t)(ms) * 1000UL)
+
+#endif /* HOST_UTIL_DELAY_H */
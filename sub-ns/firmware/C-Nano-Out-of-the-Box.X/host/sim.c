@@ -0,0 +1,1296 @@
+/*********************************************************************
+ *
+ *              Water Monitor Host Peripheral Model
+ *
+ *********************************************************************
+ * FileName:        host/sim.c
+ * Dependencies:    hal.h, host/include/avr/io.h
+ * Processor:       Linux host, models the AVR64DD32
+ * Compiler:        GCC
+ *
+ * Description:
+ *
+ * Runs the unchanged firmware on Linux.  The register file lives
+ * here and a SIGALRM timer steps the model every SIM_STEP_US of real
+ * time.  Each step advances what the firmware uses:
+ *
+ *   CLKCTRL   CLK_PER from FRQSEL and PDIV, oscillators always stable
+ *   RTC       counter and PIT at 32.768kHz, RTC_PIT_vect
+ *   TCA0      single and split period, CMP0BUF loaded only after a
+ *             write, TRIG1 pulses through TCA0 WO3 or CCL LUT1, the
+ *             burst RS latch, TCA0_CMP0_vect and TCA0_HUNF_vect
+ *   TCB0/1    event counters on the EVSYS channels, cascade, CAPT and
+ *             TCB1_INT_vect.  TCB2 counts CLK_PER
+ *   DAC0      code on PD6, bias = (1023 - code) x 16.5V / 1023 while
+ *             BIAS_ENABLE is high, first order lag SIM_BIAS_TAU_US
+ *   ADC0      BIAS_READ = bias / 5 on AIN1, accumulated and paced by
+ *             PRESC, SAMPCTRL and SAMPNUM, ADC0_RESRDY_vect
+ *   USART0    frames paced at the baud rate the registers give, the
+ *             line is a pty, USART0_RXC_vect and USART0_DRE_vect
+ *   PORTs     pin states, strobes and VPORT writes folded in
+ *
+ * ISRs only run while the I bit of SREG is set and no ISR is running.
+ * As on the AVRxt core I stays set inside an ISR and CPUINT.STATUS
+ * shows level 0 executing, so ENTER_CRITICAL and ISR checks work as
+ * on the device.  The main loop is never preempted by more than one
+ * step at a time.
+ *
+ * Not modelled: sync in/out between boards, the RS-485 9th bit from
+ * the host side, standby stopping clocks (sleep is always idle), a
+ * failing EXTCLK, BOD and the watchdog.
+ *
+ * Environment:
+ *   SIM_PTY_LINK   symlink to the pty slave, e.g. /tmp/watmon
+ *   SIM_TRACE      file for the event trace, see SIM_Trace()
+ *   SIM_EEPROM     file backing the EEPROM, kept across runs
+ *   SIM_STEP_US    model step, default 100
+ *   SIM_BIAS_TAU_US  bias time constant, default 2000
+ *
+ ********************************************************************/
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../hal.h"
+#include "../mcc_generated_files/include/protected_io.h"
+#include <avr/eeprom.h>
+
+#define SIM_STEP_US_DEFAULT     100
+#define SIM_STEP_MAX_NS         20000000ULL                                     // Longer host stalls are dropped
+#define SIM_NS                  1000000000ULL
+#define SIM_OSC32K_HZ           32768UL
+#define SIM_EXTCLK_HZ           24000000UL                                      // EXTCLK fitted, 24MHz
+#define SIM_VDD_MV              3300UL
+#define SIM_BIAS_TAU_US_DEFAULT 2000
+#define SIM_PIT_PENDING_MAX     64                                              // Ticks kept while I is clear
+#define SIM_TXD_EMPTY           0xFF                                            // TXDATAH marker, see SIM_Usart()
+#define SIM_BUFV_CLEAR          0x10000UL                                       // CMP0BUF marker, see SIM_Trigger()
+
+
+/* Register file */
+
+volatile uint8_t SREG;
+CPUINT_t CPUINT;
+PORT_t PORTA, PORTC, PORTD, PORTF;
+VPORT_t VPORTA, VPORTC, VPORTD, VPORTF;
+PORTMUX_t PORTMUX;
+CLKCTRL_t CLKCTRL;
+SLPCTRL_t SLPCTRL;
+BOD_t BOD;
+WDT_t WDT;
+RSTCTRL_t RSTCTRL;
+RTC_t RTC;
+EVSYS_t EVSYS;
+CCL_t CCL;
+TCA_t TCA0;
+TCB_t TCB0, TCB1, TCB2;
+USART_t USART0;
+VREF_t VREF;
+DAC_t DAC0;
+ADC_t ADC0;
+
+
+/* ISRs, weak as a build may leave one out */
+
+#define SIM_VECTOR(vector)  extern void vector(void) __attribute__((weak))
+
+SIM_VECTOR(CLKCTRL_CFD_vect);
+SIM_VECTOR(RTC_PIT_vect);
+SIM_VECTOR(TCA0_HUNF_vect);
+SIM_VECTOR(TCA0_CMP0_vect);
+SIM_VECTOR(TCB1_INT_vect);
+SIM_VECTOR(USART0_RXC_vect);
+SIM_VECTOR(USART0_DRE_vect);
+SIM_VECTOR(ADC0_RESRDY_vect);
+
+extern uint8_t __start_sim_eeprom[] __attribute__((weak));
+extern uint8_t __stop_sim_eeprom[] __attribute__((weak));
+
+
+/* Model state */
+
+typedef struct
+{
+    PORT_t *port;
+    VPORT_t *vport;
+    char name;
+    uint8_t vdir;                                                               // VPORT as last synchronised
+    uint8_t vout;
+    uint8_t traced;                                                             // OUT as last traced
+} sim_port_t;
+
+static sim_port_t sim_ports[] =
+{
+    {&PORTA, &VPORTA, 'A', 0, 0, 0},
+    {&PORTC, &VPORTC, 'C', 0, 0, 0},
+    {&PORTD, &VPORTD, 'D', 0, 0, 0},
+    {&PORTF, &VPORTF, 'F', 0, 0, 0},
+};
+
+#define SIM_PORTS   (sizeof(sim_ports) / sizeof(sim_ports[0]))
+
+static uint64_t sim_last_ns;
+static uint64_t sim_step_us = SIM_STEP_US_DEFAULT;
+static int sim_trace_fd = -1;
+static const char *sim_eeprom_file;
+static const char *sim_pty_link;
+
+static uint64_t sim_cycles_rem;                                                 // Fractions carried between steps
+static uint64_t sim_rtc_rem;
+static uint32_t sim_pit_phase;
+static uint32_t sim_pit_pending;
+static uint64_t sim_tca_prescale;
+static volatile uint32_t sim_isr_calls;                                         // Ends SIM_Sleep()
+static bool sim_latch;                                                          // CCL RS latch, the burst gate
+static uint32_t sim_trig_traced;
+static uint64_t sim_trig_pulses;
+
+static uint64_t sim_adc_rem;
+static uint64_t sim_adc_cycles;
+static bool sim_adc_running;
+static double sim_bias_mv;
+static double sim_bias_tau_ns = SIM_BIAS_TAU_US_DEFAULT * 1000.0;
+static uint16_t sim_dac_traced = 0xFFFF;
+
+static int sim_pty = -1;
+static int sim_pty_slave = -1;
+static bool sim_tx_shifting;
+static uint16_t sim_tx_shift;                                                   // Frame in the shift register
+static uint64_t sim_tx_left_ns;
+static bool sim_txd_full;
+static uint16_t sim_txd;
+static bool sim_tx_done;
+static uint8_t sim_rx_buf[256];
+static uint16_t sim_rx_len;
+static uint16_t sim_rx_pos;
+static uint64_t sim_rx_ns;
+static bool sim_rx_full;
+
+static int (*sim_put)(char, FILE *);
+
+
+/*********************************************************************
+ * Function:        static uint64_t SIM_Now(void)
+ *
+ * Output:          CLOCK_MONOTONIC in ns
+ *
+ * Overview:        Same clock as time.monotonic_ns() in Python, so
+ *                  trace times compare with the host side
+ *
+ ********************************************************************/
+
+static uint64_t SIM_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * SIM_NS + (uint64_t)ts.tv_nsec;
+}
+
+
+/*********************************************************************
+ * Function:        static uint64_t SIM_Ticks(uint64_t dt, uint64_t hz,
+ *                                            uint64_t *rem)
+ *
+ * Input:           dt - ns elapsed, hz - clock, rem - carried fraction
+ *
+ * Output:          Whole clock periods in dt
+ *
+ * Overview:        No drift however the steps fall
+ *
+ ********************************************************************/
+
+static uint64_t SIM_Ticks(uint64_t dt, uint64_t hz, uint64_t *rem)
+{
+    uint64_t t = dt * hz + *rem;
+
+    *rem = t % SIM_NS;
+    return t / SIM_NS;
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Trace(const char *event,
+ *                                        const char *arg, uint32_t value)
+ *
+ * Input:           event, optional arg, value
+ *
+ * Output:          None
+ *
+ * Side Effects:    One line to SIM_TRACE: "<ns> <event> [<arg>] <value>"
+ *
+ * Overview:        Events are RX and TX (byte), PIN (PC3 etc, level),
+ *                  DAC (code) and TRIG (output rate in mHz, 0 when it
+ *                  stops).  One write() per line, safe from the
+ *                  signal handler and from main alike
+ *
+ ********************************************************************/
+
+static char *SIM_Append(char *p, uint64_t value)
+{
+    char digits[20];
+    int n = 0;
+
+    do
+    {
+        digits[n++] = '0' + (value % 10);
+        value /= 10;
+    } while(value);
+    while(n)
+    {
+        *p++ = digits[--n];
+    }
+    return p;
+}
+
+static void SIM_Trace(const char *event, const char *arg, uint32_t value)
+{
+    char line[96];
+    char *p = line;
+    ssize_t written;
+
+    if(sim_trace_fd < 0)
+    {
+        return;
+    }
+    p = SIM_Append(p, SIM_Now());
+    *p++ = ' ';
+    while(*event)
+    {
+        *p++ = *event++;
+    }
+    if(arg != NULL)
+    {
+        *p++ = ' ';
+        while(*arg)
+        {
+            *p++ = *arg++;
+        }
+    }
+    *p++ = ' ';
+    p = SIM_Append(p, value);
+    *p++ = '\n';
+    written = write(sim_trace_fd, line, p - line);
+    (void)written;
+}
+
+
+/*********************************************************************
+ * Function:        static bool SIM_Enabled(void)
+ *
+ * Overview:        True if a level 0 interrupt can be taken now
+ *
+ ********************************************************************/
+
+static bool SIM_Enabled(void)
+{
+    return (SREG & CPU_I_bm) && !(CPUINT.STATUS & CPUINT_LVL0EX_bm);
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Call(void (*isr)(void))
+ *
+ * PreCondition:    SIM_Enabled()
+ *
+ * Overview:        Runs an ISR with LVL0EX set, RETI clears it
+ *
+ ********************************************************************/
+
+static void SIM_Call(void (*isr)(void))
+{
+    if(isr == NULL)
+    {
+        return;
+    }
+    CPUINT.STATUS |= CPUINT_LVL0EX_bm;
+    isr();
+    CPUINT.STATUS &= ~CPUINT_LVL0EX_bm;
+    sim_isr_calls++;
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_PortTrace(sim_port_t *p)
+ *
+ * Overview:        Traces the OUT bits that changed since the last
+ *                  call, from main or the step, each change once
+ *
+ ********************************************************************/
+
+static void SIM_PortTrace(sim_port_t *p)
+{
+    uint8_t out = p->port->OUT;
+    uint8_t was = __atomic_exchange_n(&p->traced, out, __ATOMIC_SEQ_CST);
+    uint8_t changed = was ^ out;
+    char name[4] = {'P', p->name, '0', 0};
+    uint8_t i;
+
+    for(i = 0; changed; i++, changed >>= 1)
+    {
+        if(changed & 1)
+        {
+            name[2] = '0' + i;
+            SIM_Trace("PIN", name, (out >> i) & 1);
+        }
+    }
+}
+
+static sim_port_t *SIM_Port(PORT_t *port)
+{
+    uint8_t i;
+
+    for(i = 0; i < SIM_PORTS; i++)
+    {
+        if(sim_ports[i].port == port)
+        {
+            return &sim_ports[i];
+        }
+    }
+    return NULL;
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Ports(void)
+ *
+ * Overview:        Code that doesn't use hal.h still gets there a
+ *                  step late: strobes are applied and cleared, VPORT
+ *                  writes copied to the PORT and back
+ *
+ ********************************************************************/
+
+static void SIM_Ports(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < SIM_PORTS; i++)
+    {
+        sim_port_t *p = &sim_ports[i];
+        PORT_t *port = p->port;
+
+        if(p->vport->DIR != p->vdir)
+        {
+            port->DIR = p->vport->DIR;
+        }
+        if(p->vport->OUT != p->vout)
+        {
+            port->OUT = p->vport->OUT;
+        }
+        port->DIR = ((port->DIR | port->DIRSET) & ~port->DIRCLR) ^ port->DIRTGL;
+        port->OUT = ((port->OUT | port->OUTSET) & ~port->OUTCLR) ^ port->OUTTGL;
+        port->DIRSET = port->DIRCLR = port->DIRTGL = 0;
+        port->OUTSET = port->OUTCLR = port->OUTTGL = 0;
+        port->IN = port->OUT & port->DIR;
+        p->vdir = p->vport->DIR = port->DIR;
+        p->vout = p->vport->OUT = port->OUT;
+        p->vport->IN = port->IN;
+        SIM_PortTrace(p);
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static uint32_t SIM_Clock(void)
+ *
+ * Output:          CLK_PER in Hz
+ *
+ * Side Effects:    MCLKSTATUS: every enabled oscillator is stable
+ *
+ ********************************************************************/
+
+static uint32_t SIM_Clock(void)
+{
+    static const uint8_t oschf_mhz[16] = {1, 2, 3, 4, 4, 8, 12, 16, 20, 24, 24, 24, 24, 24, 24, 24};
+    static const uint8_t pdiv[16] = {2, 4, 8, 16, 32, 64, 2, 2, 6, 10, 12, 24, 48, 2, 2, 2};
+    uint8_t status = CLKCTRL_OSCHFS_bm | CLKCTRL_OSC32KS_bm;
+    uint32_t hz;
+
+    if(CLKCTRL.XOSC32KCTRLA & CLKCTRL_ENABLE_bm)
+    {
+        status |= CLKCTRL_XOSC32KS_bm;
+    }
+    if(CLKCTRL.XOSCHFCTRLA & CLKCTRL_ENABLE_bm)
+    {
+        status |= CLKCTRL_EXTS_bm;
+    }
+    CLKCTRL.MCLKSTATUS = status;
+
+    switch(CLKCTRL.MCLKCTRLA & CLKCTRL_CLKSEL_gm)
+    {
+        case CLKCTRL_CLKSEL_OSC32K_gc:
+        case CLKCTRL_CLKSEL_XOSC32K_gc:
+            hz = SIM_OSC32K_HZ;
+            break;
+        case CLKCTRL_CLKSEL_EXTCLK_gc:
+            hz = SIM_EXTCLK_HZ;
+            break;
+        default:
+            hz = oschf_mhz[(CLKCTRL.OSCHFCTRLA & CLKCTRL_FRQSEL_gm) >> CLKCTRL_FRQSEL_gp] * 1000000UL;
+            break;
+    }
+    if(CLKCTRL.MCLKCTRLB & CLKCTRL_PEN_bm)
+    {
+        hz /= pdiv[(CLKCTRL.MCLKCTRLB & CLKCTRL_PDIV_gm) >> 1];
+    }
+    return hz;
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Rtc(uint64_t dt)
+ *
+ * Overview:        Counter wraps at PER, PIT ticks are queued for
+ *                  RTC_PIT_vect so a host stall doesn't lose time
+ *
+ ********************************************************************/
+
+static void SIM_Rtc(uint64_t dt)
+{
+    uint32_t counts = (uint32_t)SIM_Ticks(dt, SIM_OSC32K_HZ, &sim_rtc_rem);
+    uint8_t period = (RTC.PITCTRLA & RTC_PERIOD_gm) >> RTC_PERIOD_gp;
+
+    RTC.STATUS = 0;
+    RTC.PITSTATUS = 0;
+    if(RTC.CTRLA & RTC_RTCEN_bm)
+    {
+        RTC.CNT = (uint16_t)(((uint32_t)RTC.CNT + counts) % ((uint32_t)RTC.PER + 1));
+    }
+    if((RTC.PITCTRLA & RTC_PITEN_bm) && period)
+    {
+        uint32_t cycles = 1UL << (period + 1);
+
+        sim_pit_phase += counts;
+        if(sim_pit_phase >= cycles)
+        {
+            sim_pit_pending += sim_pit_phase / cycles;
+            sim_pit_phase %= cycles;
+            RTC.PITINTFLAGS |= RTC_PI_bm;
+        }
+        if(sim_pit_pending > SIM_PIT_PENDING_MAX)
+        {
+            sim_pit_pending = SIM_PIT_PENDING_MAX;
+        }
+    }
+    else
+    {
+        sim_pit_phase = 0;
+        sim_pit_pending = 0;
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static uint32_t SIM_TcbToEvent(TCB_t *tcb)
+ *
+ * Output:          Counts until the next CAPT (CNT reaches CCMP) or
+ *                  OVF (CNT wraps past 0xFFFF)
+ *
+ ********************************************************************/
+
+static uint32_t SIM_TcbToEvent(TCB_t *tcb)
+{
+    if(tcb->CNT <= tcb->CCMP)
+    {
+        return (uint32_t)tcb->CCMP - tcb->CNT + 1;
+    }
+    return 0x10000UL - tcb->CNT;
+}
+
+
+/*********************************************************************
+ * Function:        static uint8_t SIM_TcbCount(TCB_t *tcb, uint32_t n)
+ *
+ * PreCondition:    Periodic interrupt mode, n <= SIM_TcbToEvent(tcb)
+ *
+ * Output:          TCB_CAPT_bm and TCB_OVF_bm for what happened
+ *
+ * Side Effects:    INTFLAGS set to match
+ *
+ ********************************************************************/
+
+static uint8_t SIM_TcbCount(TCB_t *tcb, uint32_t n)
+{
+    uint8_t flags = 0;
+
+    if(n == 0)
+    {
+        return 0;
+    }
+    if(n < SIM_TcbToEvent(tcb))
+    {
+        tcb->CNT = tcb->CNT + n;
+        return 0;
+    }
+    if(tcb->CNT <= tcb->CCMP)
+    {
+        flags = TCB_CAPT_bm;
+        if(tcb->CCMP == 0xFFFF)
+        {
+            flags |= TCB_OVF_bm;
+        }
+    }
+    else
+    {
+        flags = TCB_OVF_bm;
+    }
+    tcb->CNT = 0;
+    tcb->INTFLAGS |= flags;
+    return flags;
+}
+
+static bool SIM_TcbCounts(TCB_t *tcb, uint8_t user)
+{
+    return (tcb->CTRLA & TCB_ENABLE_bm)
+        && ((tcb->CTRLA & TCB_CLKSEL_gm) == TCB_CLKSEL_EVENT_gc)
+        && (user != EVSYS_USER_OFF_gc);
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Trigger(uint64_t cycles, uint32_t hz)
+ *
+ * Input:           cycles - CLK_PER cycles this step, hz - CLK_PER
+ *
+ * Overview:        TCA0 periods make TRIG1 pulses when the output is
+ *                  routed, TCA0 WO3 in split mode or CCL LUT1 in
+ *                  16 bit mode.  Pulses and CMP0 events go through
+ *                  EVSYS to the TCB0/TCB1 counter.  In a burst the
+ *                  RS latch gates LUT1 and TCB1 CAPT resets it, so
+ *                  the periods are walked one TCB0 wrap at a time
+ *
+ ********************************************************************/
+
+static void SIM_Trigger(uint64_t cycles, uint32_t hz)
+{
+    static const uint16_t tca_div[8] = {1, 2, 4, 8, 16, 64, 256, 1024};
+    bool split = TCA0.SINGLE.CTRLD & TCA_SINGLE_SPLITM_bm;
+    bool lut1 = (CCL.CTRLA & CCL_ENABLE_bm)
+             && ((CCL.LUT1CTRLA & (CCL_ENABLE_bm | CCL_OUTEN_bm)) == (CCL_ENABLE_bm | CCL_OUTEN_bm));
+    bool gated = lut1 && (CCL.TRUTH1 == 0x08);                                  // IN0 AND LINK
+    bool output = false;
+    uint32_t period = 0;
+    uint32_t divider = 1;
+    uint64_t periods = 0;
+    uint32_t pulses = 0;
+    uint32_t rate;
+
+    if(EVSYS.SWEVENTA)                                                          // Software events, strobe
+    {
+        if((EVSYS.SWEVENTA & EVSYS_SWEVENTA_CH5_gc) && (EVSYS.USERCCLLUT2A == EVSYS_USER_CHANNEL5_gc))
+        {
+            sim_latch = true;
+        }
+        EVSYS.SWEVENTA = 0;
+    }
+    if(!(CCL.CTRLA & CCL_ENABLE_bm) || ((CCL.SEQCTRL1 & CCL_SEQSEL_gm) != CCL_SEQSEL_RS_gc))
+    {
+        sim_latch = false;
+    }
+
+    if(TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm)
+    {
+        uint64_t ticks;
+
+        divider = tca_div[(TCA0.SINGLE.CTRLA & TCA_SINGLE_CLKSEL_gm) >> TCA_SINGLE_CLKSEL_gp];
+        sim_tca_prescale += cycles;
+        ticks = sim_tca_prescale / divider;
+        sim_tca_prescale %= divider;
+        if(split)
+        {
+            period = (uint32_t)TCA0.SPLIT.HPER + 1;
+            periods = ((uint64_t)TCA0.SPLIT.HCNT % period + ticks) / period;
+            TCA0.SPLIT.HCNT = ((uint64_t)TCA0.SPLIT.HCNT % period + ticks) % period;
+            output = (TCA0.SPLIT.CTRLB & TCA_SPLIT_HCMP0EN_bm) && TCA0.SPLIT.HCMP0
+                  && ((PORTMUX.TCAROUTEA & PORTMUX_TCA0_gm) == PORTMUX_TCA0_PORTC_gc)
+                  && !lut1;
+            if(periods)
+            {
+                TCA0.SPLIT.INTFLAGS |= TCA_SPLIT_HUNF_bm;
+            }
+        }
+        else
+        {
+            uint16_t width;
+
+            period = (uint32_t)TCA0.SINGLE.PER + 1;
+            periods = ((uint64_t)TCA0.SINGLE.CNT % period + ticks) / period;
+            TCA0.SINGLE.CNT = ((uint64_t)TCA0.SINGLE.CNT % period + ticks) % period;
+            if(periods && !(TCA0.SINGLE.CMP0BUF & SIM_BUFV_CLEAR))               // Buffer written, loads at UPDATE
+            {
+                TCA0.SINGLE.CMP0 = TCA0.SINGLE.CMP0BUF;
+                TCA0.SINGLE.CMP0BUF |= SIM_BUFV_CLEAR;
+            }
+            width = TCA0.SINGLE.CMP0;
+            if(CCL.TRUTH1 == 0x0A)                                              // IN0 AND NOT IN2, delayed
+            {
+                width = (width > TCA0.SINGLE.CMP2) ? width - TCA0.SINGLE.CMP2 : 0;
+            }
+            output = lut1 && width && (TCA0.SINGLE.CMP0 <= TCA0.SINGLE.PER);
+            if(periods)
+            {
+                TCA0.SINGLE.INTFLAGS |= TCA_SINGLE_CMP0_bm | TCA_SINGLE_OVF_bm;
+            }
+        }
+    }
+
+    while(periods)
+    {
+        bool open = output && (!gated || sim_latch);
+        uint32_t chunk = (periods > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)periods;
+        uint8_t source = EVSYS.USERTCB0COUNT;
+        bool counted = SIM_TcbCounts(&TCB0, source)
+                    && (((source == EVSYS_USER_CHANNEL1_gc) && (EVSYS.CHANNEL1 == EVSYS_CHANNEL1_TCA0_CMP0_LCMP0_gc) && !split)
+                     || ((source == EVSYS_USER_CHANNEL2_gc) && (EVSYS.CHANNEL2 == EVSYS_CHANNEL2_PORTC_PIN3_gc) && open));
+
+        if(counted && (SIM_TcbToEvent(&TCB0) < chunk))
+        {
+            chunk = SIM_TcbToEvent(&TCB0);
+        }
+        if(open)
+        {
+            pulses += chunk;
+        }
+        if(counted && (SIM_TcbCount(&TCB0, chunk) & TCB_OVF_bm)
+           && (EVSYS.CHANNEL3 == EVSYS_CHANNEL3_TCB0_OVF_gc)
+           && SIM_TcbCounts(&TCB1, EVSYS.USERTCB1COUNT)
+           && (EVSYS.USERTCB1COUNT == EVSYS_USER_CHANNEL3_gc))
+        {
+            if((SIM_TcbCount(&TCB1, 1) & TCB_CAPT_bm)
+               && (EVSYS.CHANNEL4 == EVSYS_CHANNEL4_TCB1_CAPT_gc)
+               && (EVSYS.USERCCLLUT3A == EVSYS_USER_CHANNEL4_gc))
+            {
+                sim_latch = false;                                              // Gate closes after the Nth pulse
+            }
+        }
+        periods -= chunk;
+    }
+    sim_trig_pulses += pulses;
+
+    rate = (output && (!gated || sim_latch) && period)
+         ? (uint32_t)(((uint64_t)hz * 1000) / ((uint64_t)divider * period)) : 0;
+    if(rate != sim_trig_traced)
+    {
+        sim_trig_traced = rate;
+        SIM_Trace("TRIG", NULL, rate);
+    }
+
+    if((TCB2.CTRLA & TCB_ENABLE_bm) && ((TCB2.CTRLA & TCB_CLKSEL_gm) == TCB_CLKSEL_DIV1_gc))
+    {
+        uint32_t top = (uint32_t)TCB2.CCMP + 1;
+
+        if((uint64_t)TCB2.CNT + cycles >= top)
+        {
+            TCB2.INTFLAGS |= TCB_CAPT_bm;
+        }
+        TCB2.CNT = (uint16_t)(((uint64_t)TCB2.CNT + cycles) % top);
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Analog(uint64_t dt, uint32_t hz)
+ *
+ * Input:           dt - ns this step, hz - CLK_PER
+ *
+ * Overview:        DAC0 drives the bias supply, ADC0 reads it back
+ *                  through the divide by 5 on BIAS_READ
+ *
+ ********************************************************************/
+
+static void SIM_Analog(uint64_t dt, uint32_t hz)
+{
+    static const uint8_t presc[16] = {2, 4, 6, 8, 10, 12, 14, 16, 20, 24, 28, 32, 40, 48, 56, 64};
+    static const uint16_t refs[8] = {1024, 2048, 4096, 2500, 0, SIM_VDD_MV, SIM_VDD_MV, 0};
+    bool driven = ((DAC0.CTRLA & (DAC_ENABLE_bm | DAC_OUTEN_bm)) == (DAC_ENABLE_bm | DAC_OUTEN_bm));
+    uint16_t code = driven ? (DAC0.DATA >> 6) : 1023;
+    double target = 0;
+
+    if(code != sim_dac_traced)
+    {
+        sim_dac_traced = code;
+        SIM_Trace("DAC", NULL, code);
+    }
+    if((PORTD.DIR & PORTD.OUT & PIN2_bm) && driven)                             // BIAS_ENABLE
+    {
+        target = (1023.0 - code) * 16500.0 / 1023.0;
+    }
+    sim_bias_mv += (target - sim_bias_mv) * (1.0 - exp(-(double)dt / sim_bias_tau_ns));
+
+    if(!(ADC0.CTRLA & ADC_ENABLE_bm))
+    {
+        sim_adc_running = false;
+        sim_adc_cycles = 0;
+        return;
+    }
+    if(ADC0.COMMAND & ADC_STCONV_bm)
+    {
+        ADC0.COMMAND = 0;
+        sim_adc_running = true;
+        sim_adc_cycles = 0;
+    }
+    if(sim_adc_running)
+    {
+        uint8_t depth = ADC0.CTRLB & ADC_SAMPNUM_gm;
+        uint32_t conversion = ((uint32_t)ADC0.SAMPCTRL + 2 + 13) << depth;      // CLK_ADC cycles per result
+        uint16_t ref = refs[VREF.ADC0REF & VREF_REFSEL_gm];
+
+        sim_adc_cycles += SIM_Ticks(dt, hz / presc[ADC0.CTRLC & ADC_PRESC_gm], &sim_adc_rem);
+        if(sim_adc_cycles >= conversion)
+        {
+            uint32_t counts = 0;
+
+            sim_adc_cycles %= conversion;
+            if(((ADC0.MUXPOS & ADC_MUXPOS_gm) == ADC_MUXPOS_AIN1_gc) && ref)
+            {
+                counts = (uint32_t)(sim_bias_mv / 5.0 * 4096.0 / ref);
+                if(counts > 4095)
+                {
+                    counts = 4095;
+                }
+            }
+            counts <<= depth;
+            if(depth > 4)
+            {
+                counts >>= (depth - 4);                                         // RES is 16 bits
+            }
+            ADC0.RES = (uint16_t)counts;
+            ADC0.INTFLAGS |= ADC_RESRDY_bm;
+            if(!(ADC0.CTRLA & ADC_FREERUN_bm))
+            {
+                sim_adc_running = false;
+            }
+        }
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static uint64_t SIM_UsartFrame(uint32_t hz)
+ *
+ * Output:          ns per frame at the rate the registers give, 0 if
+ *                  the BAUD register is out of range
+ *
+ ********************************************************************/
+
+static uint64_t SIM_UsartFrame(uint32_t hz)
+{
+    uint32_t s = ((USART0.CTRLB & USART_RXMODE_gm) == USART_RXMODE_CLK2X_gc) ? 8 : 16;
+    uint8_t chsize = USART0.CTRLC & USART_CHSIZE_gm;
+    uint8_t bits = ((chsize == USART_CHSIZE_9BITL_gc) || (chsize == USART_CHSIZE_9BITH_gc)) ? 11 : 10;
+
+    if((USART0.BAUD < 64) || (hz == 0))
+    {
+        return 0;
+    }
+    return (SIM_NS * bits * s * USART0.BAUD) / (64ULL * hz);
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Usart(uint64_t dt, uint32_t hz)
+ *
+ * Overview:        The data register and shift register of the
+ *                  transmitter, and a receiver that takes a byte from
+ *                  the pty every frame time.  The driver writes
+ *                  TXDATAH before TXDATAL, so TXDATAH is set to a
+ *                  marker value while the data register is empty and
+ *                  any write shows up.  Received bytes wait in the pty
+ *                  while RXDATA is unread, nothing is dropped
+ *
+ ********************************************************************/
+
+static void SIM_UsartDre(void)
+{
+    if(!sim_txd_full && (USART0.CTRLA & USART_DREIE_bm) && SIM_Enabled())
+    {
+        SIM_Call(USART0_DRE_vect);
+    }
+    if(USART0.TXDATAH != SIM_TXD_EMPTY)
+    {
+        sim_txd = USART0.TXDATAL | ((USART0.TXDATAH & USART_DATA8_bm) << 8);
+        sim_txd_full = true;
+        USART0.TXDATAH = SIM_TXD_EMPTY;
+    }
+}
+
+static void SIM_Usart(uint64_t dt, uint32_t hz)
+{
+    uint64_t frame = SIM_UsartFrame(hz);
+    uint8_t out[256];
+    uint16_t count = 0;
+    uint64_t t = dt;
+    ssize_t n;
+
+    if((USART0.CTRLB & USART_TXEN_bm) && frame)
+    {
+        while(true)
+        {
+            SIM_UsartDre();
+            if(!sim_tx_shifting && sim_txd_full)
+            {
+                sim_tx_shifting = true;
+                sim_tx_shift = sim_txd;
+                sim_tx_left_ns = frame;
+                sim_txd_full = false;
+                sim_tx_done = false;
+                SIM_UsartDre();                                                 // Refill while shifting
+            }
+            if(!sim_tx_shifting || (t < sim_tx_left_ns) || (count == sizeof(out)))
+            {
+                if(sim_tx_shifting && (t < sim_tx_left_ns))
+                {
+                    sim_tx_left_ns -= t;
+                }
+                break;
+            }
+            t -= sim_tx_left_ns;
+            sim_tx_shifting = false;
+            out[count++] = (uint8_t)sim_tx_shift;
+            SIM_Trace("TX", NULL, (uint8_t)sim_tx_shift);
+            sim_tx_done = !sim_txd_full;
+        }
+        if(count && (sim_pty >= 0))
+        {
+            n = write(sim_pty, out, count);                                     // No reader: the line drops it
+            (void)n;
+        }
+    }
+
+    if((USART0.CTRLB & USART_RXEN_bm) && frame)
+    {
+        sim_rx_ns += dt;
+        while(true)
+        {
+            uint8_t data;
+
+            if(sim_rx_pos == sim_rx_len)
+            {
+                n = (sim_pty >= 0) ? read(sim_pty, sim_rx_buf, sizeof(sim_rx_buf)) : -1;
+                sim_rx_pos = 0;
+                sim_rx_len = (n > 0) ? (uint16_t)n : 0;
+            }
+            if(sim_rx_pos == sim_rx_len)
+            {
+                if(sim_rx_ns > frame)
+                {
+                    sim_rx_ns = frame;                                          // Idle line, no credit saved up
+                }
+                break;
+            }
+            if(sim_rx_ns < frame)
+            {
+                break;
+            }
+            if(sim_rx_full)
+            {
+                if((USART0.CTRLA & USART_RXCIE_bm) && SIM_Enabled())
+                {
+                    SIM_Call(USART0_RXC_vect);
+                    sim_rx_full = false;
+                }
+                else
+                {
+                    sim_rx_ns = frame;
+                    break;
+                }
+            }
+            sim_rx_ns -= frame;
+            data = sim_rx_buf[sim_rx_pos++];
+            SIM_Trace("RX", NULL, data);
+            if(USART0.CTRLB & USART_MPCM_bm)
+            {
+                continue;                                                       // Data frame, waiting for an address
+            }
+            USART0.RXDATAH = 0;
+            USART0.RXDATAL = data;
+            sim_rx_full = true;
+            if((USART0.CTRLA & USART_RXCIE_bm) && SIM_Enabled())
+            {
+                SIM_Call(USART0_RXC_vect);
+                sim_rx_full = false;
+            }
+        }
+    }
+
+    USART0.STATUS = (sim_rx_full ? USART_RXCIF_bm : 0)
+                  | (sim_tx_done ? USART_TXCIF_bm : 0)
+                  | (sim_txd_full ? 0 : USART_DREIF_bm);
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Interrupts(void)
+ *
+ * Overview:        The other interrupts, in vector order
+ *
+ ********************************************************************/
+
+static void SIM_Interrupts(void)
+{
+    if(!SIM_Enabled())
+    {
+        return;
+    }
+    if(CLKCTRL.MCLKINTCTRL & CLKCTRL.MCLKINTFLAGS & CLKCTRL_CFD_bm)
+    {
+        SIM_Call(CLKCTRL_CFD_vect);
+    }
+    if(RTC.PITINTCTRL & RTC_PI_bm)
+    {
+        while(sim_pit_pending)
+        {
+            sim_pit_pending--;
+            RTC.PITINTFLAGS |= RTC_PI_bm;
+            SIM_Call(RTC_PIT_vect);
+        }
+    }
+    else
+    {
+        sim_pit_pending = 0;
+    }
+    if(TCA0.SPLIT.INTCTRL & TCA0.SPLIT.INTFLAGS & TCA_SPLIT_HUNF_bm)
+    {
+        SIM_Call(TCA0_HUNF_vect);
+    }
+    if(TCA0.SINGLE.INTCTRL & TCA0.SINGLE.INTFLAGS & TCA_SINGLE_CMP0_bm)
+    {
+        SIM_Call(TCA0_CMP0_vect);
+    }
+    if(TCB1.INTCTRL & TCB1.INTFLAGS & TCB_CAPT_bm)
+    {
+        SIM_Call(TCB1_INT_vect);
+    }
+    if(ADC0.INTCTRL & ADC0.INTFLAGS & ADC_RESRDY_bm)
+    {
+        SIM_Call(ADC0_RESRDY_vect);
+        ADC0.INTFLAGS &= ~ADC_RESRDY_bm;                                        // Reading RES clears it
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Step(int signal)
+ *
+ * Overview:        SIGALRM handler, one model step
+ *
+ ********************************************************************/
+
+static void SIM_Step(int signal)
+{
+    int saved = errno;
+    uint64_t now = SIM_Now();
+    uint64_t dt = now - sim_last_ns;
+    uint32_t hz = SIM_Clock();
+    uint64_t cycles;
+
+    (void)signal;
+    if(dt > SIM_STEP_MAX_NS)
+    {
+        dt = SIM_STEP_MAX_NS;
+    }
+    sim_last_ns = now;
+    cycles = SIM_Ticks(dt, hz, &sim_cycles_rem);
+
+    SIM_Ports();
+    SIM_Rtc(dt);
+    SIM_Trigger(cycles, hz);
+    SIM_Analog(dt, hz);
+    SIM_Usart(dt, hz);
+    SIM_Interrupts();
+    errno = saved;
+}
+
+
+/*********************************************************************
+ *
+ *              Host side of hal.h
+ *
+ ********************************************************************/
+
+void HAL_PinOutput(PORT_t *port, uint8_t pins)
+{
+    __atomic_or_fetch(&port->DIR, pins, __ATOMIC_SEQ_CST);
+}
+
+void HAL_PinInput(PORT_t *port, uint8_t pins)
+{
+    __atomic_and_fetch(&port->DIR, (uint8_t)~pins, __ATOMIC_SEQ_CST);
+}
+
+void HAL_PinSet(PORT_t *port, uint8_t pins)
+{
+    sim_port_t *p = SIM_Port(port);
+
+    __atomic_or_fetch(&port->OUT, pins, __ATOMIC_SEQ_CST);
+    if(p != NULL)
+    {
+        SIM_PortTrace(p);
+    }
+}
+
+void HAL_PinClear(PORT_t *port, uint8_t pins)
+{
+    sim_port_t *p = SIM_Port(port);
+
+    __atomic_and_fetch(&port->OUT, (uint8_t)~pins, __ATOMIC_SEQ_CST);
+    if(p != NULL)
+    {
+        SIM_PortTrace(p);
+    }
+}
+
+bool HAL_PinIsSet(PORT_t *port, uint8_t pins)
+{
+    return (port->OUT & pins) != 0;
+}
+
+void HAL_PortWrite(VPORT_t *vport, uint8_t mask, uint8_t pins)
+{
+    uint8_t i;
+    uint8_t out;
+
+    for(i = 0; i < SIM_PORTS; i++)
+    {
+        if(sim_ports[i].vport == vport)
+        {
+            PORT_t *port = sim_ports[i].port;
+
+            out = port->OUT;
+            while(!__atomic_compare_exchange_n(&port->OUT, &out, (uint8_t)((out & ~mask) | pins),
+                                               false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+            {
+            }
+            SIM_PortTrace(&sim_ports[i]);
+        }
+    }
+}
+
+void HAL_ClearFlags(register8_t *flags, uint8_t mask)
+{
+    __atomic_and_fetch(flags, (uint8_t)~mask, __ATOMIC_SEQ_CST);
+}
+
+void HAL_TimerCommand(TCA_t *timer, uint8_t command)
+{
+    switch(command & TCA_SINGLE_CMD_gm)
+    {
+        case TCA_SINGLE_CMD_RESET_gc:                                           // Only allowed while stopped
+            memset((void *)timer, 0, sizeof(*timer));
+            timer->SINGLE.CMP0BUF = SIM_BUFV_CLEAR;
+            break;
+        case TCA_SINGLE_CMD_RESTART_gc:
+            timer->SINGLE.CNT = 0;
+            break;
+        case TCA_SINGLE_CMD_UPDATE_gc:
+            if(!(timer->SINGLE.CMP0BUF & SIM_BUFV_CLEAR))
+            {
+                timer->SINGLE.CMP0 = timer->SINGLE.CMP0BUF;
+                timer->SINGLE.CMP0BUF |= SIM_BUFV_CLEAR;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+
+/*********************************************************************
+ *
+ *              Host side of the AVR headers
+ *
+ ********************************************************************/
+
+void protected_write_io(void *addr, uint8_t magic, uint8_t value)
+{
+    (void)magic;
+    *(volatile uint8_t *)addr = value;
+}
+
+void SIM_Sleep(void)
+{
+    uint32_t calls = sim_isr_calls;
+
+    while(sim_isr_calls == calls)                                               // Only an interrupt wakes the CPU
+    {
+        pause();
+    }
+}
+
+void SIM_Delay(uint32_t us)
+{
+    struct timespec ts = {us / 1000000UL, (long)(us % 1000000UL) * 1000L};
+
+    while(nanosleep(&ts, &ts) && (errno == EINTR))
+    {
+        ;
+    }
+}
+
+static ssize_t SIM_StreamWrite(void *cookie, const char *buffer, size_t size)
+{
+    size_t i;
+
+    (void)cookie;
+    for(i = 0; i < size; i++)
+    {
+        sim_put(buffer[i], NULL);
+    }
+    return size;
+}
+
+FILE *SIM_Stream(int (*put)(char, FILE *))
+{
+    cookie_io_functions_t functions = {NULL, SIM_StreamWrite, NULL, NULL};
+    FILE *stream;
+
+    sim_put = put;
+    stream = fopencookie(NULL, "w", functions);
+    setvbuf(stream, NULL, _IONBF, 0);
+    return stream;
+}
+
+static void SIM_EepromSave(void)
+{
+    int fd;
+    ssize_t n;
+
+    if((sim_eeprom_file == NULL) || (__start_sim_eeprom == NULL))
+    {
+        return;
+    }
+    fd = open(sim_eeprom_file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(fd >= 0)
+    {
+        n = write(fd, __start_sim_eeprom, __stop_sim_eeprom - __start_sim_eeprom);
+        (void)n;
+        close(fd);
+    }
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+    memcpy(dst, src, n);
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+    memcpy(dst, src, n);
+    SIM_EepromSave();
+}
+
+
+/*********************************************************************
+ * Function:        static void SIM_Initialize(void)
+ *
+ * PreCondition:    Runs before main()
+ *
+ * Side Effects:    pty opened, EEPROM loaded, step timer running
+ *
+ * Overview:        Reset state of the register file, then the model
+ *
+ ********************************************************************/
+
+static void SIM_Exit(int signal)
+{
+    if(sim_pty_link != NULL)
+    {
+        unlink(sim_pty_link);
+    }
+    _exit(128 + signal);
+}
+
+__attribute__((constructor))
+static void SIM_Initialize(void)
+{
+    struct sigaction action;
+    struct itimerval timer;
+    struct termios tio;
+    const char *env;
+    const char *slave;
+    int fd;
+
+    RTC.PER = 0xFFFF;
+    TCB0.CCMP = TCB1.CCMP = TCB2.CCMP = 0;
+    CLKCTRL.OSCHFCTRLA = CLKCTRL_FRQSEL_4M_gc;                                  // Reset value
+    CLKCTRL.MCLKCTRLB = CLKCTRL_PDIV_6X_gc | CLKCTRL_PEN_bm;
+    USART0.TXDATAH = SIM_TXD_EMPTY;
+    TCA0.SINGLE.CMP0BUF = SIM_BUFV_CLEAR;
+    DAC0.DATA = 0;
+
+    if((env = getenv("SIM_STEP_US")) && atoi(env) > 0)
+    {
+        sim_step_us = (uint64_t)atoi(env);
+    }
+    if((env = getenv("SIM_BIAS_TAU_US")) && atoi(env) > 0)
+    {
+        sim_bias_tau_ns = atoi(env) * 1000.0;
+    }
+    if((env = getenv("SIM_TRACE")) && *env)
+    {
+        sim_trace_fd = open(env, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    }
+
+    if(__start_sim_eeprom != NULL)
+    {
+        memset(__start_sim_eeprom, 0xFF, __stop_sim_eeprom - __start_sim_eeprom);
+        sim_eeprom_file = getenv("SIM_EEPROM");
+        if((sim_eeprom_file != NULL) && ((fd = open(sim_eeprom_file, O_RDONLY)) >= 0))
+        {
+            ssize_t n = read(fd, __start_sim_eeprom, __stop_sim_eeprom - __start_sim_eeprom);
+
+            (void)n;
+            close(fd);
+        }
+    }
+
+    sim_pty = posix_openpt(O_RDWR | O_NOCTTY);
+    if((sim_pty < 0) || grantpt(sim_pty) || unlockpt(sim_pty) || ((slave = ptsname(sim_pty)) == NULL))
+    {
+        perror("sim: pty");
+        exit(1);
+    }
+    sim_pty_slave = open(slave, O_RDWR | O_NOCTTY);                             // Kept open, no EIO between clients
+    if((sim_pty_slave >= 0) && (tcgetattr(sim_pty_slave, &tio) == 0))
+    {
+        cfmakeraw(&tio);
+        tcsetattr(sim_pty_slave, TCSANOW, &tio);
+    }
+    fcntl(sim_pty, F_SETFL, fcntl(sim_pty, F_GETFL) | O_NONBLOCK);
+    sim_pty_link = getenv("SIM_PTY_LINK");
+    if(sim_pty_link != NULL)
+    {
+        unlink(sim_pty_link);
+        if(symlink(slave, sim_pty_link))
+        {
+            perror("sim: SIM_PTY_LINK");
+            sim_pty_link = NULL;
+        }
+    }
+    fprintf(stderr, "sim: USART0 on %s\n", (sim_pty_link != NULL) ? sim_pty_link : slave);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SIM_Exit;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    action.sa_handler = SIM_Step;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+    sim_last_ns = SIM_Now();
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = (suseconds_t)sim_step_us;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
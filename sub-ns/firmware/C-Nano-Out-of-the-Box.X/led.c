@@ -0,0 +1,142 @@
+/*********************************************************************
+ *
+ *              Water Monitor LED Select
+ *
+ *********************************************************************
+ * FileName:        led.c
+ * Dependencies:    led.h, trigger.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * One LED on at a time, shared by the command line and the sequencer.
+ * The eight OE lines are two VPORT writes, PORTF then PORTC, so the
+ * old and new LED overlap for a few cycles but no OE line goes low
+ * and high again.  DAQ sync stays high across an LED to LED change.
+ *
+ ********************************************************************/
+
+#include "led.h"
+#include "trigger.h"
+#include "hal.h"
+
+#define LED_PORTF_MASK      (PIN0_bm | PIN1_bm | PIN2_bm | PIN3_bm | PIN4_bm | PIN5_bm)
+#define LED_PORTC_MASK      (PIN0_bm | PIN1_bm)                                 // OE6 and DAQ Sync
+#define LED_SYNC            PIN1_bm                                             // DAQ Sync = PC1
+
+static const uint8_t led_oe[LED_COUNT + 1][2] =                                 // PORTF, PORTC
+{
+    {0,       0},                                                               // All off
+    {PIN0_bm, 0},                                                               // LED 450nm
+    {PIN1_bm, 0},                                                               // LED 410nm
+    {PIN2_bm, 0},                                                               // LED 365nm
+    {PIN3_bm, 0},                                                               // LED 295nm
+    {PIN4_bm, 0},                                                               // LED 278nm
+    {PIN5_bm, 0},                                                               // LED 255nm
+    {0,       PIN0_bm},                                                         // LED 235nm
+};
+
+static volatile uint8_t led_current = 0;
+
+static void LED_Apply(void);
+
+
+/*********************************************************************
+ * Function:        void LED_Set(uint8_t led)
+ *
+ * PreCondition:    OE pins set as outputs
+ *
+ * Input:           led - 0 to LED_COUNT, out of range turns all off
+ *
+ * Output:          None
+ *
+ * Side Effects:    DAQ sync set if an LED is on
+ *
+ * Overview:        Set LED (xor), if any set, then set sync out
+ *                  If none set, turn off sync out
+ *
+ ********************************************************************/
+
+void LED_Set(uint8_t led)
+{
+    uint8_t portc;
+
+    if(led > LED_COUNT)
+    {
+        led = 0;                                                                // Leave all off
+    }
+    portc = led_oe[led][1] | ((led != 0) ? LED_SYNC : 0);
+
+    ENTER_CRITICAL(L);                                                          // PC2 changes from the power tick
+    HAL_PortWrite(&VPORTF, LED_PORTF_MASK, led_oe[led][0]);
+    HAL_PortWrite(&VPORTC, LED_PORTC_MASK, portc);
+    EXIT_CRITICAL(L);
+    led_current = led;
+}
+
+
+/*********************************************************************
+ * Function:        void LED_Select(uint8_t led)
+ *
+ * PreCondition:    OE pins set as outputs
+ *
+ * Input:           led - 0 to LED_COUNT, out of range turns all off
+ *
+ * Output:          None
+ *
+ * Side Effects:    Skips a trigger pulse or more if the trigger runs
+ *
+ * Overview:        LED_Set() from the trigger blank interrupt, or at
+ *                  once with the trigger stopped.  Only the latest of
+ *                  several selects before the blank is applied
+ *
+ ********************************************************************/
+
+void LED_Select(uint8_t led)
+{
+    led_current = (led > LED_COUNT) ? 0 : led;
+    TRIGGER_AtBlank(LED_Apply);
+}
+
+
+/*********************************************************************
+ * Function:        uint8_t LED_Get(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          LED on, or selected and waiting, 0 if none
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+uint8_t LED_Get(void)
+{
+    return led_current;
+}
+
+
+/*********************************************************************
+ * Function:        static void LED_Apply(void)
+ *
+ * PreCondition:    TRIG1 held low
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Blank callback, switches to the latest selection
+ *
+ ********************************************************************/
+
+static void LED_Apply(void)
+{
+    LED_Set(led_current);
+}
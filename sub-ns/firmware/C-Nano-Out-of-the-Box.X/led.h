@@ -0,0 +1,34 @@
+/*********************************************************************
+ *
+ *              Water Monitor LED Select Header
+ *
+ *********************************************************************
+ * FileName:        led.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Trigger distribution output enables.  LED 1-7 = OE0-OE5 (PF0-PF5)
+ * and OE6 (PC0), DAQ sync = OE7 (PC1) follows any LED being on.
+ *
+ * LED_Select() is for a running trigger, the change waits for a
+ * trigger blank so no pulse is cut or split between two LEDs.
+ * LED_Set() switches at once, from a blank callback or with the
+ * trigger stopped.
+ *
+ ********************************************************************/
+
+#ifndef LED_H
+#define LED_H
+
+#include "mcc_generated_files/mcc.h"
+
+#define LED_COUNT           7                                                   // 1 = 450nm ... 7 = 235nm
+
+void LED_Set(uint8_t led);                                                      // 0 = all off, safe from interrupts
+void LED_Select(uint8_t led);                                                   // Queued for the next trigger blank
+uint8_t LED_Get(void);                                                          // Latest set or selected
+
+#endif /* LED_H */
@@ -0,0 +1,218 @@
+/*********************************************************************
+ *
+ *              Water Monitor Low Power
+ *
+ *********************************************************************
+ * FileName:        lowpower.c
+ * Dependencies:    lowpower.h, systick.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Idle sleep stops only the CPU, every peripheral and interrupt keeps
+ * running, so it is used whenever the receive buffer is empty.
+ * Standby sleep also stops CLK_PER, so it is only used with the board
+ * in standby and the transmitter finished.  The system tick (RTC PIT)
+ * still wakes it, once a second once main has slowed it, and the host
+ * wakes it through USART0 start of frame detection or, with
+ * LOWPOWER_WAKE_PIN, a pin change on RXD armed only while asleep.
+ *
+ * Time asleep is measured on the RTC counter, which runs in standby.
+ * Wake ups by the tick alone are counted apart from the others.
+ *
+ ********************************************************************/
+
+#include "lowpower.h"
+#include "hal.h"
+#include "systick.h"
+#include <avr/sleep.h>
+
+static uint32_t lowpower_seconds = 0;
+static uint16_t lowpower_fraction = 0;                                          // 1 / SYSTICK_FINE_HZ
+static uint32_t lowpower_wakeups = 0;                                          // Anything but the tick alone
+static uint32_t lowpower_tick_wakeups = 0;
+
+
+/*********************************************************************
+ * Function:        void LOWPOWER_Initialize(void)
+ *
+ * PreCondition:    USART0 initialized
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Lets a start bit wake the USART from standby
+ *
+ ********************************************************************/
+
+void LOWPOWER_Initialize(void)
+{
+#if (LOWPOWER_WAKE == LOWPOWER_WAKE_SFD)
+    USART0.CTRLB |= USART_SFDEN_bm;
+#endif
+}
+
+
+/*********************************************************************
+ * Function:        void LOWPOWER_Sleep(bool standby)
+ *
+ * PreCondition:    Interrupts on
+ *
+ * Input:           standby - deeper sleep allowed, board in standby
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Sleeps until the next interrupt, unless received
+ *                  data is already waiting.  The check and the sleep
+ *                  are atomic: SEI holds off interrupts for one more
+ *                  instruction, the SLEEP.
+ *
+ ********************************************************************/
+
+void LOWPOWER_Sleep(bool standby)
+{
+    uint16_t start, asleep;
+    uint8_t ticks;
+
+    cli();
+    if(USART0_IsRxReady())
+    {
+        sei();
+        return;
+    }
+    if(standby && USART0_IsTxDone())
+    {
+        set_sleep_mode(SLEEP_MODE_STANDBY);
+#if (LOWPOWER_WAKE == LOWPOWER_WAKE_PIN)
+        PORTD.PIN5CTRL = (PORTD.PIN5CTRL & ~PORT_ISC_gm) | PORT_ISC_BOTHEDGES_gc;
+#endif
+    }
+    else
+    {
+        set_sleep_mode(SLEEP_MODE_IDLE);
+    }
+    start = SYSTICK_Fine();
+    ticks = SYSTICK_Interrupts();
+    sleep_enable();
+    sei();
+    sleep_cpu();
+    sleep_disable();
+
+    asleep = SYSTICK_Fine() - start;                                            // Wake up ISR included, a few us
+    if((SYSTICK_Interrupts() != ticks) && !USART0_IsRxReady())
+    {
+        lowpower_tick_wakeups++;
+    }
+    else
+    {
+        lowpower_wakeups++;
+    }
+    lowpower_fraction += asleep % SYSTICK_FINE_HZ;                              // < 2s per sleep, so no overflow
+    if(lowpower_fraction >= SYSTICK_FINE_HZ)
+    {
+        lowpower_fraction -= SYSTICK_FINE_HZ;
+        lowpower_seconds++;
+    }
+    if(asleep >= SYSTICK_FINE_HZ)
+    {
+        lowpower_seconds++;
+    }
+}
+
+
+/*********************************************************************
+ * Function:        void LOWPOWER_GetAsleep(uint32_t *seconds,
+ *                                          uint16_t *milliseconds)
+ *
+ * PreCondition:    None
+ *
+ * Input:           Pointers for the total
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Time asleep since start-up
+ *
+ ********************************************************************/
+
+void LOWPOWER_GetAsleep(uint32_t *seconds, uint16_t *milliseconds)
+{
+    *seconds = lowpower_seconds;
+    *milliseconds = ((uint32_t)lowpower_fraction * 1000) / SYSTICK_FINE_HZ;
+}
+
+
+/*********************************************************************
+ * Function:        uint32_t LOWPOWER_GetWakeups(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Sleeps since start-up that something other than
+ *                  the system tick ended
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+uint32_t LOWPOWER_GetWakeups(void)
+{
+    return lowpower_wakeups;
+}
+
+
+/*********************************************************************
+ * Function:        uint32_t LOWPOWER_GetTickWakeups(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Sleeps since start-up ended by the system tick
+ *                  alone
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+uint32_t LOWPOWER_GetTickWakeups(void)
+{
+    return lowpower_tick_wakeups;
+}
+
+
+#if (LOWPOWER_WAKE == LOWPOWER_WAKE_PIN)
+/*********************************************************************
+ * Function:        ISR(PORTD_PORT_vect)
+ *
+ * PreCondition:    Standby sleep with RXD armed
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Start bit woke us, disarm so received bits do not
+ *                  interrupt while awake
+ *
+ ********************************************************************/
+
+ISR(PORTD_PORT_vect)
+{
+    PORTD.PIN5CTRL &= ~PORT_ISC_gm;
+    HAL_ClearFlags(&PORTD.INTFLAGS, PIN5_bm);
+}
+#endif
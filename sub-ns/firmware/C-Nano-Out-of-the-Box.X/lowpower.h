@@ -0,0 +1,33 @@
+/*********************************************************************
+ *
+ *              Water Monitor Low Power Header
+ *
+ *********************************************************************
+ * FileName:        lowpower.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Sleeps the CPU from the main loop whenever there is nothing to do,
+ * and counts the time spent asleep.
+ *
+ ********************************************************************/
+
+#ifndef LOWPOWER_H
+#define LOWPOWER_H
+
+#include "mcc_generated_files/mcc.h"
+
+#define LOWPOWER_WAKE_SFD   0                                                   // USART0 start of frame detection
+#define LOWPOWER_WAKE_PIN   1                                                   // Pin change on RXD (PD5), first byte lost
+#define LOWPOWER_WAKE       LOWPOWER_WAKE_SFD                                   // Standby wake up from the host
+
+void LOWPOWER_Initialize(void);
+void LOWPOWER_Sleep(bool standby);                                              // Until the next interrupt
+void LOWPOWER_GetAsleep(uint32_t *seconds, uint16_t *milliseconds);             // Total time asleep
+uint32_t LOWPOWER_GetWakeups(void);                                             // Not counting the tick
+uint32_t LOWPOWER_GetTickWakeups(void);                                         // By the tick alone
+
+#endif /* LOWPOWER_H */
@@ -48,12 +48,37 @@
  *                  Dec 31, 2022    Everything working
  *                  Jan 2, 2023     Refining everything
  *                  Jan 3, 2023     Fix TCA to PC3, more refining, tested all, fixed some small things
+ *                  Oct 17, 2026    Interrupt driven UART with RX/TX ring buffers
+ *                                  Non-blocking CLI state machine on a system tick
+ *                                  Binary protocol with CRC beside the ASCII menu
+ *                                  Trigger rate in Hz, TCA0 moved to trigger.c
+ *                                  Programmable trigger pulse width
+ *                                  Burst of exactly N triggers
+ *                                  32 bit hardware count of TRIG1 pulses
+ *                                  Wavelength sequencer, LED/bias to led.c, bias.c
+ *                                  Bias DAC ramp engine with RAMP_VALUE output
+ *                                  Free running averaged bias ADC
+ *                                  PI bias regulation on the ADC reading
+ *                                  Bias in calibrated mV, calibration in EEPROM
+ *                                  Saved configuration, restore at power up
+ *                                  Power sequencing from the tick, E/D return at once
+ *                                  CPU sleeps when idle, standby sleep when disabled
+ *                                  4MHz system clock in standby, 24MHz when enabled
+ *                                  Clock source select, autotune, EXTCLK, error report
+ *                                  Master / slave trigger sync with slave delay
+ *                                  RS-485 multidrop addressing, address in EEPROM
+ *                                  Baud rate up to 1Mbaud with error report and fallback
+ *                                  Cycle count profiling probes, PROFILE_ENABLE builds
+ *                                  Replies without printf, text from flash
+ *                                  LED changes in a trigger blank, OE lines in two writes
  * 
  *
  * Description:
  *
  * This file contains code to be programmed to the Water Monitor
- * Light Source card.  This code assumes 24MHz Fosc.
+ * Light Source card.  OSCHF runs at 24MHz while the board is active
+ * and drops to 4MHz in standby, so timing comes from CLOCK_Hz(), the
+ * live value, rather than a fixed Fosc.
  *
  ********************************************************************/
 
@@ -64,16 +89,32 @@
  **********************************************************************/
 
 #include "mcc_generated_files/mcc.h"
-#include <util/delay.h>
+#include "hal.h"
+#include "systick.h"
+#include "protocol.h"
+#include "trigger.h"
+#include "led.h"
+#include "bias.h"
+#include "sequencer.h"
+#include "ramp.h"
+#include "regulator.h"
+#include "config.h"
+#include "power.h"
+#include "lowpower.h"
+#include "clock.h"
+#include "bus.h"
+#include "profile.h"
+#include "print.h"
 
 /**********************************************************************
  * Constant Definitions:
  **********************************************************************/
 
-#define PWR_DELAY           50                                                  // 50ms
-#define RX_DELAY            100                                                 // 100ms
-#define VREF_STARTUP_TIME   (50)                                                // VREF start-up time - microseconds
-#define LSB_MASK            (0x03)                                              // Mask needed to get the 2 LSb for DAC Data Register
+#define CLI_TIMEOUT         SYSTICK_MS(5000)                                    // 5s without data drops a partial command
+#define CLI_PARAM_MAX       22                                                  // Longest parameter, Mssss,pppp,iiii,mmmmm,E
+#define BIN_TIMEOUT         SYSTICK_MS(100)                                     // Gap that drops a partial binary frame
+#define BAUD_TIMEOUT        SYSTICK_MS(2000)                                    // New baud rate without a command reverts
+#define BAUD_MAX            1000000UL                                           // Beyond that the CDC bridge drops bytes
                                                                                 /* TMR_CLK = F_CPU / PRESCALER = 4MHz / 4 = 1MHz */
 /**********************************************************************
  * Variable Declarations:
@@ -81,32 +122,120 @@
 
 volatile uint16_t adcVal = 0;                                                   // global variable for debug purposes
 typedef enum {ACTIVE, STANDBY} programs_t;
+typedef enum {CLI_ASCII, CLI_BINARY} cli_mode_t;
 
-static programs_t current_program = STANDBY;
+static programs_t current_program = STANDBY;                                    // ACTIVE once the rails are up
+static config_t restore_config;                                                 // Applied when the rails are up
+static bool restore_pending = false;
+static cli_mode_t cli_mode = CLI_ASCII;
+
+typedef struct
+{
+    uint8_t command;                                                            // Command letter
+    uint8_t min_param;                                                          // Parameter characters needed
+    uint8_t max_param;                                                          // Dispatch as soon as this many arrive
+    void (*handler)(uint8_t command, const uint8_t *param, uint8_t length);
+} cli_command_t;
+
+static const cli_command_t *cli_command = NULL;                                 // Command being received, NULL when idle
+static uint8_t cli_param[CLI_PARAM_MAX];
+static uint8_t cli_length = 0;
+static uint32_t cli_last_rx = 0;                                                // Tick of last byte, for timeout
+static protocol_frame_t bin_frame;                                              // Binary frame being received
+static uint32_t baud_pending = 0;                                               // Switched once the reply is out
+static uint32_t baud_previous = 0;                                              // Restored on timeout, 0 once confirmed
+static uint32_t baud_start;                                                     // Tick of the switch
+static const char led_names[][4] PROGMEM = {"450", "410", "365", "295", "278", "255", "235"};
 
 /**********************************************************************
  * Function Prototypes:
  **********************************************************************/
 
 static void WATMON_Initialize(void);                                            // Initialize device
-static void CLI_Run(void);
-static void CLI_Execute_Command(uint8_t);
+static void CLI_Run(void);                                                      // Feed received bytes to the parser
+static void CLI_Execute_Command(void);                                          // Dispatch complete command
+static bool CLI_Legacy_Complete(void);                                          // Tx and Sxxxx need no line end
 static void Print_Menu(void);
 static void USART_to_CDC(void);
-static uint8_t Unblocking_Read(void);
-static uint8_t Read_Parameter(void);                                            // Receive single character
-static void Set_Bias_Requested(void);                                           // Receive four characters and write to DAC
+static void CLI_Board(uint8_t, const uint8_t *, uint8_t);                       // E, D
+static void CLI_Trigger(uint8_t, const uint8_t *, uint8_t);                     // Tx, TM, TSxxxx, TN
+static void CLI_Rate(uint8_t, const uint8_t *, uint8_t);                        // Rx
+static void CLI_Frequency(uint8_t, const uint8_t *, uint8_t);                   // Fxxxxxxxx
+static void CLI_Width(uint8_t, const uint8_t *, uint8_t);                       // Wuxxxxxxxxx
+static void CLI_Burst(uint8_t, const uint8_t *, uint8_t);                       // Nxxxxxxxxxx
+static void CLI_Count(uint8_t, const uint8_t *, uint8_t);                       // C, Z
+static void CLI_Sequence(uint8_t, const uint8_t *, uint8_t);                    // Alcxxxx,bbbb, Gxxxx, X, K
+static void CLI_Ramp(uint8_t, const uint8_t *, uint8_t);                        // Ms,p,i,m[,E], Yxxxx, Hxxxxx[,E]
+static void CLI_Notify(void);                                                   // Report finished background work
+static void CLI_Baud(void);                                                     // Baud rate switch and fallback
+static bool CLI_Tick_Idle(void);                                                // Nothing counting system ticks
+static void CLI_LED(uint8_t, const uint8_t *, uint8_t);                         // Lx
+static void CLI_Bias(uint8_t, const uint8_t *, uint8_t);                        // Sxxxx, SMxxxxx
+static void CLI_Calibrate(uint8_t, const uint8_t *, uint8_t);                   // U, UAg,o, UDg,o, UW
+static void CLI_Config(uint8_t, const uint8_t *, uint8_t);                      // OS, OA, OR, ONxxx, OBxxxxxxx
+static void CLI_Query(uint8_t, const uint8_t *, uint8_t);                       // Q
+static void CLI_Average(uint8_t, const uint8_t *, uint8_t);                     // Vx
+static void CLI_Info(uint8_t, const uint8_t *, uint8_t);                        // I, IC, II, IA, IE
+static void CLI_Loop(uint8_t, const uint8_t *, uint8_t);                        // Pxxxxx, Jp,i,t
+static void CLI_Binary(uint8_t, const uint8_t *, uint8_t);                      // B
+static void CLI_Print_Status(uint8_t);                                          // Error text for a failed command
+static void BIN_Run(uint8_t);                                                   // Feed a byte to the frame receiver
+static void BIN_Execute_Command(const protocol_frame_t *);                      // Dispatch a complete frame
+static void BIN_Put32(uint8_t *, uint32_t);                                     // Little endian store
+static uint8_t Set_Bias_Requested(uint16_t);                                    // Write to Bias DAC
 static void Send_Bias_Read(void);                                               // Reads ADC and sends value out UART
 static void BoardSetStatus(uint8_t);                                            // Enable and disable hardware routines
-static void SetTrigger(void);                                                   // Sets trigger source
-static void SetRate(void);                                                      // Sets internal trigger source rate
-static void SetLED(void);                                                       // Set LED (xor), if any set, then set sync out
-static void VREF_init(void);
-static void DAC0_init(void);
-static void DAC0_setVal(uint16_t val);
-static void ADC0_init(void);
-static uint16_t ADC0_read(void);
-static void TCA0_init(char speed);
+static uint8_t SetTrigger(uint8_t);                                             // Sets trigger source
+static uint8_t SetSync(uint8_t, uint32_t);                                      // Sets trigger sync role
+static uint8_t SetRate(uint8_t);                                                // Sets internal trigger source rate
+static uint8_t SetFrequency(uint32_t);                                          // Sets internal trigger rate in Hz
+static uint8_t SetWidth(trigger_width_t, uint32_t);                             // Sets internal trigger pulse width
+static uint8_t SetBurst(uint32_t);                                              // Starts a burst of N triggers
+static uint8_t SetSequence(uint8_t, const sequencer_entry_t *, uint32_t);       // Sequencer add, start, stop, clear
+static uint8_t SetRamp(uint8_t, const uint16_t *, bool);                        // Bias ramp start, stop and table
+static uint8_t SetRegulator(uint8_t, uint16_t);                                 // Bias loop start and stop
+static uint8_t SetConfig(uint8_t);                                              // Save or restore operating point
+static uint8_t SetClock(uint8_t);                                               // Clock source and measurement
+static uint8_t SetAddress(uint32_t);                                            // RS-485 board address
+static uint8_t SetBaud(uint32_t);                                               // Baud rate after the reply
+static uint8_t ApplyConfig(void);                                               // Restore once the board is active
+static bool CLI_Parse_Number(const uint8_t *, uint8_t, uint32_t *);             // ASCII digits to binary
+static uint8_t CLI_Parse_List(const uint8_t *, uint8_t, uint32_t *, uint8_t);   // Comma separated numbers
+static uint8_t SetLED(uint8_t);                                                 // Set LED (xor), if any set, then set sync out
+
+/**********************************************************************
+ * Command Table:
+ **********************************************************************/
+
+static const cli_command_t cli_commands[] =
+{
+    {'E', 0, 0,             CLI_Board},
+    {'D', 0, 0,             CLI_Board},
+    {'T', 1, 11,            CLI_Trigger},
+    {'R', 1, 1,             CLI_Rate},
+    {'F', 1, 8,             CLI_Frequency},
+    {'W', 2, 10,            CLI_Width},
+    {'N', 1, 10,            CLI_Burst},
+    {'C', 0, 0,             CLI_Count},
+    {'Z', 0, 0,             CLI_Count},
+    {'A', 3, 20,            CLI_Sequence},
+    {'G', 1, 10,            CLI_Sequence},
+    {'X', 0, 0,             CLI_Sequence},
+    {'K', 0, 0,             CLI_Sequence},
+    {'M', 0, 22,            CLI_Ramp},
+    {'Y', 0, 4,             CLI_Ramp},
+    {'H', 1, 7,             CLI_Ramp},
+    {'L', 1, 1,             CLI_LED},
+    {'S', 1, 6,             CLI_Bias},
+    {'U', 0, 14,            CLI_Calibrate},
+    {'O', 1, 8,             CLI_Config},
+    {'Q', 0, 0,             CLI_Query},
+    {'V', 1, 1,             CLI_Average},
+    {'I', 0, 1,             CLI_Info},
+    {'P', 0, 5,             CLI_Loop},
+    {'J', 0, 17,            CLI_Loop},
+    {'B', 0, 0,             CLI_Binary},
+};
 
 /**********************************************************************
  * Interrupt Code:
@@ -120,18 +249,45 @@ static void TCA0_init(char speed);
 
 int main (void)
 {  
+    config_t config;
+    bool standby;
+
     SYSTEM_Initialize();
     WATMON_Initialize();                                                        // Init specifics of Wat Mon
-    VREF_init();
-    DAC0_init();
-    DAC0_setVal(1023);                                                          // Make sure set low to start
-    ADC0_init();
+    BIAS_Initialize();                                                          // DAC set low to start
+    BIAS_EnableADC(false);                                                      // Until the board is enabled
     USART_to_CDC();
+    BUS_Initialize();                                                           // RS-485 moves USART0 pins
+    SYSTICK_Initialize();
+    CLOCK_Initialize();                                                         // TCB2 cycle counter
+#if PROFILE_ENABLE
+    PROFILE_Initialize();
+#endif
+    TRIGGER_Initialize();                                                       // Pulse counter runs from power up
+    SEQUENCER_Initialize();
+    RAMP_Initialize();
+    REGULATOR_Initialize();
+    POWER_Initialize();
+    LOWPOWER_Initialize();
+    sei();                                                                      // UART RX/TX run from interrupts
     Print_Menu();
+    if(CONFIG_Load(&config) && config.auto_restore && config.active)
+    {
+        SetConfig('R');                                                         // Finishes when the rails are up
+    }
 	
     while(1)
     {
         CLI_Run();                                                              // Check for data, and do something with it
+        CLI_Notify();
+        CLI_Baud();
+        standby = (current_program == STANDBY) && (POWER_State() == POWER_OFF) && !CLOCK_Measuring();
+        if(standby && USART0_IsTxDone())
+        {
+            CLOCK_Set(CLOCK_SLOW);                                              // Down to 4MHz, 'E' raises it to 24MHz
+        }
+        SYSTICK_SetSlow(standby && CLI_Tick_Idle());                            // 1Hz PIT, full rate again once awake and busy
+        LOWPOWER_Sleep(standby);
     }
 }
 
@@ -160,48 +316,48 @@ static void WATMON_Initialize(void)
     
 // Trig distribution OE's, all out, and low
 
-PORTC.DIRSET = PIN1_bm;                                                         // OE7 = PC1, set output, set low
-PORTC.OUTCLR = PIN1_bm;
+HAL_PinOutput(&PORTC, PIN1_bm);                                                 // OE7 = PC1, set output, set low
+HAL_PinClear(&PORTC, PIN1_bm);
 
-PORTC.DIRSET = PIN0_bm;                                                         // OE6 = PC0, set output, set low
-PORTC.OUTCLR = PIN0_bm;
+HAL_PinOutput(&PORTC, PIN0_bm);                                                 // OE6 = PC0, set output, set low
+HAL_PinClear(&PORTC, PIN0_bm);
 
-PORTF.DIRSET = PIN5_bm;                                                         // OE5 = PF5, set output, set low
-PORTF.OUTCLR = PIN5_bm;
+HAL_PinOutput(&PORTF, PIN5_bm);                                                 // OE5 = PF5, set output, set low
+HAL_PinClear(&PORTF, PIN5_bm);
 
-PORTF.DIRSET = PIN4_bm;                                                         // OE4 = PF4, set output, set low
-PORTF.OUTCLR = PIN4_bm;
+HAL_PinOutput(&PORTF, PIN4_bm);                                                 // OE4 = PF4, set output, set low
+HAL_PinClear(&PORTF, PIN4_bm);
 
-PORTF.DIRSET = PIN3_bm;                                                         // OE3 = PF3, set output, set low
-PORTF.OUTCLR = PIN3_bm;
+HAL_PinOutput(&PORTF, PIN3_bm);                                                 // OE3 = PF3, set output, set low
+HAL_PinClear(&PORTF, PIN3_bm);
 
-PORTF.DIRSET = PIN2_bm;                                                         // OE2 = PF2, set output, set low
-PORTF.OUTCLR = PIN2_bm;
+HAL_PinOutput(&PORTF, PIN2_bm);                                                 // OE2 = PF2, set output, set low
+HAL_PinClear(&PORTF, PIN2_bm);
 
-PORTF.DIRSET = PIN1_bm;                                                         // OE1 = PF1, set output, set low
-PORTF.OUTCLR = PIN1_bm;
+HAL_PinOutput(&PORTF, PIN1_bm);                                                 // OE1 = PF1, set output, set low
+HAL_PinClear(&PORTF, PIN1_bm);
 
-PORTF.DIRSET = PIN0_bm;                                                         // OE0 = PF0, set output, set low
-PORTF.OUTCLR = PIN0_bm;
+HAL_PinOutput(&PORTF, PIN0_bm);                                                 // OE0 = PF0, set output, set low
+HAL_PinClear(&PORTF, PIN0_bm);
 
 // Trig control, all out, and low
 
-PORTD.DIRSET = PIN3_bm;                                                         // CLK_SEL = PD3, set output, set low
-PORTD.OUTCLR = PIN3_bm;
+HAL_PinOutput(&PORTD, PIN3_bm);                                                 // CLK_SEL = PD3, set output, set low
+HAL_PinClear(&PORTD, PIN3_bm);
 
-PORTC.DIRSET = PIN3_bm;                                                         // TRIG1 = PC3, set output, set low
-PORTC.OUTCLR = PIN3_bm;
+HAL_PinOutput(&PORTC, PIN3_bm);                                                 // TRIG1 = PC3, set output, set low
+HAL_PinClear(&PORTC, PIN3_bm);
 
 // Power control, all out, and low
 
-PORTD.DIRSET = PIN2_bm;                                                         // BIAS_ENABLE = PD2, set output, set low
-PORTD.OUTCLR = PIN2_bm;
+HAL_PinOutput(&PORTD, PIN2_bm);                                                 // BIAS_ENABLE = PD2, set output, set low
+HAL_PinClear(&PORTD, PIN2_bm);
 
-PORTD.DIRSET = PIN7_bm;                                                         // 3V3_SW_ENABLE = PD7, set output, set low
-PORTD.OUTCLR = PIN7_bm;
+HAL_PinOutput(&PORTD, PIN7_bm);                                                 // 3V3_SW_ENABLE = PD7, set output, set low
+HAL_PinClear(&PORTD, PIN7_bm);
 
-PORTC.DIRSET = PIN2_bm;                                                         // 5V_SW_ENABLE = PC2, set output, set low
-PORTC.OUTCLR = PIN2_bm;
+HAL_PinOutput(&PORTC, PIN2_bm);                                                 // 5V_SW_ENABLE = PC2, set output, set low
+HAL_PinClear(&PORTC, PIN2_bm);
 
 }
 
@@ -209,705 +365,2500 @@ PORTC.OUTCLR = PIN2_bm;
 /*********************************************************************
  * Function:        static void CLI_Run(void)  
  *
- * PreCondition:    None
+ * PreCondition:    UART and system tick running
  *
  * Input:           None
  *
  * Output:          None
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    Dispatches commands
  *
- * Overview:        Looks for data, if it's received, then call command routine
+ * Overview:        Parser state machine, takes whatever bytes are
+ *                  buffered and never waits.  A command is dispatched
+ *                  when its parameter is complete or on CR/LF, a
+ *                  partial command is dropped after CLI_TIMEOUT.
+ *                  Legacy fixed length forms dispatch on their own,
+ *                  see CLI_Legacy_Complete
+ *                  In binary mode bytes go to the frame receiver
  *
  ********************************************************************/
 
 static void CLI_Run(void)                                                       // Looks for data
 {
     uint8_t ch = 0;
+    uint8_t i;
     
-    ch = Unblocking_Read();
+    while(USART0_IsRxReady())
+    {
+        ch = USART0_Read();
+        cli_last_rx = SYSTICK_Get();
+
+        if(cli_mode == CLI_BINARY)
+        {
+            BIN_Run(ch);
+        }
+        else if(cli_command == NULL)                                                 // Idle, expect a command letter
+        {
+            if((ch == '\n') || (ch == '\r') || (ch == '\0'))
+            {
+                continue;
+            }
+            for(i = 0; i < sizeof(cli_commands) / sizeof(cli_commands[0]); i++)
+            {
+                if(cli_commands[i].command == ch)
+                {
+                    cli_command = &cli_commands[i];
+                    break;
+                }
+            }
+            if(cli_command == NULL)
+            {
+                PRINT_Text(PSTR("\n\rInvalid Command!\n\r"));
+                Print_Menu();
+                continue;
+            }
+            cli_length = 0;
+            if(cli_command->max_param == 0)
+            {
+                CLI_Execute_Command();
+            }
+        }
+        else if((ch == '\n') || (ch == '\r'))                                   // Line end, parameter done
+        {
+            CLI_Execute_Command();
+        }
+        else
+        {
+            cli_param[cli_length++] = ch;
+            if((cli_length >= cli_command->max_param) || CLI_Legacy_Complete())
+            {
+                CLI_Execute_Command();
+            }
+        }
+    }
+
+    if(cli_mode == CLI_BINARY)
+    {
+        if(SYSTICK_Expired(cli_last_rx, BIN_TIMEOUT))
+        {
+            PROTOCOL_Reset();                                                   // Silent, host retries on no reply
+        }
+    }
+    else if((cli_command != NULL) && SYSTICK_Expired(cli_last_rx, CLI_TIMEOUT))
+    {
+        cli_command = NULL;
+        PRINT_Text(PSTR("\r\nCommand Timeout\r\n"));
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void CLI_Execute_Command(void) 
+ *
+ * PreCondition:    cli_command set
+ *
+ * Input:           None (command and parameter from parser)
+ *
+ * Output:          None
+ *
+ * Side Effects:    Parser returns to idle
+ *
+ * Overview:        Configures Board
+ *
+ ********************************************************************/
+
+
+static void CLI_Execute_Command(void)
+{
+    const cli_command_t *command = cli_command;
+
+    cli_command = NULL;
     
-    if((ch != '\n') && (ch != '\r') && (ch != '\0'))                            // If data is valid, execute command
+    if(cli_length < command->min_param)
     {
-        CLI_Execute_Command(ch);
+        PRINT_Text(PSTR("\n\rInvalid Command!\n\r"));
+        Print_Menu();
+        return;
     }
+    baud_previous = 0;                                                          // Host is talking at the new rate
+    PROFILE_START(C);
+    command->handler(command->command, cli_param, cli_length);
+    PROFILE_STOP(C, PROFILE_COMMAND);
 }
 
 
 /*********************************************************************
- * Function:        static void CLI_Execute_Command(uint8_t command) 
+ * Function:        static bool CLI_Legacy_Complete(void)
  *
- * PreCondition:    None
+ * PreCondition:    cli_command set, at least one parameter byte
+ *
+ * Input:           None (command and parameter from parser)
+ *
+ * Output:          true if the parameter so far is a whole legacy form
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Hosts send Tx and Sxxxx with no line end and the
+ *                  next command straight after.  Only TSxxxx and
+ *                  SMxxxxx, added later, wait for CR/LF
+ *
+ ********************************************************************/
+
+static bool CLI_Legacy_Complete(void)
+{
+    switch(cli_command->command)
+    {
+        case 'T':
+            return cli_param[0] != 'S';                                         // TI, TE, TM, TN
+        case 'S':
+            return (cli_param[0] != 'M') && (cli_length == 4);                  // 4 digit raw DAC code
+        default:
+            return false;
+    }
+}
+
+
+/*********************************************************************
+ * Function:        CLI_Board, CLI_Trigger, CLI_Rate, CLI_Frequency,
+ *                  CLI_Width, CLI_Burst, CLI_Count, CLI_Sequence,
+ *                  CLI_Ramp, CLI_LED, CLI_Bias, CLI_Query, CLI_Average,
+ *                  CLI_Info, CLI_Loop, CLI_Calibrate, CLI_Config,
+ *                  CLI_Binary
+ *
+ * PreCondition:    Complete command received
  *
- * Input:           Command received from UART
+ * Input:           command - command letter
+ *                  param - parameter characters
+ *                  length - number of parameter characters
  *
  * Output:          None
  *
  * Side Effects:    Unknown yet
  *
- * Overview:        Configures Board
+ * Overview:        Command table entries, pass the parameter on and
+ *                  print the result
  *
  ********************************************************************/
 
+static void CLI_Board(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    BoardSetStatus(command);
+    if(command == 'E')
+    {
+        PRINT_Text(PSTR("\r\nBoard Powering Up\r\n"));                          // CLI_Notify reports the result
+    }
+    else
+    {
+        PRINT_Text(PSTR("\r\nBoard Powering Down\r\n"));
+    }
+}
+
+static void CLI_Trigger(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    uint32_t delay = 0;
+    uint8_t status;
+
+    if((param[0] == 'M') || (param[0] == 'S') || (param[0] == 'N'))
+    {
+        status = STATUS_INVALID;
+        if((length == 1) || ((param[0] == 'S') && CLI_Parse_Number(&param[1], length - 1, &delay)))
+        {
+            status = SetSync(param[0], delay);
+        }
+        if(status != STATUS_OK)
+        {
+            CLI_Print_Status(status);
+        }
+        else if(param[0] == 'M')
+        {
+            PRINT_Text(PSTR("\r\nTrigger Sync: Master, TRIG1 on PA2\r\n"));
+        }
+        else if(param[0] == 'S')
+        {
+            TRIGGER_GetSync(&delay);
+            PRINT_Text(PSTR("\r\nTrigger Sync: Slave to PA3, "));
+            PRINT_Unsigned(delay);
+            PRINT_Text(PSTR(" ns delay\r\n"));
+        }
+        else
+        {
+            PRINT_Text(PSTR("\r\nTrigger Sync: Off\r\n"));
+        }
+        return;
+    }
+
+    status = (length == 1) ? SetTrigger(param[0]) : STATUS_INVALID;
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+    }
+    else if(param[0] == 'I')
+    {
+        PRINT_Text(PSTR("\r\nTrigger Source: Set Internal\r\n"));
+    }
+    else
+    {
+        PRINT_Text(PSTR("\r\nTrigger Source: Set External\r\n"));
+    }
+}
+
+static void CLI_Rate(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    uint8_t status = SetRate(param[0]);
+
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+    }
+    else if(param[0] == 'S')
+    {
+        PRINT_Text(PSTR("\r\nTrigger Rate: Set 1.5kHz\r\n"));
+    }
+    else
+    {
+        PRINT_Text(PSTR("\r\nTrigger Rate: Set 8MHz\r\n"));
+    }
+}
+
+static void CLI_Frequency(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    const trigger_config_t *config;
+    uint32_t hz, achieved;
+    uint16_t millihertz;
+    uint8_t status;
+
+    if(current_program == STANDBY)
+    {
+        status = STATUS_NOT_ENABLED;
+    }
+    else if(!CLI_Parse_Number(param, length, &hz))
+    {
+        status = STATUS_INVALID;
+    }
+    else
+    {
+        status = SetFrequency(hz);
+    }
+
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+        return;
+    }
+    config = TRIGGER_GetConfig();
+    achieved = TRIGGER_GetFrequency(&millihertz);
+    PRINT_Text(PSTR("\r\nTrigger Rate: "));
+    PRINT_Unsigned(achieved);
+    PRINT_Char('.');
+    PRINT_Padded(millihertz, 3);
+    PRINT_Text(PSTR("Hz, error "));
+    PRINT_Signed(TRIGGER_GetErrorPpm(hz));
+    PRINT_Text(PSTR("ppm\r\n"));
+    PRINT_Text((config->mode == TRIGGER_SPLIT) ? PSTR("8 bit, DIV") : PSTR("16 bit, DIV"));
+    PRINT_Unsigned(config->divider);
+    PRINT_Text(PSTR(", period "));
+    PRINT_Unsigned(config->period);
+    PRINT_Text(PSTR("\r\n"));
+}
+
+static void CLI_Width(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    trigger_width_t unit;
+    uint32_t value;
+    uint8_t status;
+
+    switch(param[0])
+    {
+        case 'T':
+            unit = TRIGGER_WIDTH_TICKS;
+            break;
+        case 'N':
+            unit = TRIGGER_WIDTH_NS;
+            break;
+        default:
+            unit = TRIGGER_WIDTH_PERCENT;                                       // 'D', anything else fails below
+            break;
+    }
+
+    if(current_program == STANDBY)
+    {
+        status = STATUS_NOT_ENABLED;
+    }
+    else if(((param[0] != 'T') && (param[0] != 'N') && (param[0] != 'D')) ||
+            !CLI_Parse_Number(&param[1], length - 1, &value))
+    {
+        status = STATUS_INVALID;
+    }
+    else
+    {
+        status = SetWidth(unit, value);
+    }
+
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+        return;
+    }
+    PRINT_Text(PSTR("\r\nPulse Width: "));
+    PRINT_Unsigned(TRIGGER_GetConfig()->compare);
+    PRINT_Text(PSTR(" ticks, "));
+    PRINT_Unsigned(TRIGGER_GetWidthNs());
+    PRINT_Text(PSTR("ns\r\n"));
+}
+
+static void CLI_Burst(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    uint32_t pulses;
+    uint8_t status;
+
+    if(current_program == STANDBY)
+    {
+        status = STATUS_NOT_ENABLED;
+    }
+    else if(!CLI_Parse_Number(param, length, &pulses))
+    {
+        status = STATUS_INVALID;
+    }
+    else
+    {
+        status = SetBurst(pulses);
+    }
+
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+        return;
+    }
+    PRINT_Text(PSTR("\r\nBurst: "));
+    PRINT_Unsigned(pulses);
+    PRINT_Text(PSTR(" pulses\r\n"));
+}
+
+static void CLI_Count(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    PRINT_Text(PSTR("\r\nTrigger Count = "));
+    PRINT_Unsigned(TRIGGER_GetCount(command == 'Z'));
+    PRINT_Text((command == 'Z') ? PSTR(", reset\r\n") : PSTR("\r\n"));
+}
 
-static void CLI_Execute_Command(uint8_t command)
+static void CLI_Sequence(uint8_t command, const uint8_t *param, uint8_t length)
 {
+    sequencer_entry_t entry;
+    uint32_t value = 0;
+    uint8_t i, status;
+
+    status = STATUS_INVALID;
+    if(command == 'A')                                                          // A<led><C|T><amount>[,<bias>]
+    {
+        entry.led = param[0] - '0';
+        entry.mode = (param[1] == 'T') ? SEQUENCER_DWELL : SEQUENCER_COUNT;
+        entry.bias = BIAS_UNCHANGED;
+        for(i = 2; (i < length) && (param[i] != ','); i++)
+        {
+            ;
+        }
+        if(((param[1] == 'C') || (param[1] == 'T')) &&
+           CLI_Parse_Number(&param[2], i - 2, &entry.amount) &&
+           ((i == length) || (CLI_Parse_Number(&param[i + 1], length - i - 1, &value) && (value <= BIAS_DAC_MAX))))
+        {
+            if(i != length)
+            {
+                entry.bias = value;
+            }
+            status = SetSequence(command, &entry, 0);
+        }
+    }
+    else if((command != 'G') || CLI_Parse_Number(param, length, &value))
+    {
+        status = SetSequence(command, NULL, value);
+    }
+
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+        return;
+    }
     switch(command)
     {
-        case 'E':
-            BoardSetStatus('E');
+        case 'A':
+            PRINT_Text(PSTR("\r\nSequence Entry "));
+            PRINT_Unsigned(SEQUENCER_Length());
+            PRINT_Text(PSTR(" Added\r\n"));
             break;
-        case 'D':
-            BoardSetStatus('D');
+        case 'G':
+            PRINT_Text(PSTR("\r\nSequence Started\r\n"));
             break;
-        case 'T':
-            SetTrigger();
+        case 'X':
+            PRINT_Text(PSTR("\r\nSequence Stopped\r\n"));
             break;
-        case 'R':
-            SetRate();
+        default:
+            PRINT_Text(PSTR("\r\nSequence Cleared\r\n"));
             break;
-        case 'L':
-            SetLED();
-            break;            
-        case 'S':
-            Set_Bias_Requested();
+    }
+}
+
+static void CLI_Ramp(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    uint32_t values[4];
+    uint16_t args[4];
+    uint8_t i, count;
+    uint8_t status = STATUS_INVALID;
+    bool emit = false;
+
+    if((length >= 2) && (param[length - 2] == ',') && (param[length - 1] == 'E'))
+    {
+        emit = true;                                                            // Trailing ,E sends RAMP_VALUE frames
+        length -= 2;
+    }
+    count = CLI_Parse_List(param, length, values, 4);
+    for(i = 0; i < count; i++)
+    {
+        args[i] = (values[i] > 0xFFFF) ? 0xFFFF : values[i];                    // Out of range either way
+    }
+
+    if(command == 'M')
+    {
+        if(length == 0)
+        {
+            status = emit ? STATUS_INVALID : SetRamp('X', NULL, false);
+        }
+        else if(count == 4)
+        {
+            status = SetRamp('L', args, emit);
+        }
+    }
+    else if(command == 'Y')
+    {
+        if(length == 0)
+        {
+            status = emit ? STATUS_INVALID : SetRamp('K', NULL, false);
+        }
+        else if((count == 1) && !emit)
+        {
+            status = SetRamp('A', args, false);
+        }
+    }
+    else if(count == 1)
+    {
+        status = SetRamp('T', args, emit);
+    }
+
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+        return;
+    }
+    switch(command)
+    {
+        case 'M':
+            PRINT_Text((length == 0) ? PSTR("\r\nRamp Stopped\r\n") : PSTR("\r\nRamp Started\r\n"));
+            break;
+        case 'Y':
+            if(length == 0)
+            {
+                PRINT_Text(PSTR("\r\nRamp Table Cleared\r\n"));
+            }
+            else
+            {
+                PRINT_Text(PSTR("\r\nRamp Table Point "));
+                PRINT_Unsigned(RAMP_TableLength());
+                PRINT_Text(PSTR(" Added\r\n"));
+            }
+            break;
+        default:
+            PRINT_Text(PSTR("\r\nRamp Table Started\r\n"));
             break;
-        case 'Q':
-            Send_Bias_Read();
+    }
+}
+
+static void CLI_LED(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    uint8_t led = param[0] - '0';
+    uint8_t status = SetLED(led);
+
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+    }
+    else if(led == 0)
+    {
+        PRINT_Text(PSTR("\r\nLEDs off\r\n"));
+    }
+    else
+    {
+        PRINT_Text(PSTR("\r\n"));
+        PRINT_Text(led_names[led - 1]);
+        PRINT_Text(PSTR("nm LED on\r\n"));
+    }
+}
+
+static void CLI_Bias(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    bool millivolts = (param[0] == 'M');
+    uint32_t sum;
+    uint8_t status;
+
+    if(current_program == STANDBY)
+    {
+        status = STATUS_NOT_ENABLED;
+    }
+    else if(!millivolts)
+    {
+        status = CLI_Parse_Number(param, length, &sum) ?                        // Legacy raw DAC code, 1023 = off
+                 Set_Bias_Requested(sum) : STATUS_INVALID;
+    }
+    else if((length < 2) || !CLI_Parse_Number(&param[1], length - 1, &sum) || (sum > 0xFFFF))
+    {
+        status = STATUS_INVALID;
+    }
+    else
+    {
+        status = Set_Bias_Requested(BIAS_DACFromMillivolts(sum));
+    }
+
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+        return;
+    }
+    if(!millivolts)
+    {
+        PRINT_Text(PSTR("\r\nBias DAC Set\r\n"));
+        return;
+    }
+    PRINT_Text(PSTR("\r\nBias Set: "));
+    PRINT_Unsigned(BIAS_DACToMillivolts(BIAS_GetDAC()));
+    PRINT_Text(PSTR(" mV, DAC = "));
+    PRINT_Unsigned(BIAS_GetDAC());
+    PRINT_Text(PSTR("\r\n"));
+}
+
+static void CLI_Calibrate(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    bias_calibration_t calibration;
+    uint32_t gain, offset;
+    uint8_t i, sign;
+
+    BIAS_GetCalibration(&calibration);
+    if((length == 1) && (param[0] == 'W'))
+    {
+        BIAS_SaveCalibration();
+        PRINT_Text(PSTR("\r\nCalibration Saved\r\n"));
+        return;
+    }
+    if(length != 0)                                                             // A or D, gain, offset (may be negative)
+    {
+        for(i = 1; (i < length) && (param[i] != ','); i++)
+        {
+            ;
+        }
+        sign = ((i + 1 < length) && (param[i + 1] == '-')) ? 1 : 0;
+        if(((param[0] != 'A') && (param[0] != 'D')) || (i >= length - 1) ||
+           !CLI_Parse_Number(&param[1], i - 1, &gain) || (i == 1) || (gain == 0) || (gain > 0xFFFF) ||
+           !CLI_Parse_Number(&param[i + 1 + sign], length - i - 1 - sign, &offset) ||
+           (length - i - 1 - sign == 0) || (offset > 32767))
+        {
+            CLI_Print_Status(STATUS_INVALID);
+            return;
+        }
+        if(param[0] == 'A')
+        {
+            calibration.adc_gain = gain;
+            calibration.adc_offset = sign ? -(int16_t)offset : (int16_t)offset;
+        }
+        else
+        {
+            calibration.dac_gain = gain;
+            calibration.dac_offset = sign ? -(int16_t)offset : (int16_t)offset;
+        }
+        BIAS_SetCalibration(&calibration);
+    }
+    PRINT_Text(PSTR("\r\nDAC: "));
+    PRINT_Unsigned(calibration.dac_gain);
+    PRINT_Text(PSTR(" mV full drive, "));
+    PRINT_Signed(calibration.dac_offset);
+    PRINT_Text(PSTR(" mV offset\r\nADC: "));
+    PRINT_Unsigned(calibration.adc_gain);
+    PRINT_Text(PSTR(" mV full scale, "));
+    PRINT_Signed(calibration.adc_offset);
+    PRINT_Text(PSTR(" mV offset\r\n"));
+}
+
+static void CLI_Query(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    Send_Bias_Read();
+}
+
+static void CLI_Average(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    if(!BIAS_SetAveraging(param[0] - '0'))
+    {
+        CLI_Print_Status(STATUS_INVALID);
+        return;
+    }
+    PRINT_Text(PSTR("\r\nBias ADC Averaging: "));
+    PRINT_Unsigned(1 << BIAS_GetAveraging());
+    PRINT_Text(PSTR(" samples\r\n"));
+}
+
+static void CLI_Info(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    static const char sources[][9] PROGMEM = {"Internal", "Autotune", "External"};
+    uint32_t seconds;
+    uint16_t milliseconds;
+    uint8_t status;
+#if PROFILE_ENABLE
+    profile_stats_t stats;
+    uint8_t i;
+#endif
+
+    if(length == 0)
+    {
+        LOWPOWER_GetAsleep(&seconds, &milliseconds);
+        PRINT_Text(PSTR("\r\nAsleep "));
+        PRINT_Unsigned(seconds);
+        PRINT_Char('.');
+        PRINT_Padded(milliseconds, 3);
+        PRINT_Text(PSTR(" s of "));
+        PRINT_Unsigned(SYSTICK_Get() / SYSTICK_HZ);
+        PRINT_Text(PSTR(" s up, "));
+        PRINT_Unsigned(LOWPOWER_GetWakeups());
+        PRINT_Text(PSTR(" wake ups, "));
+        PRINT_Unsigned(LOWPOWER_GetTickWakeups());
+        PRINT_Text(PSTR(" by the tick\r\n"));
+        return;
+    }
+#if PROFILE_ENABLE
+    if((param[0] == 'P') || (param[0] == 'Z'))
+    {
+        PRINT_Text(PSTR("\r\nCycles at "));
+        PRINT_Unsigned(CLOCK_Hz());
+        PRINT_Text(PSTR(" Hz:\r\n"));
+        for(i = 0; PROFILE_Get(i, &stats, param[0] == 'Z'); i++)
+        {
+            PRINT_Text(PROFILE_Name(i));
+            PRINT_Text(PSTR(": "));
+            PRINT_Unsigned(stats.count);
+            PRINT_Text(PSTR(" samples, min "));
+            PRINT_Unsigned(stats.min);
+            PRINT_Text(PSTR(", max "));
+            PRINT_Unsigned(stats.max);
+            PRINT_Text(PSTR(", mean "));
+            PRINT_Unsigned(stats.mean);
+            PRINT_Text(PSTR("\r\n"));
+        }
+        return;
+    }
+#endif
+    status = (param[0] == 'C') ? STATUS_OK : SetClock(param[0]);
+    if(status == STATUS_OK)
+    {
+        status = SetClock('C');
+    }
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+        return;
+    }
+    PRINT_Text(PSTR("\r\nClock: "));
+    PRINT_Text(sources[CLOCK_GetSource()]);
+    PRINT_Text(PSTR(", "));
+    PRINT_Unsigned(CLOCK_Hz());
+    PRINT_Text(PSTR(" Hz, measuring against "));
+    PRINT_Text(CLOCK_Crystal() ? PSTR("XOSC32K\r\n") : PSTR("OSC32K\r\n"));
+}
+
+static void CLI_Loop(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    uint32_t values[3];
+    uint16_t kp, ki, tolerance;
+    uint8_t status = STATUS_INVALID;
+
+    if(command == 'P')
+    {
+        if(length == 0)
+        {
+            status = SetRegulator('X', 0);
+        }
+        else if(CLI_Parse_Number(param, length, &values[0]) && (values[0] <= 0xFFFF))
+        {
+            status = SetRegulator('G', values[0]);
+        }
+    }
+    else if(length == 0)
+    {
+        status = STATUS_OK;                                                     // J alone reports the tuning
+    }
+    else if((CLI_Parse_List(param, length, values, 3) == 3) &&
+            (values[0] <= 0xFFFF) && (values[1] <= 0xFFFF) && (values[2] <= 0xFFFF))
+    {
+        REGULATOR_SetGains(values[0], values[1], values[2]);
+        status = STATUS_OK;
+    }
+
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+        return;
+    }
+    if(command == 'J')
+    {
+        REGULATOR_GetGains(&kp, &ki, &tolerance);
+        PRINT_Text(PSTR("\r\nBias Loop Kp = "));
+        PRINT_Unsigned(kp);
+        PRINT_Text(PSTR(", Ki = "));
+        PRINT_Unsigned(ki);
+        PRINT_Text(PSTR(" (/65536), Tolerance = "));
+        PRINT_Unsigned(tolerance);
+        PRINT_Text(PSTR("\r\n"));
+    }
+    else if(length == 0)
+    {
+        PRINT_Text(PSTR("\r\nBias Loop Stopped\r\n"));
+    }
+    else
+    {
+        PRINT_Text(PSTR("\r\nBias Loop Started: "));
+        PRINT_Unsigned(BIAS_ADCToMillivolts(REGULATOR_GetSetpoint()));
+        PRINT_Text(PSTR(" mV\r\n"));
+    }
+}
+
+static void CLI_Config(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    uint32_t address, baud;
+    int32_t error;
+    bool clk2x;
+    uint8_t status;
+
+    if(param[0] == 'B')
+    {
+        baud = USART0_GetBaud();
+        status = STATUS_OK;
+        if(length > 1)
+        {
+            status = CLI_Parse_Number(&param[1], length - 1, &baud) ? SetBaud(baud) : STATUS_INVALID;
+        }
+        if(status != STATUS_OK)
+        {
+            CLI_Print_Status(status);
+            return;
+        }
+        USART0_CheckBaud(CLOCK_FAST_HZ, baud, &error, &clk2x);
+        PRINT_Text(PSTR("\r\nBaud Rate: "));
+        PRINT_Unsigned(baud);
+        PRINT_Text(PSTR(", error "));
+        PRINT_Signed(error);
+        PRINT_Text(clk2x ? PSTR("ppm, double speed\r\n") : PSTR("ppm\r\n"));
+        if(length > 1)
+        {
+            PRINT_Text(PSTR("Send a command at the new rate within 2s\r\n"));
+        }
+        return;
+    }
+    if(param[0] == 'N')
+    {
+        status = STATUS_OK;
+        if(length > 1)
+        {
+            status = CLI_Parse_Number(&param[1], length - 1, &address) ? SetAddress(address) : STATUS_INVALID;
+        }
+        if(status != STATUS_OK)
+        {
+            CLI_Print_Status(status);
+        }
+        else
+        {
+            PRINT_Text(PSTR("\r\nBus Address: "));
+            PRINT_Unsigned(BUS_GetAddress());
+            PRINT_Text(PSTR("\r\n"));
+        }
+        return;
+    }
+
+    status = (length == 1) ? SetConfig(param[0]) : STATUS_INVALID;
+    if(status != STATUS_OK)
+    {
+        CLI_Print_Status(status);
+    }
+    else if(param[0] == 'R')
+    {
+        PRINT_Text(restore_pending ? PSTR("\r\nConfiguration Restore after Power Up\r\n") : PSTR("\r\nConfiguration Restored\r\n"));
+    }
+    else
+    {
+        PRINT_Text((param[0] == 'A') ? PSTR("\r\nConfiguration Saved, restore at power up\r\n") : PSTR("\r\nConfiguration Saved\r\n"));
+    }
+}
+
+static void CLI_Binary(uint8_t command, const uint8_t *param, uint8_t length)
+{
+    PRINT_Text(PSTR("\r\nBinary Mode\r\n"));
+    PROTOCOL_Reset();
+    cli_mode = CLI_BINARY;
+}
+
+
+/*********************************************************************
+ * Function:        static void CLI_Print_Status(uint8_t status)
+ *
+ * PreCondition:    None
+ *
+ * Input:           status - STATUS_x from a command
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Prints the ASCII error message for a failed command
+ *
+ ********************************************************************/
+
+static void CLI_Print_Status(uint8_t status)
+{
+    if(status == STATUS_NOT_ENABLED)
+    {
+        PRINT_Text(PSTR("\r\nPlease Enable Board first: 'E' \n\r"));
+    }
+    else if(status == STATUS_BUSY)
+    {
+        PRINT_Text(PSTR("\r\nSequence, ramp or bias loop running, stop first: 'X', 'M' or 'P' \n\r"));
+    }
+    else
+    {
+        PRINT_Text(PSTR("\n\rInvalid Command!\n\r"));
+        Print_Menu();
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void CLI_Notify(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Unrequested messages, in the current protocol
+ *
+ ********************************************************************/
+
+static void CLI_Notify(void)
+{
+    uint32_t pulses;
+    uint16_t value;
+    uint8_t data[4];
+    uint8_t measured[8];
+    uint32_t hz;
+    int32_t ppm;
+    bool locked;
+    power_state_t power;
+    uint8_t rail, status;
+
+    if(POWER_Done(&power, &rail))
+    {
+        if(power == POWER_ON)
+        {
+            current_program = ACTIVE;
+            BIAS_EnableADC(true);
+        }
+        if(cli_mode == CLI_BINARY)
+        {
+            data[0] = (power == POWER_ON) ? 1 : ((power == POWER_FAULT) ? 2 : 0);
+            data[1] = rail;
+            PROTOCOL_Send(OP_ENABLE | PROTOCOL_NOTIFY, STATUS_OK, data, 2);
+        }
+        else if(power == POWER_FAULT)
+        {
+            PRINT_Text(PSTR("\r\nPower Fault: rail "));
+            PRINT_Unsigned(rail);
+            PRINT_Text(PSTR(" not good, Board Standby\r\n"));
+        }
+        else
+        {
+            PRINT_Text((power == POWER_ON) ? PSTR("\r\nBoard Active\r\n") : PSTR("\r\nBoard Standby\r\n"));
+        }
+        if((power == POWER_ON) && restore_pending)
+        {
+            status = ApplyConfig();
+            if(cli_mode == CLI_BINARY)
+            {
+                PROTOCOL_Send(OP_CONFIG_RESTORE | PROTOCOL_NOTIFY, status, NULL, 0);
+            }
+            else
+            {
+                PRINT_Text((status == STATUS_OK) ? PSTR("\r\nConfiguration Restored\r\n") : PSTR("\r\nConfiguration Not Valid\r\n"));
+            }
+        }
+        restore_pending = false;
+    }
+
+    if(TRIGGER_BurstDone(&pulses))
+    {
+        if(cli_mode == CLI_BINARY)
+        {
+            BIN_Put32(data, pulses);
+            PROTOCOL_Send(OP_BURST | PROTOCOL_NOTIFY, STATUS_OK, data, sizeof(data));
+        }
+        else
+        {
+            PRINT_Text(PSTR("\r\nBurst Done: "));
+            PRINT_Unsigned(pulses);
+            PRINT_Text(PSTR(" pulses\r\n"));
+        }
+    }
+    if(SEQUENCER_Done())
+    {
+        if(cli_mode == CLI_BINARY)
+        {
+            PROTOCOL_Send(OP_SEQ_START | PROTOCOL_NOTIFY, STATUS_OK, NULL, 0);
+        }
+        else
+        {
+            PRINT_Text(PSTR("\r\nSequence Done\r\n"));
+        }
+    }
+    while(RAMP_GetApplied(&value))
+    {
+        if(cli_mode == CLI_BINARY)
+        {
+            data[0] = value & 0xFF;
+            data[1] = value >> 8;
+            PROTOCOL_Send(OP_RAMP_VALUE | PROTOCOL_NOTIFY, STATUS_OK, data, 2);
+        }
+        else                                                                    // Data Visualizer RAMP_VALUE frame
+        {
+            USART0_Write(RAMP_FRAME_START);
+            USART0_Write(value & 0xFF);
+            USART0_Write(value >> 8);
+            USART0_Write(RAMP_FRAME_END);
+        }
+    }
+    if(RAMP_Done())
+    {
+        if(cli_mode == CLI_BINARY)
+        {
+            PROTOCOL_Send(OP_RAMP_STOP | PROTOCOL_NOTIFY, STATUS_OK, NULL, 0);
+        }
+        else
+        {
+            PRINT_Text(PSTR("\r\nRamp Done\r\n"));
+        }
+    }
+    if(CLOCK_MeasureDone(&hz, &ppm))
+    {
+        if(cli_mode == CLI_BINARY)
+        {
+            BIN_Put32(&measured[0], hz);
+            BIN_Put32(&measured[4], ppm);
+            PROTOCOL_Send(OP_CLOCK_MEASURE | PROTOCOL_NOTIFY, STATUS_OK, measured, sizeof(measured));
+        }
+        else
+        {
+            PRINT_Text(PSTR("\r\nClock Measured: "));
+            PRINT_Unsigned(hz);
+            PRINT_Text(PSTR(" Hz, "));
+            PRINT_Signed(ppm);
+            PRINT_Text(PSTR(" ppm\r\n"));
+        }
+    }
+    if(CLOCK_Failed())
+    {
+        if(cli_mode == CLI_BINARY)
+        {
+            data[0] = CLOCK_GetSource();
+            PROTOCOL_Send(OP_CLOCK | PROTOCOL_NOTIFY, STATUS_OK, data, 1);
+        }
+        else
+        {
+            PRINT_Text(PSTR("\r\nClock Failed: back on Internal\r\n"));
+        }
+    }
+    if(REGULATOR_LockChanged(&locked))
+    {
+        if(cli_mode == CLI_BINARY)
+        {
+            data[0] = locked;
+            PROTOCOL_Send(OP_LOOP_STATUS | PROTOCOL_NOTIFY, STATUS_OK, data, 1);
+        }
+        else
+        {
+            PRINT_Text(locked ? PSTR("\r\nBias Loop Locked\r\n") : PSTR("\r\nBias Loop Unlocked\r\n"));
+        }
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void CLI_Baud(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Clock goes to 24MHz if the slow clock cannot make
+ *                  the new rate, a partial command or frame is dropped
+ *
+ * Overview:        Switches the baud rate after SetBaud, and goes back
+ *                  to the previous one if no valid command or frame
+ *                  arrives within BAUD_TIMEOUT
+ *
+ ********************************************************************/
+
+static void CLI_Baud(void)
+{
+    uint32_t baud;
+    uint8_t data[4];
+    bool switched;
+
+    if((baud_pending != 0) && USART0_IsTxDone())
+    {
+        baud = USART0_GetBaud();
+        ENTER_CRITICAL(B);                                                      // No RX interrupt between the writes
+        switched = USART0_SetBaud(CLOCK_Hz(), baud_pending);
+        EXIT_CRITICAL(B);
+        if(!switched)
+        {
+            CLOCK_Set(CLOCK_FAST);                                              // Stays there while the rate needs it
+            ENTER_CRITICAL(B);
+            switched = USART0_SetBaud(CLOCK_Hz(), baud_pending);                // SetBaud checked it at 24MHz
+            EXIT_CRITICAL(B);
+        }
+        if(switched && (baud_previous == 0))
+        {
+            baud_previous = baud;                                               // Keep the last confirmed rate
+        }
+        baud_pending = 0;
+        baud_start = SYSTICK_Get();
+        cli_command = NULL;
+        PROTOCOL_Reset();
+    }
+    if((baud_previous != 0) && SYSTICK_Expired(baud_start, BAUD_TIMEOUT))
+    {
+        ENTER_CRITICAL(B);
+        USART0_SetBaud(CLOCK_Hz(), baud_previous);
+        EXIT_CRITICAL(B);
+        baud_previous = 0;
+        cli_command = NULL;
+        PROTOCOL_Reset();
+        if(cli_mode == CLI_BINARY)
+        {
+            BIN_Put32(data, USART0_GetBaud());
+            PROTOCOL_Send(OP_BAUD | PROTOCOL_NOTIFY, STATUS_OK, data, sizeof(data));
+        }
+        else
+        {
+            PRINT_Text(PSTR("\r\nBaud Rate: back to "));
+            PRINT_Unsigned(USART0_GetBaud());
+            PRINT_Text(PSTR(", no command received\r\n"));
+        }
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static bool CLI_Tick_Idle(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          True if no timeout, fallback or background job
+ *                  needs the tick at its full rate
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Host quiet for CLI_TIMEOUT covers a partial
+ *                  command or frame, the power sequence and clock
+ *                  measurement are already off in standby
+ *
+ ********************************************************************/
+
+static bool CLI_Tick_Idle(void)
+{
+    return (baud_previous == 0) && (baud_pending == 0) &&
+           SYSTICK_Expired(cli_last_rx, CLI_TIMEOUT) &&
+           !SEQUENCER_Running() && !RAMP_Running() && !REGULATOR_Running();
+}
+
+
+/*********************************************************************
+ * Function:        static bool CLI_Parse_Number(const uint8_t *param,
+ *                                               uint8_t length, uint32_t *value)
+ *
+ * PreCondition:    None
+ *
+ * Input:           param - ASCII digits, length - number of digits
+ *
+ * Output:          false if any character is not a digit or the value
+ *                  does not fit 32 bits
+ *
+ * Side Effects:    None
+ *
+ * Overview:        a2i function
+ *
+ ********************************************************************/
+
+static bool CLI_Parse_Number(const uint8_t *param, uint8_t length, uint32_t *value)
+{
+    uint32_t sum = 0;
+    uint8_t digit, i;
+
+    for(i = 0; i < length; i++)
+    {
+        digit = param[i] - '0';
+        if((digit > 9) || (sum > (UINT32_MAX - digit) / 10))
+        {
+            return false;
+        }
+        sum = (sum * 10) + digit;
+    }
+    *value = sum;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        static uint8_t CLI_Parse_List(const uint8_t *param,
+ *                          uint8_t length, uint32_t *values, uint8_t max)
+ *
+ * PreCondition:    None
+ *
+ * Input:           param - digits separated by commas
+ *                  values - receives up to max numbers
+ *
+ * Output:          Number of values, 0 if any field is empty, not a
+ *                  number or there are more than max
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Splits a parameter such as 0,1023,1,10
+ *
+ ********************************************************************/
+
+static uint8_t CLI_Parse_List(const uint8_t *param, uint8_t length, uint32_t *values, uint8_t max)
+{
+    uint8_t count = 0;
+    uint8_t start = 0;
+    uint8_t i;
+
+    for(i = 0; i <= length; i++)
+    {
+        if((i < length) && (param[i] != ','))
+        {
+            continue;
+        }
+        if((i == start) || (count >= max) ||
+           !CLI_Parse_Number(&param[start], i - start, &values[count]))
+        {
+            return 0;
+        }
+        count++;
+        start = i + 1;
+    }
+    return count;
+}
+
+
+/*********************************************************************
+ * Function:        static void BIN_Run(uint8_t ch)
+ *
+ * PreCondition:    cli_mode is CLI_BINARY
+ *
+ * Input:           ch - received byte
+ *
+ * Output:          None
+ *
+ * Side Effects:    Dispatches frames
+ *
+ * Overview:        Feeds the frame receiver, a frame with a bad CRC is
+ *                  answered with STATUS_BAD_CRC so the host can resend
+ *
+ ********************************************************************/
+
+static void BIN_Run(uint8_t ch)
+{
+    switch(PROTOCOL_Receive(ch, &bin_frame))
+    {
+        case PROTOCOL_FRAME:
+            {
+                PROFILE_START(C);
+                BIN_Execute_Command(&bin_frame);
+                PROFILE_STOP(C, PROFILE_COMMAND);
+            }
+            break;
+        case PROTOCOL_CRC_ERROR:
+            PROTOCOL_Send(bin_frame.opcode, STATUS_BAD_CRC, NULL, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void BIN_Put32(uint8_t *buffer, uint32_t value)
+ *
+ * PreCondition:    None
+ *
+ * Input:           buffer - 4 bytes, value - to store
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Little endian, the byte order of all binary fields
+ *
+ ********************************************************************/
+
+static void BIN_Put32(uint8_t *buffer, uint32_t value)
+{
+    buffer[0] = value & 0xFF;
+    buffer[1] = (value >> 8) & 0xFF;
+    buffer[2] = (value >> 16) & 0xFF;
+    buffer[3] = value >> 24;
+}
+
+
+/*********************************************************************
+ * Function:        static void BIN_Execute_Command(const protocol_frame_t *frame)
+ *
+ * PreCondition:    Frame with good CRC received
+ *
+ * Input:           frame - opcode and payload
+ *
+ * Output:          None
+ *
+ * Side Effects:    Always sends one reply frame
+ *
+ * Overview:        Binary equivalent of the command table, runs the
+ *                  same command functions as the ASCII menu
+ *
+ ********************************************************************/
+
+static void BIN_Execute_Command(const protocol_frame_t *frame)
+{
+    const uint8_t *payload = frame->payload;
+    uint8_t reply[PROTOCOL_PAYLOAD_MAX - 1];                                    // Status byte goes first
+    uint8_t reply_length = 0;
+    uint8_t status = STATUS_BAD_LENGTH;
+    uint16_t value;
+    uint32_t value32;
+    uint16_t args[4];
+    sequencer_entry_t entry;
+    bias_calibration_t calibration;
+    int32_t error;
+    bool clk2x;
+#if PROFILE_ENABLE
+    profile_stats_t stats;
+#endif
+
+    baud_previous = 0;                                                          // Good CRC at the new rate
+    switch(frame->opcode)
+    {
+        case OP_PING:
+            if(frame->length == 0)
+            {
+                reply[0] = PROTOCOL_VERSION;
+                reply_length = 1;
+                status = STATUS_OK;
+            }
+            break;
+        case OP_ENABLE:
+            if(frame->length == 1)
+            {
+                BoardSetStatus(payload[0] ? 'E' : 'D');
+                status = STATUS_OK;
+            }
+            break;
+        case OP_TRIGGER:
+            if(frame->length == 1)
+            {
+                status = SetTrigger(payload[0]);
+            }
+            break;
+        case OP_SYNC:
+            if(frame->length == 5)
+            {
+                value32 = payload[1] | ((uint32_t)payload[2] << 8) | ((uint32_t)payload[3] << 16) | ((uint32_t)payload[4] << 24);
+                status = (payload[0] <= TRIGGER_SYNC_SLAVE) ? SetSync("NMS"[payload[0]], value32) : STATUS_INVALID;
+            }
+            else if(frame->length == 0)
+            {
+                status = STATUS_OK;
+            }
+            reply[0] = TRIGGER_GetSync(&value32);
+            BIN_Put32(&reply[1], value32);
+            reply_length = 5;
+            break;
+        case OP_BUS_ADDRESS:
+            if(frame->length == 1)
+            {
+                status = SetAddress(payload[0]);
+            }
+            else if(frame->length == 0)
+            {
+                status = STATUS_OK;
+            }
+            reply[0] = BUS_GetAddress();
+            reply_length = 1;
+            break;
+        case OP_RATE:
+            if(frame->length == 1)
+            {
+                status = SetRate(payload[0]);
+            }
+            else if(frame->length == 4)
+            {
+                value32 = payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+                status = SetFrequency(value32);
+                if(status == STATUS_OK)
+                {
+                    BIN_Put32(&reply[0], TRIGGER_GetFrequency(&value));
+                    reply[4] = value & 0xFF;
+                    reply[5] = value >> 8;
+                    BIN_Put32(&reply[6], TRIGGER_GetErrorPpm(value32));
+                    reply_length = 10;
+                }
+            }
+            break;
+        case OP_WIDTH:
+            if(frame->length == 5)
+            {
+                value32 = payload[1] | ((uint32_t)payload[2] << 8) | ((uint32_t)payload[3] << 16) | ((uint32_t)payload[4] << 24);
+                status = (payload[0] <= TRIGGER_WIDTH_PERCENT) ? SetWidth(payload[0], value32) : STATUS_INVALID;
+                if(status == STATUS_OK)
+                {
+                    value = TRIGGER_GetConfig()->compare;
+                    reply[0] = value & 0xFF;
+                    reply[1] = value >> 8;
+                    BIN_Put32(&reply[2], TRIGGER_GetWidthNs());
+                    reply_length = 6;
+                }
+            }
+            break;
+        case OP_BURST:
+            if(frame->length == 4)
+            {
+                value32 = payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+                status = SetBurst(value32);
+            }
+            break;
+        case OP_COUNT:
+            if(frame->length == 1)
+            {
+                BIN_Put32(reply, TRIGGER_GetCount(payload[0] != 0));
+                reply_length = 4;
+                status = STATUS_OK;
+            }
+            break;
+        case OP_SEQ_CLEAR:
+        case OP_SEQ_STOP:
+            if(frame->length == 0)
+            {
+                status = SetSequence((frame->opcode == OP_SEQ_CLEAR) ? 'K' : 'X', NULL, 0);
+            }
+            break;
+        case OP_SEQ_ADD:
+            if(frame->length == 8)
+            {
+                entry.led = payload[0];
+                entry.mode = (payload[1] == 0) ? SEQUENCER_COUNT : SEQUENCER_DWELL;
+                entry.amount = payload[2] | ((uint32_t)payload[3] << 8) | ((uint32_t)payload[4] << 16) | ((uint32_t)payload[5] << 24);
+                entry.bias = payload[6] | ((uint16_t)payload[7] << 8);
+                status = (payload[1] <= 1) ? SetSequence('A', &entry, 0) : STATUS_INVALID;
+            }
+            break;
+        case OP_SEQ_START:
+            if(frame->length == 4)
+            {
+                value32 = payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+                status = SetSequence('G', NULL, value32);
+            }
+            break;
+        case OP_RAMP_LINEAR:
+            if(frame->length == 9)
+            {
+                for(value = 0; value < 4; value++)
+                {
+                    args[value] = payload[2 * value] | ((uint16_t)payload[2 * value + 1] << 8);
+                }
+                status = SetRamp('L', args, payload[8] & 0x01);
+            }
+            break;
+        case OP_RAMP_TABLE:
+            if(frame->length == 0)
+            {
+                status = SetRamp('K', NULL, false);
+            }
+            else if((frame->length & 1) == 0)
+            {
+                status = STATUS_OK;
+                for(value = 0; (value < frame->length) && (status == STATUS_OK); value += 2)
+                {
+                    args[0] = payload[value] | ((uint16_t)payload[value + 1] << 8);
+                    status = SetRamp('A', args, false);
+                }
+            }
+            reply[0] = RAMP_TableLength();
+            reply_length = 1;
+            break;
+        case OP_RAMP_START:
+            if(frame->length == 3)
+            {
+                args[0] = payload[0] | ((uint16_t)payload[1] << 8);
+                status = SetRamp('T', args, payload[2] & 0x01);
+            }
+            break;
+        case OP_RAMP_STOP:
+            if(frame->length == 0)
+            {
+                status = SetRamp('X', NULL, false);
+            }
+            break;
+        case OP_LOOP_START:
+            if(frame->length == 2)
+            {
+                status = SetRegulator('G', payload[0] | ((uint16_t)payload[1] << 8));
+            }
+            break;
+        case OP_LOOP_STOP:
+            if(frame->length == 0)
+            {
+                status = SetRegulator('X', 0);
+            }
+            break;
+        case OP_LOOP_GAINS:
+            if(frame->length == 6)
+            {
+                REGULATOR_SetGains(payload[0] | ((uint16_t)payload[1] << 8),
+                                   payload[2] | ((uint16_t)payload[3] << 8),
+                                   payload[4] | ((uint16_t)payload[5] << 8));
+            }
+            if((frame->length == 6) || (frame->length == 0))
+            {
+                REGULATOR_GetGains(&args[0], &args[1], &args[2]);
+                for(value = 0; value < 3; value++)
+                {
+                    reply[2 * value] = args[value] & 0xFF;
+                    reply[2 * value + 1] = args[value] >> 8;
+                }
+                reply_length = 6;
+                status = STATUS_OK;
+            }
+            break;
+        case OP_LOOP_STATUS:
+            if(frame->length == 0)
+            {
+                args[0] = BIAS_ADCToMillivolts(REGULATOR_GetSetpoint());
+                args[1] = BIAS_ReadMillivolts();
+                args[2] = BIAS_GetDAC();
+                reply[0] = REGULATOR_Running();
+                reply[1] = REGULATOR_Locked();
+                for(value = 0; value < 3; value++)
+                {
+                    reply[2 * value + 2] = args[value] & 0xFF;
+                    reply[2 * value + 3] = args[value] >> 8;
+                }
+                reply_length = 8;
+                status = STATUS_OK;
+            }
+            break;
+        case OP_LED:
+            if(frame->length == 1)
+            {
+                status = SetLED(payload[0]);
+            }
+            break;
+        case OP_BIAS_SET:
+            if(frame->length == 2)
+            {
+                status = Set_Bias_Requested(payload[0] | ((uint16_t)payload[1] << 8));
+            }
+            break;
+        case OP_ADC_QUERY:
+            if(frame->length == 0)
+            {
+                value = BIAS_ReadADC16();
+                adcVal = value >> 4;
+                reply[0] = adcVal & 0xFF;
+                reply[1] = adcVal >> 8;
+                reply[2] = value & 0xFF;
+                reply[3] = value >> 8;
+                value = BIAS_ADCToMillivolts(value);
+                reply[4] = value & 0xFF;
+                reply[5] = value >> 8;
+                reply_length = 6;
+                status = STATUS_OK;
+            }
+            break;
+        case OP_BIAS_SET_MV:
+            if(frame->length == 2)
+            {
+                status = Set_Bias_Requested(BIAS_DACFromMillivolts(payload[0] | ((uint16_t)payload[1] << 8)));
+                value = BIAS_GetDAC();
+                reply[0] = value & 0xFF;
+                reply[1] = value >> 8;
+                reply_length = 2;
+            }
+            break;
+        case OP_CALIBRATION:
+            if(frame->length == 8)
+            {
+                calibration.dac_gain = payload[0] | ((uint16_t)payload[1] << 8);
+                calibration.dac_offset = payload[2] | ((uint16_t)payload[3] << 8);
+                calibration.adc_gain = payload[4] | ((uint16_t)payload[5] << 8);
+                calibration.adc_offset = payload[6] | ((uint16_t)payload[7] << 8);
+                status = BIAS_SetCalibration(&calibration) ? STATUS_OK : STATUS_INVALID;
+            }
+            else if(frame->length == 0)
+            {
+                status = STATUS_OK;
+            }
+            BIAS_GetCalibration(&calibration);
+            args[0] = calibration.dac_gain;
+            args[1] = calibration.dac_offset;
+            args[2] = calibration.adc_gain;
+            args[3] = calibration.adc_offset;
+            for(value = 0; value < 4; value++)
+            {
+                reply[2 * value] = args[value] & 0xFF;
+                reply[2 * value + 1] = args[value] >> 8;
+            }
+            reply_length = 8;
+            break;
+        case OP_CALIBRATION_SAVE:
+            if(frame->length == 0)
+            {
+                BIAS_SaveCalibration();
+                status = STATUS_OK;
+            }
+            break;
+        case OP_SLEEP_STATS:
+            if(frame->length == 0)
+            {
+                LOWPOWER_GetAsleep(&value32, &value);
+                BIN_Put32(&reply[0], value32);
+                reply[4] = value & 0xFF;
+                reply[5] = value >> 8;
+                BIN_Put32(&reply[6], SYSTICK_Get());
+                BIN_Put32(&reply[10], LOWPOWER_GetWakeups());
+                reply_length = 14;
+                status = STATUS_OK;
+            }
+            else if((frame->length == 1) && (payload[0] == 1))                  // Wake ups, the tick apart
+            {
+                BIN_Put32(&reply[0], LOWPOWER_GetWakeups());
+                BIN_Put32(&reply[4], LOWPOWER_GetTickWakeups());
+                reply_length = 8;
+                status = STATUS_OK;
+            }
+            break;
+        case OP_CLOCK:
+            if(frame->length == 0)
+            {
+                status = STATUS_OK;
+            }
+            else if((frame->length == 1) && (payload[0] <= CLOCK_EXTERNAL))
+            {
+                status = SetClock("IAE"[payload[0]]);
+            }
+            reply[0] = CLOCK_GetSource();
+            reply[1] = CLOCK_Crystal();
+            BIN_Put32(&reply[2], CLOCK_Hz());
+            reply_length = 6;
+            break;
+        case OP_CLOCK_MEASURE:
+            if(frame->length == 0)
+            {
+                status = SetClock('C');
+            }
+            break;
+        case OP_BAUD:
+            value32 = USART0_GetBaud();
+            if(frame->length == 4)
+            {
+                value32 = payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16) | ((uint32_t)payload[3] << 24);
+                status = SetBaud(value32);
+            }
+            else if(frame->length == 0)
+            {
+                status = STATUS_OK;
+            }
+            if(status == STATUS_OK)
+            {
+                USART0_CheckBaud(CLOCK_FAST_HZ, value32, &error, &clk2x);
+                BIN_Put32(&reply[0], value32);
+                BIN_Put32(&reply[4], error);
+                reply[8] = clk2x;
+                reply_length = 9;
+            }
+            break;
+        case OP_CONFIG_SAVE:
+            if(frame->length == 1)
+            {
+                status = SetConfig(payload[0] ? 'A' : 'S');
+            }
+            break;
+        case OP_CONFIG_RESTORE:
+            if(frame->length == 0)
+            {
+                status = SetConfig('R');
+            }
+            break;
+        case OP_ADC_AVERAGE:
+            if(frame->length == 1)
+            {
+                status = BIAS_SetAveraging(payload[0]) ? STATUS_OK : STATUS_INVALID;
+            }
+            break;
+#if PROFILE_ENABLE
+        case OP_PROFILE:
+            if(frame->length == 2)
+            {
+                status = STATUS_INVALID;
+                if(PROFILE_Get(payload[0], &stats, payload[1] != 0))
+                {
+                    reply[0] = stats.count & 0xFF;
+                    reply[1] = stats.count >> 8;
+                    BIN_Put32(&reply[2], stats.min);
+                    BIN_Put32(&reply[6], stats.max);
+                    BIN_Put32(&reply[10], stats.mean);
+                    reply_length = 14;
+                    status = STATUS_OK;
+                }
+            }
+            break;
+#endif
+        case OP_MODE:
+            if(frame->length == 1)
+            {
+                status = (payload[0] == 0) ? STATUS_OK : STATUS_INVALID;
+            }
+            break;
+        default:
+            status = STATUS_UNKNOWN_OP;
+            break;
+    }
+
+    PROTOCOL_Send(frame->opcode, status, reply, reply_length);
+
+    if((frame->opcode == OP_MODE) && (status == STATUS_OK))
+    {
+        cli_mode = CLI_ASCII;                                                   // Reply goes out in binary first
+        cli_command = NULL;
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void Print_Menu(void) 
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Unknown yet
+ *
+ * Overview:        Prints command menu
+ *
+ ********************************************************************/
+
+static void Print_Menu(void)                                                    // Menu for print
+{
+    PRINT_Text(PSTR("\n\r"));
+    PRINT_Text(PSTR("Commands:\n\r"));
+    PRINT_Text(PSTR("E - (Enable) Board Active\n\r"));
+    PRINT_Text(PSTR("D - (Disable) Board Standby\n\r"));
+    PRINT_Text(PSTR("Tx - (Trigger) Enter Trigger Source: I - Internal, E - External\n\r"));
+    PRINT_Text(PSTR("TM - (Trigger) Sync Master out on PA2, TSxxxx - Slave to PA3 after xxxx ns, TN - No Sync\r\n"));
+    PRINT_Text(PSTR("Rx - (Rate) Enter Trigger Rate: S - 1.5kHz, F - 8MHz\r\n"));
+    PRINT_Text(PSTR("Fxxxxxxxx - (Frequency) Enter Trigger Rate in Hz: 1-12000000, end with Enter\r\n"));
+    PRINT_Text(PSTR("Wuxxxx - (Width) Enter Trigger Pulse Width: u = T ticks, N ns, D duty %, end with Enter\r\n"));
+    PRINT_Text(PSTR("Nxxxx - (Number) Send a Burst of 1-4294967295 Triggers, end with Enter\r\n"));
+    PRINT_Text(PSTR("C - (Count) Triggers sent on TRIG1, Z - same and reset to zero\r\n"));
+    PRINT_Text(PSTR("Alcxxxx,bbbb - (Add) Sequence Entry: LED l, c = C pulses or T ms, optional Bias DAC\r\n"));
+    PRINT_Text(PSTR("Gxxxx - (Go) Run Sequence xxxx times, 0 for until stopped, X - Stop, K - Clear\r\n"));
+    PRINT_Text(PSTR("Ms,p,i,m - (Ramp) Bias DAC from s to p in steps of i every m ms, ,E sends RAMP_VALUE, M - Stop\r\n"));
+    PRINT_Text(PSTR("Yxxxx - Add Bias DAC Value to Ramp Table, Y - Clear, Hmmmmm - Run Table every m ms, ,E as M\r\n"));
+    PRINT_Text(PSTR("Lx - (LED) Enter LED number: 1-7 (465nm-235nm), or 0 for all off\r\n"));
+    PRINT_Text(PSTR("Sxxxx - (Set) Enter 10 bit Bias DAC Value: 0000-1023\r\n"));
+    PRINT_Text(PSTR("SMxxxxx - (Set) Enter Bias in mV, end with Enter\r\n"));
+    PRINT_Text(PSTR("Q - (Query) Bias 12bit ADC Value and mV is: \r\n"));
+    PRINT_Text(PSTR("Vx - (aVerage) Bias ADC over 2^x samples: 0-7\r\n"));
+    PRINT_Text(PSTR("Pxxxxx - (PI loop) Hold Bias at xxxxx mV, end with Enter, P - Stop\r\n"));
+    PRINT_Text(PSTR("Jp,i,t - Bias Loop Gains p, i (/65536) and lock Tolerance t, J - Show\r\n"));
+    PRINT_Text(PSTR("UAg,o / UDg,o - (Units) ADC/DAC Calibration: g mV full scale, o mV offset, U - Show, UW - Save\r\n"));
+    PRINT_Text(PSTR("I - (Idle) Time asleep since power up\r\n"));
+    PRINT_Text(PSTR("IC - (Info Clock) Measure clock error, II / IA / IE - Internal, Autotuned or External clock\r\n"));
+#if PROFILE_ENABLE
+    PRINT_Text(PSTR("IP - (Info Profile) Cycle counts per probe, IZ - same and reset\r\n"));
+#endif
+    PRINT_Text(PSTR("Ox - (Operating point) S - Save, A - Save and restore at power up, R - Restore, end with Enter\r\n"));
+    PRINT_Text(PSTR("ONxxx - (Node) RS-485 Bus Address 1-254, 0 is broadcast, end with Enter, ON - Show\r\n"));
+    PRINT_Text(PSTR("OBxxxxxxx - (Baud) Rate up to 1000000, end with Enter, reverts unless a command follows in 2s, OB - Show\r\n"));
+    PRINT_Text(PSTR("B - (Binary) Switch to binary framed protocol\r\n"));
+}
+
+
+
+/*********************************************************************
+ * Function:        static void USART_to_CDC(void))
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Unknown yet
+ *
+ * Overview:        Configures UART?
+ *
+ ********************************************************************/
+
+static void USART_to_CDC(void)                                                  // Configure UART?
+{
+    HAL_PinOutput(&PORTD, PIN4_bm);
+    PORTMUX.USARTROUTEA = PORTMUX_USART0_ALT3_gc;
+}
+
+
+/*********************************************************************
+ * Function:        static uint8_t Set_Bias_Requested(uint16_t value)  
+ *
+ * PreCondition:    None
+ *
+ * Input:           value - DAC code 0 to 1023
+ *
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID
+ *
+ * Side Effects:    Unknown yet
+ *
+ * Overview:        Writes the requested value to Bias DAC
+ *
+ ********************************************************************/
+
+static uint8_t Set_Bias_Requested(uint16_t value)
+{
+    if(current_program == STANDBY)
+    {
+        return STATUS_NOT_ENABLED;
+    }
+    if(SEQUENCER_Running() || RAMP_Running() || REGULATOR_Running())
+    {
+        return STATUS_BUSY;
+    }
+    if(value > 1023)
+    {
+        return STATUS_INVALID;
+    }
+    BIAS_SetDAC(value);
+    return STATUS_OK;
+}
+
+
+
+/*********************************************************************
+ * Function:        static void Send_Bias_Read(void) 
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Unknown yet
+ *
+ * Overview:        Reads ADC and sends value out UART
+ *
+ ********************************************************************/
+
+static void Send_Bias_Read(void)
+{
+    uint16_t fine;
+
+    fine = BIAS_ReadADC16();                                                    // Averaged in the background
+    adcVal = fine >> 4;
+
+    PRINT_Text(PSTR("\n\rBias ADC = "));
+    PRINT_Unsigned(adcVal);
+    PRINT_Text(PSTR(" ("));
+    PRINT_Unsigned(fine);
+    PRINT_Text(PSTR("/65535), "));
+    PRINT_Unsigned(BIAS_ADCToMillivolts(fine));
+    PRINT_Text(PSTR(" mV\r\n"));
+    if(REGULATOR_Running())
+    {
+        PRINT_Text(PSTR("Bias Loop: "));
+        PRINT_Unsigned(BIAS_ADCToMillivolts(REGULATOR_GetSetpoint()));
+        PRINT_Text(PSTR(" mV, DAC = "));
+        PRINT_Unsigned(BIAS_GetDAC());
+        PRINT_Text(REGULATOR_Locked() ? PSTR(", Locked\r\n") : PSTR(", Unlocked\r\n"));
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void BoardSetStatus(uint8_t); 
+ *
+ * PreCondition:    None
+ *
+ * Input:           Status - E or D
+ *
+ * Output:          None
+ *
+ * Side Effects:    Rails switch from the tick, CLI_Notify sets ACTIVE
+ *                  and reports when they are done
+ *
+ * Overview:        Enables or Disables Hardware (for low power mode)
+ *                  Returns at once, the board stays in STANDBY until
+ *                  the power up sequence finishes
+ ********************************************************************/
+
+static void BoardSetStatus(uint8_t Status)
+{
+    PROFILE_START(B);
+    BIAS_SetDAC(BIAS_DAC_MAX);                                                  // Make sure set low to start
+    switch(Status)
+    {
+        case 'E':
+            CLOCK_Set(CLOCK_FAST);                                              // Before anything runs from CLK_PER
+            POWER_Up();                                                         // 5V, 3V3, then BIAS_ENABLE
             break;
-        default:
-            printf("\n\rInvalid Command!\n\r");
-            Print_Menu();
+        case 'D':
+            restore_pending = false;
+            SEQUENCER_Stop();
+            RAMP_Stop();
+            REGULATOR_Stop();
+            LED_Set(0);                                                         // All LEDs and DAQ Sync off
+            HAL_PinClear(&PORTD, PIN3_bm);                                      // CLK_SEL = PD3, set low for external clock
+            TRIGGER_Stop();                                                     // TRIG1 = PC3, turn tca off
+            BIAS_EnableADC(false);
+            POWER_Down();                                                       // BIAS_ENABLE, 3V3, then 5V
+            current_program = STANDBY;
             break;
-    }
+    } 
+    PROFILE_STOP(B, PROFILE_BOARD);
 }
 
 
 /*********************************************************************
- * Function:        static void Print_Menu(void) 
+ * Function:        static uint8_t SetTrigger(uint8_t Trigger); 
  *
  * PreCondition:    None
  *
- * Input:           None
+ * Input:           Trigger - I or E
  *
- * Output:          None
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED or STATUS_INVALID
  *
  * Side Effects:    Unknown yet
  *
- * Overview:        Prints command menu
- *
+ * Overview:        Reads and sets Trigger
  ********************************************************************/
 
-static void Print_Menu(void)                                                    // Menu for print
+static uint8_t SetTrigger(uint8_t Trigger)
 {
-    printf("\n\r");
-    printf("Commands:\n\r");
-    printf("E - (Enable) Board Active\n\r");
-    printf("D - (Disable) Board Standby\n\r");
-    printf("Tx - (Trigger) Enter Trigger Source: I - Internal, E - External\n\r");
-    printf("Rx - (Rate) Enter Trigger Rate: S - 1.5kHz, F - 8MHz\r\n");
-    printf("Lx - (LED) Enter LED number: 1-7 (465nm-235nm), or 0 for all off\r\n");
-    printf("Sxxxx - (Set) Enter 10 bit Bias DAC Value: 0000-1023\r\n");
-    printf("Q - (Query) Bias 12bit ADC Value is: \r\n");
+    if(current_program == STANDBY)
+    {
+        return STATUS_NOT_ENABLED;
+    }
+    switch(Trigger)
+    {
+        case 'I':
+            HAL_PinSet(&PORTD, PIN3_bm);                                        // CLK_SEL = PD3, set high for internal clock
+            break;
+        case 'E':
+            HAL_PinClear(&PORTD, PIN3_bm);                                      // CLK_SEL = PD3, set low for external clock
+            break;
+        default:
+            return STATUS_INVALID;
+    } 
+    return STATUS_OK;
 }
 
 
 
 /*********************************************************************
- * Function:        static void USART_to_CDC(void))
+ * Function:        static uint8_t SetSync(uint8_t role, uint32_t delay)
  *
  * PreCondition:    None
  *
- * Input:           None
+ * Input:           role - M master, S slave, N no sync
+ *                  delay - slave pulse delay in ns
  *
- * Output:          None
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID (delay leaves no gap at this rate
+ *                  and width)
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    A running trigger restarts
  *
- * Overview:        Configures UART?
+ * Overview:        Sets this board's part on the sync line
  *
  ********************************************************************/
 
-static void USART_to_CDC(void)                                                  // Configure UART?
+static uint8_t SetSync(uint8_t role, uint32_t delay)
 {
-    PORTD.DIRSET = PIN4_bm;
-    PORTMUX.USARTROUTEA = PORTMUX_USART0_ALT3_gc;
+    trigger_sync_t sync;
+
+    if(current_program == STANDBY)
+    {
+        return STATUS_NOT_ENABLED;
+    }
+    if(SEQUENCER_Running())
+    {
+        return STATUS_BUSY;
+    }
+    switch(role)
+    {
+        case 'M':
+            sync = TRIGGER_SYNC_MASTER;
+            break;
+        case 'S':
+            sync = TRIGGER_SYNC_SLAVE;
+            break;
+        case 'N':
+            sync = TRIGGER_SYNC_OFF;
+            break;
+        default:
+            return STATUS_INVALID;
+    }
+    return TRIGGER_SetSync(sync, delay) ? STATUS_OK : STATUS_INVALID;
 }
 
 
 /*********************************************************************
- * Function:        static uint8_t Unblocking_Read(void) 
+ * Function:        static uint8_t SetRate(uint8_t Rate); 
  *
- * PreCondition:    Port Configured
+ * PreCondition:    None
  *
- * Input:           None
+ * Input:           Rate - S or F
  *
- * Output:          8 bits data received
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID
  *
  * Side Effects:    Unknown yet
  *
- * Overview:        Looks for data received, if so, returns it
- *
+ * Overview:        Sets internal trigger source rate
+ *                  
  ********************************************************************/
 
 
-static uint8_t Unblocking_Read(void)                                            // Read UART
+static uint8_t SetRate(uint8_t Rate)                                            // Sets internal trigger source rate
 {
-    if(USART0_IsRxReady() != 0)
+    if(current_program == STANDBY)
     {
-        return USART0_Read();
+        return STATUS_NOT_ENABLED;
     }
-    else
+    if(SEQUENCER_Running())
+    {
+        return STATUS_BUSY;
+    }
+    if((Rate != 'S') && (Rate != 'F'))
     {
-        return '\0';
+        return STATUS_INVALID;
     }
+    TRIGGER_SetPreset(Rate);
+    return STATUS_OK;
 }
 
 
 /*********************************************************************
- * Function:        static uint8_t Read_Parameter(void)  
- *
- * PreCondition:    Expect data
+ * Function:        static uint8_t SetFrequency(uint32_t hz); 
  *
- * Input:           None
+ * PreCondition:    None
  *
- * Output:          Value received
+ * Input:           hz - TRIGGER_MIN_HZ to TRIGGER_MAX_HZ
  *
- * Side Effects:    Unknown yet
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID
  *
- * Overview:        Looks for data, if it's received, return
- *                  Times out after 5 sec
+ * Side Effects:    TCA0 restarted
  *
+ * Overview:        Sets internal trigger rate, closest achievable
+ *                  
  ********************************************************************/
 
-static uint8_t Read_Parameter(void)                                              // Looks for data
+static uint8_t SetFrequency(uint32_t hz)
 {
-    uint8_t Param = 0;
-    uint8_t Count = 50;
-    
-    while(Count != 0)
+    if(current_program == STANDBY)
     {
-            Count -= 1;
-            Param = Unblocking_Read();
-            if((Param != '\n') && (Param != '\r') && (Param != '\0'))
-            {   
-                Count = 0;                                                  // exit if good data
-            }
-            else
-            {            
-                _delay_ms(RX_DELAY);                                        // wait and try again if needed
-            }
-     }
-
-    return Param;
+        return STATUS_NOT_ENABLED;
+    }
+    if(SEQUENCER_Running())
+    {
+        return STATUS_BUSY;
+    }
+    if(!TRIGGER_SetFrequency(hz))
+    {
+        return STATUS_INVALID;
+    }
+    return STATUS_OK;
 }
 
 
 /*********************************************************************
- * Function:        static void Set_Bias_Requested(void)  
+ * Function:        static uint8_t SetWidth(trigger_width_t unit, uint32_t value); 
  *
- * PreCondition:    Expect data
- *
- * Input:           None
+ * PreCondition:    None
  *
- * Output:          Value received
+ * Input:           unit - ticks, ns or percent
+ *                  value - width in that unit
  *
- * Side Effects:    Unknown yet
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID
  *
- * Overview:        Receives DAC value requested and writes to Bias DAC
- *                  Creates error message if doesn't work
+ * Side Effects:    Kept for later rate changes
  *
+ * Overview:        Sets internal trigger pulse width, the rate is not
+ *                  changed.  Must be at least one tick and leave at
+ *                  least one tick low at the current prescaler
+ *                  
  ********************************************************************/
 
-static void Set_Bias_Requested(void)
+static uint8_t SetWidth(trigger_width_t unit, uint32_t value)
 {
-        
-    int sum, digit, j, i;
-    char Rx[4];
-    
-    for(j=0; j<4; j++)							// Receive number in ASCII
-	{
-	Rx[j] = Read_Parameter();
-	}
- 
-    if(current_program == ACTIVE)
-    {    
-        sum = 0;                                    // a2i function
-        for (i = 0; i < 4; i++) 
-        {
-            digit = Rx[i] - 0x30;
-            sum = (sum * 10) + digit;
-        }
-
-        DAC0_setVal(sum);
-
-        printf("\r\nBias DAC Set\r\n");
+    if(current_program == STANDBY)
+    {
+        return STATUS_NOT_ENABLED;
+    }
+    if(SEQUENCER_Running())
+    {
+        return STATUS_BUSY;
     }
-    else if(current_program == STANDBY)
+    if(!TRIGGER_SetWidth(unit, value))
     {
-        printf("\r\nPlease Enable Board first: 'E' \n\r");
+        return STATUS_INVALID;
     }
+    return STATUS_OK;
 }
 
 
-
 /*********************************************************************
- * Function:        static void Send_Bias_Read(void) 
+ * Function:        static uint8_t SetBurst(uint32_t pulses); 
  *
  * PreCondition:    None
  *
- * Input:           None
- *
- * Output:          None
+ * Input:           pulses - 1 to 4294967295
  *
- * Side Effects:    Unknown yet
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID
  *
- * Overview:        Reads ADC and sends value out UART
+ * Side Effects:    Replaces the free running trigger
  *
+ * Overview:        Outputs exactly pulses triggers at the current rate
+ *                  and width, CLI_Notify reports when done
+ *                  
  ********************************************************************/
 
-static void Send_Bias_Read(void)
+static uint8_t SetBurst(uint32_t pulses)
 {
-    
-    int a = 0;
-    char s[20];
-
-    adcVal = ADC0_read();
-    
-    a = adcVal;
-    
-    // Could actually do math and convert to a voltage....?
-    
-    printf("\n\r");
-    sprintf(s, "Bias ADC = %d", a);                                            // Convert to ASCII
-    printf(s);                                                                  // Print to port
-    printf("\r\n");
-          
+    if(current_program == STANDBY)
+    {
+        return STATUS_NOT_ENABLED;
+    }
+    if(SEQUENCER_Running())
+    {
+        return STATUS_BUSY;
+    }
+    if(!TRIGGER_StartBurst(pulses))
+    {
+        return STATUS_INVALID;
+    }
+    return STATUS_OK;
 }
 
 
 /*********************************************************************
- * Function:        static void BoardSetStatus(uint8_t); 
+ * Function:        static uint8_t SetSequence(uint8_t action,
+ *                          const sequencer_entry_t *entry, uint32_t loops); 
  *
  * PreCondition:    None
  *
- * Input:           None
+ * Input:           action - A add entry, G start, X stop, K clear
+ *                  entry - for A
+ *                  loops - for G, 0 = until stopped
  *
- * Output:          None
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    G takes over trigger, LED and bias
  *
- * Overview:        Enables or Disables Hardware (for low power mode)
- *                  - Function works, but haven't tested delays
+ * Overview:        Wavelength sequencer control
+ *                  
  ********************************************************************/
 
-static void BoardSetStatus(uint8_t Status)
+static uint8_t SetSequence(uint8_t action, const sequencer_entry_t *entry, uint32_t loops)
 {
-    DAC0_setVal(1023);                                                          // Make sure set low to start
-    switch(Status)
+    switch(action)
     {
-        case 'E':
-            PORTC.OUTSET = PIN2_bm;                                             // 5V_SW_ENABLE = PC2, set high
-             _delay_ms(PWR_DELAY);
-            PORTD.OUTSET = PIN7_bm;                                             // 3V3_SW_ENABLE = PD7, set high
-            _delay_ms(PWR_DELAY);
-            PORTD.OUTSET = PIN2_bm;                                             // BIAS_ENABLE = PD2, set high
-            current_program = ACTIVE;
-            printf("\r\nBoard Active\r\n");
-            break;
-        case 'D':
-            PORTF.OUTCLR = PIN0_bm;                                           // LED 450nm
-            PORTF.OUTCLR = PIN1_bm;                                           // LED 410nm
-            PORTF.OUTCLR = PIN2_bm;                                             // LED 365nm
-            PORTF.OUTCLR = PIN3_bm;                                             // LED 295nm
-            PORTF.OUTCLR = PIN4_bm;                                             // LED 278nm
-            PORTF.OUTCLR = PIN5_bm;                                             // LED 255nm
-            PORTC.OUTCLR = PIN0_bm;                                             // LED 235nm
-            PORTC.OUTCLR = PIN1_bm;                                             // DAQ Sync
-            PORTD.OUTCLR = PIN3_bm;                                             // CLK_SEL = PD3, set low for external clock
-            TCA0.SPLIT.CTRLB = 0x0;                                             // TRIG1 = PC3, turn tca off
-             
-            PORTD.OUTCLR = PIN2_bm;                                             // BIAS_ENABLE = PD2, set low
-            _delay_ms(PWR_DELAY);
-            PORTD.OUTCLR = PIN7_bm;                                             // 3V3_SW_ENABLE = PD7, set low
-            _delay_ms(PWR_DELAY);
-            PORTC.OUTCLR = PIN2_bm;                                             // 5V_SW_ENABLE = PC2, set low
-            current_program = STANDBY;
-            printf("\r\nBoard Standby\r\n");
+        case 'X':
+            SEQUENCER_Stop();
+            return STATUS_OK;
+        case 'K':
+            SEQUENCER_Clear();
+            return STATUS_OK;
+        case 'A':
+            if(SEQUENCER_Running())
+            {
+                return STATUS_BUSY;
+            }
+            return SEQUENCER_Add(entry) ? STATUS_OK : STATUS_INVALID;
+        default:
             break;
-    } 
+    }
+    if(current_program == STANDBY)
+    {
+        return STATUS_NOT_ENABLED;
+    }
+    if(RAMP_Running() || REGULATOR_Running())
+    {
+        return STATUS_BUSY;
+    }
+    return SEQUENCER_Start(loops) ? STATUS_OK : STATUS_INVALID;
 }
 
 
 /*********************************************************************
- * Function:        static void SetTrigger(void); 
+ * Function:        static uint8_t SetRamp(uint8_t action,
+ *                                         const uint16_t *param, bool emit)
  *
  * PreCondition:    None
  *
- * Input:           None
+ * Input:           action - L linear, T table, A add point, K clear
+ *                           table, X stop
+ *                  param - L: start, stop, step, ms. T: ms. A: value
+ *                  emit - report every value applied
  *
- * Output:          None
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    L and T take over the bias DAC until done or stopped
+ *
+ * Overview:        Bias ramp control
  *
- * Overview:        Reads and sets Trigger
- *                  Creates error message if doesn't work
  ********************************************************************/
 
-static void SetTrigger(void)
+static uint8_t SetRamp(uint8_t action, const uint16_t *param, bool emit)
 {
-    
-    static uint8_t Trigger = 0;
-
-    Trigger = Read_Parameter();
-    
-    if(current_program == ACTIVE)
+    switch(action)
     {
-        switch(Trigger)
-        {
-            case 'I':
-                PORTD.OUTSET = PIN3_bm;                                             // CLK_SEL = PD3, set high for internal clock
-                printf("\r\nTrigger Source: Set Internal\r\n");
-                break;
-            case 'E':
-                PORTD.OUTCLR = PIN3_bm;                                             // CLK_SEL = PD3, set low for external clock
-                printf("\r\nTrigger Source: Set External\r\n");
-                break;
-            default:
-                printf("\n\rInvalid Command!\n\r");
-                Print_Menu();
-                break;
-        } 
+        case 'X':
+            RAMP_Stop();
+            return STATUS_OK;
+        case 'K':
+            RAMP_TableClear();
+            return STATUS_OK;
+        case 'A':
+            if(RAMP_Running())
+            {
+                return STATUS_BUSY;
+            }
+            return RAMP_TableAdd(param[0]) ? STATUS_OK : STATUS_INVALID;
+        default:
+            break;
+    }
+    if(current_program == STANDBY)
+    {
+        return STATUS_NOT_ENABLED;
     }
-    else if(current_program == STANDBY)
+    if(SEQUENCER_Running() || REGULATOR_Running())
     {
-        printf("\r\nPlease Enable Board first: 'E' \n\r");
+        return STATUS_BUSY;
     }
+    if(action == 'L')
+    {
+        return RAMP_StartLinear(param[0], param[1], param[2], param[3], emit) ? STATUS_OK : STATUS_INVALID;
+    }
+    return RAMP_StartTable(param[0], emit) ? STATUS_OK : STATUS_INVALID;
 }
 
 
-
 /*********************************************************************
- * Function:        static void SetRate(void)); 
+ * Function:        static uint8_t SetRegulator(uint8_t action,
+ *                                              uint16_t setpoint)
  *
  * PreCondition:    None
  *
- * Input:           None
+ * Input:           action - G start or new setpoint, X stop
+ *                  setpoint - mV, through the ADC calibration
  *
- * Output:          None
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    G takes over the bias DAC until stopped
+ *
+ * Overview:        Closed loop bias control
  *
- * Overview:        Sets internal trigger source rate
- *                  
  ********************************************************************/
 
-
-static void SetRate(void)                                                      // Sets internal trigger source rate
+static uint8_t SetRegulator(uint8_t action, uint16_t setpoint)
 {
-    static uint8_t Rate = 0;
-
-    Rate = Read_Parameter();
-    
-    if(current_program == ACTIVE)
+    if(action == 'X')
     {
-        switch(Rate)
-        {
-            case 'S':
-                TCA0_init('S');
-                printf("\r\nTrigger Rate: Set 1.5kHz\r\n");
-                break;
-            case 'F':
-                TCA0_init('F');
-                printf("\r\nTrigger Rate: Set 8MHz\r\n");
-                break;
-            default:
-                printf("\n\rInvalid Command!\n\r");
-                Print_Menu();
-                break;
-        }
+        REGULATOR_Stop();
+        return STATUS_OK;
     }
-    else if(current_program == STANDBY)
+    if(current_program == STANDBY)
     {
-        printf("\r\nPlease Enable Board first: 'E' \n\r");
-    } 
+        return STATUS_NOT_ENABLED;
+    }
+    if(SEQUENCER_Running() || RAMP_Running())
+    {
+        return STATUS_BUSY;
+    }
+    if(setpoint == 0)
+    {
+        return STATUS_INVALID;
+    }
+    return REGULATOR_Start(BIAS_ADCFromMillivolts(setpoint)) ? STATUS_OK : STATUS_INVALID;
 }
 
 
 /*********************************************************************
- * Function:        static void SetLED(void); 
+ * Function:        static uint8_t SetLED(uint8_t LED); 
  *
  * PreCondition:    None
  *
- * Input:           None
+ * Input:           LED - 0 to 7
  *
- * Output:          None
+ * Output:          STATUS_OK, STATUS_NOT_ENABLED, STATUS_BUSY or
+ *                  STATUS_INVALID
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    Any value 0 to 9 turns the LEDs off, even in standby
  *
  * Overview:        Set LED (xor), if any set, then set sync out
- *                  If none set, turn off sync out
+ *                  If none set, turn off sync out.  A running trigger
+ *                  skips a pulse for the change
  *                  
  ********************************************************************/
 
 
-static void SetLED(void)                                                       // Set LED (xor), if any set, then set sync out
+static uint8_t SetLED(uint8_t LED)                                              // Set LED (xor), if any set, then set sync out
 {
-
-    static uint8_t LED = 0;
-
-    LED = Read_Parameter();
-    
-    if(('9' >= LED) && (LED >= '0'))                                            // If valid command, start by disabling everything
+    if(SEQUENCER_Running())
     {
-        PORTF.OUTCLR = PIN0_bm;                                                 // LED 450nm
-        PORTF.OUTCLR = PIN1_bm;                                                 // LED 410nm
-        PORTF.OUTCLR = PIN2_bm;                                                 // LED 365nm
-        PORTF.OUTCLR = PIN3_bm;                                                 // LED 295nm
-        PORTF.OUTCLR = PIN4_bm;                                                 // LED 278nm
-        PORTF.OUTCLR = PIN5_bm;                                                 // LED 255nm
-        PORTC.OUTCLR = PIN0_bm;                                                 // LED 235nm
-        PORTC.OUTCLR = PIN1_bm;                                                 // DAQ Sync
+        return STATUS_BUSY;
     }
-    
-    if(current_program == ACTIVE)
+    if(current_program == STANDBY)
     {
-        switch(LED)
-        {
-            case '0':                                                               
-                printf("\r\nLEDs off\r\n");                                         // Leave all off
-                break;
-            case '1':
-                PORTF.OUTSET = PIN0_bm;                                           // LED 450nm
-                PORTC.OUTSET = PIN1_bm;                                             // DAQ Sync        
-                printf("\r\n450nm LED on\r\n");
-                break;
-            case '2':
-                PORTF.OUTSET = PIN1_bm;                                           // LED 410nm
-                PORTC.OUTSET = PIN1_bm;                                             // DAQ Sync         
-                printf("\r\n410nm LED on\r\n");
-                break;    
-            case '3':
-                PORTF.OUTSET = PIN2_bm;                                             // LED 365nm
-                PORTC.OUTSET = PIN1_bm;                                             // DAQ Sync      
-                printf("\r\n365nm LED on\r\n");
-                break;
-            case '4':
-                PORTF.OUTSET = PIN3_bm;                                             // LED 295nm
-                PORTC.OUTSET = PIN1_bm;                                             // DAQ Sync       
-                printf("\r\n295nm LED on\r\n");
-                break;
-            case '5':
-                PORTF.OUTSET = PIN4_bm;                                             // LED 278nm
-                PORTC.OUTSET = PIN1_bm;                                             // DAQ Sync    
-                printf("\r\n278nm LED on\r\n");
-                break;
-            case '6':
-                PORTF.OUTSET = PIN5_bm;                                             // LED 255nm
-                PORTC.OUTSET = PIN1_bm;                                             // DAQ Sync
-                printf("\r\n255nm LED on\r\n");
-                break;
-            case '7':
-                PORTC.OUTSET = PIN0_bm;                                             // LED 235nm
-                PORTC.OUTSET = PIN1_bm;                                             // DAQ Sync
-                printf("\r\n235nm LED on\r\n");
-                break;      
-            default:
-                printf("\n\rInvalid Command!\n\r");                                 // If invalid, do nothing
-                Print_Menu();
-                break;
+        if(LED <= 9)
+        {
+            LED_Set(0);                                                         // Trigger stopped in standby
         }
+        return STATUS_NOT_ENABLED;
     }
-    else if(current_program == STANDBY)
+    if(LED > LED_COUNT)
     {
-        printf("\r\nPlease Enable Board first: 'E' \n\r");
-    } 
-    
+        if(LED <= 9)                                                            // Valid command, all off
+        {
+            LED_Select(0);
+        }
+        return STATUS_INVALID;                                                  // If invalid, do nothing
+    }
+    LED_Select(LED);                                                            // Old LED off and new on in one blank
+    return STATUS_OK;
 }
 
 
 /*********************************************************************
- * Function:        static void VREF_init(void); 
+ * Function:        static uint8_t SetConfig(uint8_t action)
  *
  * PreCondition:    None
  *
- * Input:           None
+ * Input:           action - S save, A save with restore at power up,
+ *                           R restore
  *
- * Output:          None
+ * Output:          STATUS_OK, STATUS_BUSY or STATUS_INVALID (nothing
+ *                  saved, or saved trigger not valid)
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    S and A write EEPROM.  R powers the board up or
+ *                  down, trigger, LED and bias follow once it is active
+ *
+ * Overview:        Saves or restores the operating point
  *
- * Overview:        Configures VREF for DAC0 and ADC0 to VDD (3.3V)
- *                  
  ********************************************************************/
 
-static void VREF_init(void)
+static uint8_t SetConfig(uint8_t action)
 {
-    VREF.DAC0REF = VREF_REFSEL_VDD_gc /* Select 3.3V VDD Voltage Reference for DAC */
-                 | VREF_ALWAYSON_bm;    /* Set the Voltage Reference in Always On mode */   
-    VREF.ADC0REF = VREF_REFSEL_VDD_gc /* Select 3.3V VDD Voltage Reference for ADC */
-                 | VREF_ALWAYSON_bm;    /* Set the Voltage Reference in Always On mode */
-    /* Wait VREF start-up time */
-    _delay_us(VREF_STARTUP_TIME);
-}
+    config_t config;
 
+    if(SEQUENCER_Running() || RAMP_Running() || REGULATOR_Running())
+    {
+        return STATUS_BUSY;                                                     // Not a steady operating point
+    }
+    switch(action)
+    {
+        case 'S':
+        case 'A':
+            config.auto_restore = (action == 'A');
+            config.active = (current_program == ACTIVE);
+            config.trigger_source = HAL_PinIsSet(&PORTD, PIN3_bm) ? 'I' : 'E';  // CLK_SEL = PD3
+            TRIGGER_GetState(&config.trigger);
+            config.led = LED_Get();
+            config.bias = BIAS_GetDAC();
+            CONFIG_Save(&config);
+            return STATUS_OK;
+        case 'R':
+            break;
+        default:
+            return STATUS_INVALID;
+    }
 
-/*********************************************************************
- * Function:        static void DAC0_init(void); 
- *
- * PreCondition:    None
- *
- * Input:           None
- *
- * Output:          None
- *
- * Side Effects:    Unknown yet
- *
- * Overview:        Enables DAC0 (the only DAC) PD6
- *                  
- ********************************************************************/
-
-static void DAC0_init(void)
-{
-    /* Disable digital input buffer */
-    PORTD.PIN6CTRL &= ~PORT_ISC_gm;
-    PORTD.PIN6CTRL |= PORT_ISC_INPUT_DISABLE_gc;
-    /* Disable pull-up resistor */
-    PORTD.PIN6CTRL &= ~PORT_PULLUPEN_bm;   
-    DAC0.CTRLA = DAC_ENABLE_bm          /* Enable DAC */
-               | DAC_OUTEN_bm           /* Enable output buffer */
-               | DAC_RUNSTDBY_bm;       /* Enable Run in Standby mode */
+    if(!CONFIG_Load(&restore_config))
+    {
+        return STATUS_INVALID;
+    }
+    if(!restore_config.active)
+    {
+        BoardSetStatus('D');
+        return STATUS_OK;
+    }
+    if(current_program == ACTIVE)
+    {
+        return ApplyConfig();
+    }
+    BoardSetStatus('E');
+    restore_pending = true;                                                     // CLI_Notify applies it
+    return STATUS_OK;
 }
 
 
 /*********************************************************************
- * Function:        static void DAC0_setVal(uint16_t val); 
+ * Function:        static uint8_t SetClock(uint8_t action)
  *
  * PreCondition:    None
  *
- * Input:           DAC value to be set
+ * Input:           action - I internal, A autotuned to the crystal,
+ *                           E external, C measure
  *
- * Output:          None
+ * Output:          STATUS_OK or STATUS_INVALID (source not built in
+ *                  or not running, back on internal)
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    C reports through CLI_Notify after a second
+ *
+ * Overview:        Main clock source and error measurement
  *
- * Overview:        Sets DAC Value
- *                  
  ********************************************************************/
 
-
-static void DAC0_setVal(uint16_t value)
+static uint8_t SetClock(uint8_t action)
 {
-    /* Store the two LSbs in DAC0.DATAL */
-    DAC0.DATAL = (value & LSB_MASK) << 6;
-    /* Store the eight MSbs in DAC0.DATAH */
-    DAC0.DATAH = value >> 2;
+    bool ok;
+
+    switch(action)
+    {
+        case 'I':
+            ok = CLOCK_SetSource(CLOCK_INTERNAL);
+            break;
+        case 'A':
+            ok = CLOCK_SetSource(CLOCK_AUTOTUNE);
+            break;
+        case 'E':
+            ok = CLOCK_SetSource(CLOCK_EXTERNAL);
+            break;
+        case 'C':
+            CLOCK_Measure();
+            ok = true;
+            break;
+        default:
+            ok = false;
+            break;
+    }
+    return ok ? STATUS_OK : STATUS_INVALID;
 }
 
 
 /*********************************************************************
- * Function:        static void ADC0_init(void); 
+ * Function:        static uint8_t SetAddress(uint32_t address)
  *
  * PreCondition:    None
  *
- * Input:           None
+ * Input:           address - BUS_ADDRESS_MIN to BUS_ADDRESS_MAX
  *
- * Output:          None
+ * Output:          STATUS_OK or STATUS_INVALID
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    Stored in EEPROM, used from the next address frame
+ *
+ * Overview:        Board address on the RS-485 bus
  *
- * Overview:        Enables ADC
- *                  
  ********************************************************************/
 
-
-static void ADC0_init(void)
+static uint8_t SetAddress(uint32_t address)
 {
-    
-    ADC0.CTRLC = ADC_PRESC_DIV2_gc;     // CLK_PER divided by 2
-    ADC0.CTRLA = ADC_ENABLE_bm          // Enable ADC
-               | ADC_RESSEL_12BIT_gc;   // Use 12-bit resolution
-    
-    ADC0.MUXPOS = ADC_MUXNEG_AIN1_gc;   // Select ADC channel as PD1: AIN1
+    if(address > 0xFF)
+    {
+        return STATUS_INVALID;
+    }
+    return BUS_SetAddress((uint8_t)address) ? STATUS_OK : STATUS_INVALID;
 }
 
 
 /*********************************************************************
- * Function:        static uint16_t ADC0_read(void); 
+ * Function:        static uint8_t SetBaud(uint32_t baud)
  *
  * PreCondition:    None
  *
- * Input:           None
+ * Input:           baud - up to BAUD_MAX, within USART0_BAUD_ERROR_MAX
+ *                         at 24MHz
  *
- * Output:          None
+ * Output:          STATUS_OK or STATUS_INVALID
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    CLI_Baud switches once the reply has gone out
+ *
+ * Overview:        Baud rate negotiation, the reply goes at the old
+ *                  rate and the host then has BAUD_TIMEOUT to send a
+ *                  valid command at the new one
  *
- * Overview:        Reads ADC
- *                  
  ********************************************************************/
 
-
-static uint16_t ADC0_read(void)
+static uint8_t SetBaud(uint32_t baud)
 {
-    /* Start conversion */
-    ADC0.COMMAND = ADC_STCONV_bm;
-    /* Wait until ADC conversion is done */
-    while(!(ADC0.INTFLAGS & ADC_RESRDY_bm))
+    int32_t error;
+    bool clk2x;
+
+    if((baud > BAUD_MAX) || !USART0_CheckBaud(CLOCK_FAST_HZ, baud, &error, &clk2x))
     {
-        ;
+        return STATUS_INVALID;
     }
-    /* The interrupt flag is cleared when the conversion result is accessed */
-    return ADC0.RES;
+    baud_pending = baud;
+    return STATUS_OK;
 }
 
 
 /*********************************************************************
- * Function:        static void TCA0_init(char speed)
+ * Function:        static uint8_t ApplyConfig(void)
  *
- * PreCondition:    None
+ * PreCondition:    Board active, restore_config loaded
  *
- * Input:           speed - (S or F)
+ * Input:           None
  *
- * Output:          None
+ * Output:          STATUS_OK or STATUS_INVALID (saved trigger not valid)
  *
- * Side Effects:    Unknown yet
+ * Side Effects:    None
+ *
+ * Overview:        Second half of a restore
  *
- * Overview:        Initializes TCA0
- *                  
  ********************************************************************/
 
-
-static void TCA0_init(char speed)
+static uint8_t ApplyConfig(void)
 {
-     
-    /* set waveform output on PORT C */
-    PORTMUX.TCAROUTEA = PORTMUX_TCA0_PORTC_gc;
-
-    TCA0.SPLIT.CTRLD = TCA_SPLIT_SPLITM_bm;                 
-
-    TCA0.SPLIT.CTRLB = TCA_SPLIT_HCMP0EN_bm;     /* enable compare channel 0 for the higher byte */
-
-    if (speed == 'S')
-    {
-        /* set PWM frequency 1.5kHz and duty cycle (50%) */
-        TCA0.SPLIT.HPER = 250;       
-        TCA0.SPLIT.HCMP0 = 125;
-
-        TCA0.SPLIT.CTRLA = TCA_SPLIT_CLKSEL_DIV64_gc    /* set clock source (sys_clk/4) */
-                        | TCA_SPLIT_ENABLE_bm;         /* start timer */
-    }
-    else if (speed == 'F')
-    {
-        /* set PWM frequency 8MHz and duty cycle (50%) */
-        TCA0.SPLIT.HPER = 2;       
-        TCA0.SPLIT.HCMP0 = 1;   
-
-        TCA0.SPLIT.CTRLA = TCA_SPLIT_CLKSEL_DIV1_gc    /* set clock source (sys_clk/1) */
-                        | TCA_SPLIT_ENABLE_bm;         /* start timer */  
-    }
+    restore_pending = false;
+    SetTrigger(restore_config.trigger_source);
+    SetLED(restore_config.led);
+    Set_Bias_Requested(restore_config.bias);
+    return TRIGGER_SetState(&restore_config.trigger) ? STATUS_OK : STATUS_INVALID;
 }
 
+
 /**
     End of File
 */
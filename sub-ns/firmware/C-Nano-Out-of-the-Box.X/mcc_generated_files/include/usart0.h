@@ -44,8 +44,23 @@
 extern "C" {
 #endif
 
-/* Normal Mode, Baud register value */
-#define USART0_BAUD_RATE(BAUD_RATE) (((float)24000000 * 64 / (16 * (float)BAUD_RATE)) + 0.5)
+/* Baud rate after USART0_Initialize() */
+#define USART0_BAUD_DEFAULT 115200UL
+
+/* Smallest BAUD register value the USART accepts, the largest rate error
+ * allowed in ppm, leaving the host side half the 8N1 tolerance, and the
+ * normal mode error above which double speed mode is tried */
+#define USART0_BAUD_REG_MIN 64
+#define USART0_BAUD_ERROR_MAX 10000L
+#define USART0_BAUD_ERROR_CLK2X 1000L
+
+/* Ring buffer sizes, must be a power of 2. TX holds a full menu reply */
+#ifndef USART0_RX_BUFFER_SIZE
+#define USART0_RX_BUFFER_SIZE 128
+#endif
+#ifndef USART0_TX_BUFFER_SIZE
+#define USART0_TX_BUFFER_SIZE 512
+#endif
 
 /**
  * \brief Initialize USART interface
@@ -97,13 +112,18 @@ void USART0_Disable();
 /**
  * \brief Get recieved data from USART0
  *
- * \return Data register from USART0 module
+ * Takes the oldest byte from the RX ring buffer. Only call when
+ * USART0_IsRxReady() returned true.
+ *
+ * \return Oldest received byte
  */
 uint8_t USART0_GetData();
 
 /**
  * \brief Check if the usart can accept data to be transmitted
  *
+ * True while the TX ring buffer has room, so USART0_Write() will not wait.
+ *
  * \return The status of USART TX data ready check
  * \retval false The USART can not receive data to be transmitted
  * \retval true The USART can receive data to be transmitted
@@ -113,6 +133,8 @@ bool USART0_IsTxReady();
 /**
  * \brief Check if the USART has received data
  *
+ * True while the RX ring buffer holds unread bytes.
+ *
  * \return The status of USART RX data ready check
  * \retval true The USART has received data
  * \retval false The USART has not received data
@@ -128,12 +150,53 @@ bool USART0_IsRxReady();
  */
 bool USART0_IsTxBusy();
 
+/**
+ * \brief Check if the TX ring buffer is empty and the last frame has been sent
+ *
+ * \return Transmitter idle status
+ */
 bool USART0_IsTxDone();
 
+/**
+ * \brief Number of received bytes waiting in the RX ring buffer
+ *
+ * \return Byte count
+ */
+uint16_t USART0_RxCount(void);
+
+/**
+ * \brief Free space in the TX ring buffer
+ *
+ * \return Byte count that can be written without waiting
+ */
+uint16_t USART0_TxSpace(void);
+
+/**
+ * \brief Number of received bytes dropped because the RX ring buffer was full
+ *
+ * \return Overflow count since initialization
+ */
+uint16_t USART0_GetRxOverflowCount(void);
+
+/**
+ * \brief Number of bytes USART0_Write() dropped, called from an ISR with the
+ * TX ring buffer full
+ *
+ * \return Drop count since initialization
+ */
+uint16_t USART0_GetTxDropCount(void);
+
+/**
+ * \brief Wait until all queued data has been shifted out
+ *
+ * \return Nothing
+ */
+void USART0_Flush(void);
+
 /**
  * \brief Read one character from USART0
  *
- * Function will block if a character is not available.
+ * Function will block if the RX ring buffer is empty.
  *
  * \return Data read from the USART0 module
  */
@@ -142,7 +205,9 @@ uint8_t USART0_Read(void);
 /**
  * \brief Write one character to USART0
  *
- * Function will block until a character can be accepted.
+ * Queues the character in the TX ring buffer, the DRE interrupt sends it.
+ * Function only blocks while the TX ring buffer is full, from an ISR the
+ * character is dropped instead, see USART0_GetTxDropCount().
  *
  * \param[in] data The character to write to the USART
  *
@@ -150,6 +215,92 @@ uint8_t USART0_Read(void);
  */
 void USART0_Write(const uint8_t data);
 
+/**
+ * \brief Write one character to USART0 if there is room
+ *
+ * \param[in] data The character to write to the USART
+ *
+ * \return Queued status
+ * \retval true The character was queued
+ * \retval false The TX ring buffer was full, nothing was queued
+ */
+bool USART0_TryWrite(const uint8_t data);
+
+/**
+ * \brief Set the baud rate for a peripheral clock
+ *
+ * Call with the new clock whenever CLK_PER changes so the baud rate
+ * stays the same. Only call while USART0_IsTxDone(). Uses double speed
+ * mode (RXMODE CLK2X) where it gives the smaller error.
+ *
+ * \param[in] clock CLK_PER in Hz
+ * \param[in] baud Baud rate
+ *
+ * \return Set status
+ * \retval true The rate is set
+ * \retval false Out of range or more than USART0_BAUD_ERROR_MAX off, nothing changed
+ */
+bool USART0_SetBaud(uint32_t clock, uint32_t baud);
+
+/**
+ * \brief Check a baud rate without setting it
+ *
+ * \param[in] clock CLK_PER in Hz
+ * \param[in] baud Baud rate
+ * \param[out] error Rate error in ppm, actual rate above requested is positive
+ * \param[out] clk2x true if double speed mode would be used
+ *
+ * \return true if USART0_SetBaud() would accept it
+ */
+bool USART0_CheckBaud(uint32_t clock, uint32_t baud, int32_t *error, bool *clk2x);
+
+/**
+ * \brief Error of the baud rate last set
+ *
+ * \return Rate error in ppm
+ */
+int32_t USART0_GetBaudError(void);
+
+/**
+ * \brief Double speed mode in use
+ *
+ * \return true for RXMODE CLK2X
+ */
+bool USART0_IsClk2x(void);
+
+/**
+ * \brief Baud rate last set
+ *
+ * \return Baud rate
+ */
+uint32_t USART0_GetBaud(void);
+
+/**
+ * \brief Multi-processor communication mode
+ *
+ * With a handler the USART uses 9 bit frames and MPCM.  Frames with the
+ * 9th bit set are addresses and go to the handler, from interrupt
+ * context, never to the RX ring buffer.  The handler clears MPCM to
+ * receive the data frames that follow, or sets it to ignore them.
+ *
+ * \param[in] handler Address handler, NULL for normal 8 bit mode
+ *
+ * \return Nothing
+ */
+void USART0_SetAddressMode(void (*handler)(uint8_t));
+
+/**
+ * \brief Drop data written for transmission
+ *
+ * For a shared bus, when this node may not talk. Data already queued
+ * still goes out.
+ *
+ * \param[in] mute true to drop writes
+ *
+ * \return Nothing
+ */
+void USART0_SetTxMute(bool mute);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,6 +32,31 @@
 
 
 #include "../include/usart0.h"
+#include "../../profile.h"
+#include <stdlib.h>
+
+#define USART0_RX_BUFFER_MASK (USART0_RX_BUFFER_SIZE - 1)
+#define USART0_TX_BUFFER_MASK (USART0_TX_BUFFER_SIZE - 1)
+
+#if (USART0_RX_BUFFER_SIZE & USART0_RX_BUFFER_MASK) || (USART0_TX_BUFFER_SIZE & USART0_TX_BUFFER_MASK)
+#error USART0 ring buffer sizes must be a power of 2
+#endif
+
+/* Ring buffers: head is written by the producer, tail by the consumer */
+static volatile uint8_t  usart0_rxbuf[USART0_RX_BUFFER_SIZE];
+static volatile uint16_t usart0_rx_head;
+static volatile uint16_t usart0_rx_tail;
+static volatile uint16_t usart0_rx_overflow;
+
+static volatile uint8_t  usart0_txbuf[USART0_TX_BUFFER_SIZE];
+static volatile uint16_t usart0_tx_head;
+static volatile uint16_t usart0_tx_tail;
+static volatile uint16_t usart0_tx_dropped;
+static volatile bool     usart0_tx_started;                     // TXCIF is only valid once a byte went out
+static uint32_t          usart0_baud = USART0_BAUD_DEFAULT;
+static int32_t           usart0_baud_error;                     // ppm
+static void (*volatile   usart0_address_handler)(uint8_t);      // Set in 9 bit address mode
+static volatile bool     usart0_tx_mute;                        // Writes dropped
 
 #if defined(__GNUC__)
 
@@ -41,7 +66,9 @@ int USART0_printCHAR(char character, FILE *stream)
     return 0;
 }
 
+#if !defined(HAL_HOST)
 FILE USART0_stream = FDEV_SETUP_STREAM(USART0_printCHAR, NULL, _FDEV_SETUP_WRITE);
+#endif
 
 #elif defined(__ICCAVR__)
 
@@ -54,14 +81,23 @@ int putchar(int outChar)
 
 void USART0_Initialize()
 {
-    //set baud rate register
-    USART0.BAUD = (uint16_t)USART0_BAUD_RATE(115200);
-	
-    //RXCIE disabled; TXCIE disabled; DREIE disabled; RXSIE disabled; LBME disabled; ABEIE disabled; RS485 OFF; 
-    USART0.CTRLA = 0x00;
+    usart0_rx_head = 0;
+    usart0_rx_tail = 0;
+    usart0_rx_overflow = 0;
+    usart0_tx_head = 0;
+    usart0_tx_tail = 0;
+    usart0_tx_started = false;
+    usart0_address_handler = NULL;
+    usart0_tx_mute = false;
+
+    //RXCIE enabled; TXCIE disabled; DREIE disabled (set while TX data is queued); RXSIE disabled; LBME disabled; ABEIE disabled; RS485 OFF; 
+    USART0.CTRLA = USART_RXCIE_bm;
 	
     //RXEN enabled; TXEN enabled; SFDEN disabled; ODME disabled; RXMODE NORMAL; MPCM disabled; 
     USART0.CTRLB = 0xC0;
+
+    //set baud rate register, RXMODE CLK2X where that is closer
+    USART0_SetBaud(F_CPU, USART0_BAUD_DEFAULT);
 	
     //CMODE ASYNCHRONOUS; PMODE DISABLED; SBMODE 1BIT; CHSIZE 8BIT; UDORD disabled; UCPHA disabled; 
     USART0.CTRLC = 0x03;
@@ -79,12 +115,113 @@ void USART0_Initialize()
     USART0.TXPLCTRL = 0x00;
 	
 
-#if defined(__GNUC__)
+#if defined(HAL_HOST)
+    stdout = SIM_Stream(USART0_printCHAR);                      // host/sim.c
+#elif defined(__GNUC__)
     stdout = &USART0_stream;
 #endif
 
 }
 
+/* BAUD = 64 * clock / (S * baud), rounded, S = 16 normal or 8 double speed.
+ * The error is that of the rate actually generated, in ppm */
+static bool USART0_BaudCompute(uint32_t clock, uint32_t baud, bool clk2x, uint16_t *reg, int32_t *error)
+{
+    uint32_t scaled = clock * (clk2x ? 8 : 4);
+    uint32_t value;
+
+    if ((baud == 0) || (baud > scaled / USART0_BAUD_REG_MIN))
+    {
+        return false;
+    }
+    value = (scaled + baud / 2) / baud;
+    if (value > 0xFFFF)
+    {
+        return false;
+    }
+    *reg = (uint16_t)value;
+    *error = ((int64_t)scaled - (int64_t)value * baud) * 1000000 / ((int64_t)value * baud);
+    return ((*error <= USART0_BAUD_ERROR_MAX) && (*error >= -USART0_BAUD_ERROR_MAX));
+}
+
+/* Normal mode samples each bit 16 times and is the more noise tolerant,
+ * double speed only where normal mode cannot reach the rate or is more
+ * than USART0_BAUD_ERROR_CLK2X off and double speed is closer */
+static bool USART0_BaudSelect(uint32_t clock, uint32_t baud, bool *clk2x, uint16_t *reg, int32_t *error)
+{
+    uint16_t reg2x;
+    int32_t error2x;
+    bool normal = USART0_BaudCompute(clock, baud, false, reg, error);
+    bool fast = USART0_BaudCompute(clock, baud, true, &reg2x, &error2x);
+
+    *clk2x = fast && (!normal || ((labs(*error) > USART0_BAUD_ERROR_CLK2X) && (labs(error2x) < labs(*error))));
+    if (*clk2x)
+    {
+        *reg = reg2x;
+        *error = error2x;
+    }
+    return (normal || fast);
+}
+
+bool USART0_SetBaud(uint32_t clock, uint32_t baud)
+{
+    uint16_t reg;
+    int32_t error;
+    bool clk2x;
+
+    if (!USART0_BaudSelect(clock, baud, &clk2x, &reg, &error))
+    {
+        return false;
+    }
+    USART0.CTRLB = (USART0.CTRLB & ~USART_RXMODE_gm) | (clk2x ? USART_RXMODE_CLK2X_gc : USART_RXMODE_NORMAL_gc);
+    USART0.BAUD = reg;
+    usart0_baud = baud;
+    usart0_baud_error = error;
+    return true;
+}
+
+bool USART0_CheckBaud(uint32_t clock, uint32_t baud, int32_t *error, bool *clk2x)
+{
+    uint16_t reg;
+
+    return USART0_BaudSelect(clock, baud, clk2x, &reg, error);
+}
+
+int32_t USART0_GetBaudError(void)
+{
+    return usart0_baud_error;
+}
+
+bool USART0_IsClk2x(void)
+{
+    return ((USART0.CTRLB & USART_RXMODE_gm) == USART_RXMODE_CLK2X_gc);
+}
+
+uint32_t USART0_GetBaud(void)
+{
+    return usart0_baud;
+}
+
+void USART0_SetAddressMode(void (*handler)(uint8_t))
+{
+    usart0_address_handler = handler;
+    USART0.CTRLC = (USART0.CTRLC & ~USART_CHSIZE_gm)
+                 | ((handler != NULL) ? USART_CHSIZE_9BITL_gc : USART_CHSIZE_8BIT_gc);
+    if (handler != NULL)
+    {
+        USART0.CTRLB |= USART_MPCM_bm;                          // Address frames only until one is accepted
+    }
+    else
+    {
+        USART0.CTRLB &= ~USART_MPCM_bm;
+    }
+}
+
+void USART0_SetTxMute(bool mute)
+{
+    usart0_tx_mute = mute;
+}
+
 void USART0_Enable()
 {
     USART0.CTRLB |= USART_RXEN_bm | USART_TXEN_bm;
@@ -107,39 +244,186 @@ void USART0_Disable()
 
 uint8_t USART0_GetData()
 {
-    return USART0.RXDATAL;
+    uint8_t data;
+    uint16_t tail = usart0_rx_tail;
+
+    data = usart0_rxbuf[tail];
+    ENTER_CRITICAL(R);
+    usart0_rx_tail = (tail + 1) & USART0_RX_BUFFER_MASK;
+    EXIT_CRITICAL(R);
+    return data;
 }
 
 bool USART0_IsTxReady()
 {
-    return (USART0.STATUS & USART_DREIF_bm);
+    return (USART0_TxSpace() != 0);
 }
 
 bool USART0_IsRxReady()
 {
-    return (USART0.STATUS & USART_RXCIF_bm);
+    return (USART0_RxCount() != 0);
 }
 
 bool USART0_IsTxBusy()
 {
-    return (!(USART0.STATUS & USART_TXCIF_bm));
+    return (!USART0_IsTxDone());
 }
 
 bool USART0_IsTxDone()
 {
-    return (USART0.STATUS & USART_TXCIF_bm);
+    bool empty;
+
+    ENTER_CRITICAL(T);
+    empty = (usart0_tx_head == usart0_tx_tail) && !(USART0.CTRLA & USART_DREIE_bm);
+    EXIT_CRITICAL(T);
+    /* Queue drained, and the last byte has left the shift register */
+    return (empty && (!usart0_tx_started || (USART0.STATUS & USART_TXCIF_bm)));
+}
+
+uint16_t USART0_RxCount(void)
+{
+    uint16_t count;
+
+    ENTER_CRITICAL(R);
+    count = (usart0_rx_head - usart0_rx_tail) & USART0_RX_BUFFER_MASK;
+    EXIT_CRITICAL(R);
+    return count;
+}
+
+uint16_t USART0_TxSpace(void)
+{
+    uint16_t space;
+
+    ENTER_CRITICAL(T);
+    space = (usart0_tx_tail - usart0_tx_head - 1) & USART0_TX_BUFFER_MASK;
+    EXIT_CRITICAL(T);
+    return space;
+}
+
+uint16_t USART0_GetRxOverflowCount(void)
+{
+    uint16_t count;
+
+    ENTER_CRITICAL(R);
+    count = usart0_rx_overflow;
+    EXIT_CRITICAL(R);
+    return count;
+}
+
+uint16_t USART0_GetTxDropCount(void)
+{
+    uint16_t count;
+
+    ENTER_CRITICAL(D);
+    count = usart0_tx_dropped;
+    EXIT_CRITICAL(D);
+    return count;
+}
+
+void USART0_Flush(void)
+{
+    while (!USART0_IsTxDone())
+            ;
 }
 
 uint8_t USART0_Read()
 {
-    while (!(USART0.STATUS & USART_RXCIF_bm))
+    while (!USART0_IsRxReady())
             ;
-    return USART0.RXDATAL;
+    return USART0_GetData();
 }
 
 void USART0_Write(const uint8_t data)
 {
-    while (!(USART0.STATUS & USART_DREIF_bm))
-            ;
-    USART0.TXDATAL = data;
+    uint16_t head = usart0_tx_head;
+    uint16_t next = (head + 1) & USART0_TX_BUFFER_MASK;
+
+    if (usart0_tx_mute)
+    {
+        return;
+    }
+
+    /* Queue full: wait for the DRE interrupt to make room.  SREG.I stays set
+     * inside an ISR on this core, CPUINT.STATUS tells, and DRE (level 0) can't
+     * run there, so an ISR caller drops the byte rather than hold up others.
+     * With interrupts globally off (early init) the data register is fed here */
+    while (USART0_TxSpace() == 0)
+    {
+        if (CPUINT.STATUS & (CPUINT_LVL0EX_bm | CPUINT_LVL1EX_bm))
+        {
+            usart0_tx_dropped++;
+            return;
+        }
+        if (!(SREG & CPU_I_bm) && (USART0.STATUS & USART_DREIF_bm))
+        {
+            USART0.STATUS = USART_TXCIF_bm;
+            usart0_tx_started = true;
+            USART0.TXDATAH = 0;                                 // 9 bit mode: data, not address
+            USART0.TXDATAL = usart0_txbuf[usart0_tx_tail];
+            usart0_tx_tail = (usart0_tx_tail + 1) & USART0_TX_BUFFER_MASK;
+        }
+    }
+
+    usart0_txbuf[head] = data;
+    ENTER_CRITICAL(W);
+    usart0_tx_head = next;
+    USART0.CTRLA |= USART_DREIE_bm;
+    EXIT_CRITICAL(W);
+}
+
+bool USART0_TryWrite(const uint8_t data)
+{
+    if (USART0_TxSpace() == 0)
+    {
+        return false;
+    }
+    USART0_Write(data);
+    return true;
+}
+
+ISR(USART0_RXC_vect)
+{
+    uint8_t data;
+    uint16_t next;
+
+    if (usart0_address_handler != NULL)
+    {
+        if (USART0.RXDATAH & USART_DATA8_bm)                    // RXDATAH first in 9 bit mode
+        {
+            usart0_address_handler(USART0.RXDATAL);
+            return;
+        }
+    }
+    data = USART0.RXDATAL;
+    next = (usart0_rx_head + 1) & USART0_RX_BUFFER_MASK;
+    if (next == usart0_rx_tail)
+    {
+        usart0_rx_overflow++;                                   // Full, drop newest byte
+    }
+    else
+    {
+        usart0_rxbuf[usart0_rx_head] = data;
+        usart0_rx_head = next;
+    }
+}
+
+ISR(USART0_DRE_vect)
+{
+    PROFILE_START(T);
+    uint16_t tail = usart0_tx_tail;
+
+    if (tail != usart0_tx_head)
+    {
+        USART0.STATUS = USART_TXCIF_bm;                         // Clear TX complete, a new frame follows
+        usart0_tx_started = true;
+        USART0.TXDATAH = 0;                                     // 9 bit mode: data, not address
+        USART0.TXDATAL = usart0_txbuf[tail];
+        tail = (tail + 1) & USART0_TX_BUFFER_MASK;
+        usart0_tx_tail = tail;
+    }
+    if (tail == usart0_tx_head)
+    {
+        USART0.CTRLA &= ~USART_DREIE_bm;                        // Queue drained
+    }
+    PROFILE_STOP(T, PROFILE_UART_TX);
 }
\ No newline at end of file
@@ -45,7 +45,19 @@
 
 /* clang-format off */
 
-#if defined(__GNUC__) || defined (__DOXYGEN__)
+#if defined(HAL_HOST)
+
+/* Host build: SREG is a variable the peripheral model checks before it
+ * runs an ISR (host/sim.c).  Declares a variable like the IAR version,
+ * the asm is only a compiler barrier */
+#define ENTER_CRITICAL(P)  uint8_t P##_sreg = SREG; SREG = P##_sreg & ~CPU_I_bm; \
+                           __asm__ __volatile__ ("" ::: "memory")
+#define EXIT_CRITICAL(P)   __asm__ __volatile__ ("" ::: "memory"); SREG = P##_sreg
+
+#define DISABLE_INTERRUPTS()        cli()
+#define ENABLE_INTERRUPTS()         sei()
+
+#elif defined(__GNUC__) || defined (__DOXYGEN__)
 
 /**
  * \brief Enter a critical region
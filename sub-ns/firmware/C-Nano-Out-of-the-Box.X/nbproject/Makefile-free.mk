@@ -51,17 +51,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=mcc_generated_files/src/cpuint.c mcc_generated_files/src/protected_io.S mcc_generated_files/src/usart0.c mcc_generated_files/src/pin_manager.c mcc_generated_files/device_config.c mcc_generated_files/mcc.c main.c
+SOURCEFILES_QUOTED_IF_SPACED=mcc_generated_files/src/cpuint.c mcc_generated_files/src/protected_io.S mcc_generated_files/src/usart0.c mcc_generated_files/src/pin_manager.c mcc_generated_files/device_config.c mcc_generated_files/mcc.c systick.c protocol.c trigger.c led.c bias.c sequencer.c ramp.c regulator.c config.c power.c lowpower.c clock.c bus.c profile.c print.c main.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/mcc_generated_files/src/cpuint.o ${OBJECTDIR}/mcc_generated_files/src/protected_io.o ${OBJECTDIR}/mcc_generated_files/src/usart0.o ${OBJECTDIR}/mcc_generated_files/src/pin_manager.o ${OBJECTDIR}/mcc_generated_files/device_config.o ${OBJECTDIR}/mcc_generated_files/mcc.o ${OBJECTDIR}/main.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/mcc_generated_files/src/cpuint.o.d ${OBJECTDIR}/mcc_generated_files/src/protected_io.o.d ${OBJECTDIR}/mcc_generated_files/src/usart0.o.d ${OBJECTDIR}/mcc_generated_files/src/pin_manager.o.d ${OBJECTDIR}/mcc_generated_files/device_config.o.d ${OBJECTDIR}/mcc_generated_files/mcc.o.d ${OBJECTDIR}/main.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/mcc_generated_files/src/cpuint.o ${OBJECTDIR}/mcc_generated_files/src/protected_io.o ${OBJECTDIR}/mcc_generated_files/src/usart0.o ${OBJECTDIR}/mcc_generated_files/src/pin_manager.o ${OBJECTDIR}/mcc_generated_files/device_config.o ${OBJECTDIR}/mcc_generated_files/mcc.o ${OBJECTDIR}/systick.o ${OBJECTDIR}/protocol.o ${OBJECTDIR}/trigger.o ${OBJECTDIR}/led.o ${OBJECTDIR}/bias.o ${OBJECTDIR}/sequencer.o ${OBJECTDIR}/ramp.o ${OBJECTDIR}/regulator.o ${OBJECTDIR}/config.o ${OBJECTDIR}/power.o ${OBJECTDIR}/lowpower.o ${OBJECTDIR}/clock.o ${OBJECTDIR}/bus.o ${OBJECTDIR}/profile.o ${OBJECTDIR}/print.o ${OBJECTDIR}/main.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/mcc_generated_files/src/cpuint.o.d ${OBJECTDIR}/mcc_generated_files/src/protected_io.o.d ${OBJECTDIR}/mcc_generated_files/src/usart0.o.d ${OBJECTDIR}/mcc_generated_files/src/pin_manager.o.d ${OBJECTDIR}/mcc_generated_files/device_config.o.d ${OBJECTDIR}/mcc_generated_files/mcc.o.d ${OBJECTDIR}/systick.o.d ${OBJECTDIR}/protocol.o.d ${OBJECTDIR}/trigger.o.d ${OBJECTDIR}/led.o.d ${OBJECTDIR}/bias.o.d ${OBJECTDIR}/sequencer.o.d ${OBJECTDIR}/ramp.o.d ${OBJECTDIR}/regulator.o.d ${OBJECTDIR}/config.o.d ${OBJECTDIR}/power.o.d ${OBJECTDIR}/lowpower.o.d ${OBJECTDIR}/clock.o.d ${OBJECTDIR}/bus.o.d ${OBJECTDIR}/profile.o.d ${OBJECTDIR}/print.o.d ${OBJECTDIR}/main.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/mcc_generated_files/src/cpuint.o ${OBJECTDIR}/mcc_generated_files/src/protected_io.o ${OBJECTDIR}/mcc_generated_files/src/usart0.o ${OBJECTDIR}/mcc_generated_files/src/pin_manager.o ${OBJECTDIR}/mcc_generated_files/device_config.o ${OBJECTDIR}/mcc_generated_files/mcc.o ${OBJECTDIR}/main.o
+OBJECTFILES=${OBJECTDIR}/mcc_generated_files/src/cpuint.o ${OBJECTDIR}/mcc_generated_files/src/protected_io.o ${OBJECTDIR}/mcc_generated_files/src/usart0.o ${OBJECTDIR}/mcc_generated_files/src/pin_manager.o ${OBJECTDIR}/mcc_generated_files/device_config.o ${OBJECTDIR}/mcc_generated_files/mcc.o ${OBJECTDIR}/systick.o ${OBJECTDIR}/protocol.o ${OBJECTDIR}/trigger.o ${OBJECTDIR}/led.o ${OBJECTDIR}/bias.o ${OBJECTDIR}/sequencer.o ${OBJECTDIR}/ramp.o ${OBJECTDIR}/regulator.o ${OBJECTDIR}/config.o ${OBJECTDIR}/power.o ${OBJECTDIR}/lowpower.o ${OBJECTDIR}/clock.o ${OBJECTDIR}/bus.o ${OBJECTDIR}/profile.o ${OBJECTDIR}/print.o ${OBJECTDIR}/main.o
 
 # Source Files
-SOURCEFILES=mcc_generated_files/src/cpuint.c mcc_generated_files/src/protected_io.S mcc_generated_files/src/usart0.c mcc_generated_files/src/pin_manager.c mcc_generated_files/device_config.c mcc_generated_files/mcc.c main.c
+SOURCEFILES=mcc_generated_files/src/cpuint.c mcc_generated_files/src/protected_io.S mcc_generated_files/src/usart0.c mcc_generated_files/src/pin_manager.c mcc_generated_files/device_config.c mcc_generated_files/mcc.c systick.c protocol.c trigger.c led.c bias.c sequencer.c ramp.c regulator.c config.c power.c lowpower.c clock.c bus.c profile.c print.c main.c
 
 
 
@@ -118,6 +118,96 @@ ${OBJECTDIR}/mcc_generated_files/mcc.o: mcc_generated_files/mcc.c  .generated_fi
 	@${RM} ${OBJECTDIR}/mcc_generated_files/mcc.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/mcc_generated_files/mcc.o.d" -MT "${OBJECTDIR}/mcc_generated_files/mcc.o.d" -MT ${OBJECTDIR}/mcc_generated_files/mcc.o -o ${OBJECTDIR}/mcc_generated_files/mcc.o mcc_generated_files/mcc.c 
 	
+${OBJECTDIR}/systick.o: systick.c  .generated_files/flags/free/33830a270ad9a8279f30fabc885e83322795013e .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/systick.o.d 
+	@${RM} ${OBJECTDIR}/systick.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/systick.o.d" -MT "${OBJECTDIR}/systick.o.d" -MT ${OBJECTDIR}/systick.o -o ${OBJECTDIR}/systick.o systick.c 
+	
+${OBJECTDIR}/protocol.o: protocol.c  .generated_files/flags/free/3e54130fb4812d3e365f579a1038d4d9630c73bb .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/protocol.o.d 
+	@${RM} ${OBJECTDIR}/protocol.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/protocol.o.d" -MT "${OBJECTDIR}/protocol.o.d" -MT ${OBJECTDIR}/protocol.o -o ${OBJECTDIR}/protocol.o protocol.c 
+	
+${OBJECTDIR}/trigger.o: trigger.c  .generated_files/flags/free/d49cddedbc69761a8f2c3e077822a55aceb6a147 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/trigger.o.d 
+	@${RM} ${OBJECTDIR}/trigger.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/trigger.o.d" -MT "${OBJECTDIR}/trigger.o.d" -MT ${OBJECTDIR}/trigger.o -o ${OBJECTDIR}/trigger.o trigger.c 
+	
+${OBJECTDIR}/led.o: led.c  .generated_files/flags/free/e1224d7cf7b4226bd7501650d4e774b17c7d7c6c .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/led.o.d 
+	@${RM} ${OBJECTDIR}/led.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/led.o.d" -MT "${OBJECTDIR}/led.o.d" -MT ${OBJECTDIR}/led.o -o ${OBJECTDIR}/led.o led.c 
+	
+${OBJECTDIR}/bias.o: bias.c  .generated_files/flags/free/460d1209e368ee540cceafb9abcb18585592acdf .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/bias.o.d 
+	@${RM} ${OBJECTDIR}/bias.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/bias.o.d" -MT "${OBJECTDIR}/bias.o.d" -MT ${OBJECTDIR}/bias.o -o ${OBJECTDIR}/bias.o bias.c 
+	
+${OBJECTDIR}/sequencer.o: sequencer.c  .generated_files/flags/free/4773e23118c5251d1d874f70b4e13a36f6e406a2 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sequencer.o.d 
+	@${RM} ${OBJECTDIR}/sequencer.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/sequencer.o.d" -MT "${OBJECTDIR}/sequencer.o.d" -MT ${OBJECTDIR}/sequencer.o -o ${OBJECTDIR}/sequencer.o sequencer.c 
+	
+${OBJECTDIR}/ramp.o: ramp.c  .generated_files/flags/free/46e2d98639a49d29983cc3572d22aa1666007bf7 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/ramp.o.d 
+	@${RM} ${OBJECTDIR}/ramp.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/ramp.o.d" -MT "${OBJECTDIR}/ramp.o.d" -MT ${OBJECTDIR}/ramp.o -o ${OBJECTDIR}/ramp.o ramp.c 
+	
+${OBJECTDIR}/regulator.o: regulator.c  .generated_files/flags/free/3ade2a8d920ab00213f5a99441d7c779060c4420 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/regulator.o.d 
+	@${RM} ${OBJECTDIR}/regulator.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/regulator.o.d" -MT "${OBJECTDIR}/regulator.o.d" -MT ${OBJECTDIR}/regulator.o -o ${OBJECTDIR}/regulator.o regulator.c 
+	
+${OBJECTDIR}/config.o: config.c  .generated_files/flags/free/1438525c5343d76ce7c43634ba01387e3c218c37 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/config.o.d 
+	@${RM} ${OBJECTDIR}/config.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/config.o.d" -MT "${OBJECTDIR}/config.o.d" -MT ${OBJECTDIR}/config.o -o ${OBJECTDIR}/config.o config.c 
+	
+${OBJECTDIR}/power.o: power.c  .generated_files/flags/free/b0bf3b8a218bd4b124ad389113cd80ff3c7b53ac .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/power.o.d 
+	@${RM} ${OBJECTDIR}/power.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/power.o.d" -MT "${OBJECTDIR}/power.o.d" -MT ${OBJECTDIR}/power.o -o ${OBJECTDIR}/power.o power.c 
+	
+${OBJECTDIR}/lowpower.o: lowpower.c  .generated_files/flags/free/0774bcd772c95a6f0887aec0648c9146ebd95516 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/lowpower.o.d 
+	@${RM} ${OBJECTDIR}/lowpower.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/lowpower.o.d" -MT "${OBJECTDIR}/lowpower.o.d" -MT ${OBJECTDIR}/lowpower.o -o ${OBJECTDIR}/lowpower.o lowpower.c 
+	
+${OBJECTDIR}/clock.o: clock.c  .generated_files/flags/free/15f5f6eb54fd190c44599bba3189a833e201b51c .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/clock.o.d 
+	@${RM} ${OBJECTDIR}/clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/clock.o.d" -MT "${OBJECTDIR}/clock.o.d" -MT ${OBJECTDIR}/clock.o -o ${OBJECTDIR}/clock.o clock.c 
+	
+${OBJECTDIR}/bus.o: bus.c  .generated_files/flags/free/0ce809551cc533c9cb5a5b62a7c2ba20cebff596 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/bus.o.d 
+	@${RM} ${OBJECTDIR}/bus.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/bus.o.d" -MT "${OBJECTDIR}/bus.o.d" -MT ${OBJECTDIR}/bus.o -o ${OBJECTDIR}/bus.o bus.c 
+	
+${OBJECTDIR}/profile.o: profile.c  .generated_files/flags/free/6814d1ecf17749282b9f8b55969c375512e6aa30 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/profile.o.d 
+	@${RM} ${OBJECTDIR}/profile.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/profile.o.d" -MT "${OBJECTDIR}/profile.o.d" -MT ${OBJECTDIR}/profile.o -o ${OBJECTDIR}/profile.o profile.c 
+	
+${OBJECTDIR}/print.o: print.c  .generated_files/flags/free/6814d1ecf17749282b9f8b55969c375512e6aa30 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/print.o.d 
+	@${RM} ${OBJECTDIR}/print.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -D__DEBUG=1 -g -DDEBUG  -gdwarf-2  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/print.o.d" -MT "${OBJECTDIR}/print.o.d" -MT ${OBJECTDIR}/print.o -o ${OBJECTDIR}/print.o print.c 
+	
 ${OBJECTDIR}/main.o: main.c  .generated_files/flags/free/59c2c454ee063205d1445f8e8590e4e49578e2c5 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}" 
 	@${RM} ${OBJECTDIR}/main.o.d 
@@ -155,6 +245,96 @@ ${OBJECTDIR}/mcc_generated_files/mcc.o: mcc_generated_files/mcc.c  .generated_fi
 	@${RM} ${OBJECTDIR}/mcc_generated_files/mcc.o 
 	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/mcc_generated_files/mcc.o.d" -MT "${OBJECTDIR}/mcc_generated_files/mcc.o.d" -MT ${OBJECTDIR}/mcc_generated_files/mcc.o -o ${OBJECTDIR}/mcc_generated_files/mcc.o mcc_generated_files/mcc.c 
 	
+${OBJECTDIR}/systick.o: systick.c  .generated_files/flags/free/2a2331e2809aaa868679661a2871da5cb26755f3 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/systick.o.d 
+	@${RM} ${OBJECTDIR}/systick.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/systick.o.d" -MT "${OBJECTDIR}/systick.o.d" -MT ${OBJECTDIR}/systick.o -o ${OBJECTDIR}/systick.o systick.c 
+	
+${OBJECTDIR}/protocol.o: protocol.c  .generated_files/flags/free/c79e79b9780045bc0a5e5fe08037f11cff68e202 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/protocol.o.d 
+	@${RM} ${OBJECTDIR}/protocol.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/protocol.o.d" -MT "${OBJECTDIR}/protocol.o.d" -MT ${OBJECTDIR}/protocol.o -o ${OBJECTDIR}/protocol.o protocol.c 
+	
+${OBJECTDIR}/trigger.o: trigger.c  .generated_files/flags/free/4f7d67faa45e567a0b86c3c1d9c391d594093c55 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/trigger.o.d 
+	@${RM} ${OBJECTDIR}/trigger.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/trigger.o.d" -MT "${OBJECTDIR}/trigger.o.d" -MT ${OBJECTDIR}/trigger.o -o ${OBJECTDIR}/trigger.o trigger.c 
+	
+${OBJECTDIR}/led.o: led.c  .generated_files/flags/free/981ae07273ff510102d3dc7a003e546974f71b72 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/led.o.d 
+	@${RM} ${OBJECTDIR}/led.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/led.o.d" -MT "${OBJECTDIR}/led.o.d" -MT ${OBJECTDIR}/led.o -o ${OBJECTDIR}/led.o led.c 
+	
+${OBJECTDIR}/bias.o: bias.c  .generated_files/flags/free/c0db6d051825e5a80f77f1990dae352dc686d106 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/bias.o.d 
+	@${RM} ${OBJECTDIR}/bias.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/bias.o.d" -MT "${OBJECTDIR}/bias.o.d" -MT ${OBJECTDIR}/bias.o -o ${OBJECTDIR}/bias.o bias.c 
+	
+${OBJECTDIR}/sequencer.o: sequencer.c  .generated_files/flags/free/798f10b8537f5f97ee443157f915315809777457 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sequencer.o.d 
+	@${RM} ${OBJECTDIR}/sequencer.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/sequencer.o.d" -MT "${OBJECTDIR}/sequencer.o.d" -MT ${OBJECTDIR}/sequencer.o -o ${OBJECTDIR}/sequencer.o sequencer.c 
+	
+${OBJECTDIR}/ramp.o: ramp.c  .generated_files/flags/free/09e478010ddc33927e030084ad1781269c4907b8 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/ramp.o.d 
+	@${RM} ${OBJECTDIR}/ramp.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/ramp.o.d" -MT "${OBJECTDIR}/ramp.o.d" -MT ${OBJECTDIR}/ramp.o -o ${OBJECTDIR}/ramp.o ramp.c 
+	
+${OBJECTDIR}/regulator.o: regulator.c  .generated_files/flags/free/f2df828d971273ef37e7e83012d01a83854942de .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/regulator.o.d 
+	@${RM} ${OBJECTDIR}/regulator.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/regulator.o.d" -MT "${OBJECTDIR}/regulator.o.d" -MT ${OBJECTDIR}/regulator.o -o ${OBJECTDIR}/regulator.o regulator.c 
+	
+${OBJECTDIR}/config.o: config.c  .generated_files/flags/free/14511568a7d30be1e89895cd11be2143648fd385 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/config.o.d 
+	@${RM} ${OBJECTDIR}/config.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/config.o.d" -MT "${OBJECTDIR}/config.o.d" -MT ${OBJECTDIR}/config.o -o ${OBJECTDIR}/config.o config.c 
+	
+${OBJECTDIR}/power.o: power.c  .generated_files/flags/free/e8569777cc3c3b3de3f5eaebd4c7eae826fbbb50 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/power.o.d 
+	@${RM} ${OBJECTDIR}/power.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/power.o.d" -MT "${OBJECTDIR}/power.o.d" -MT ${OBJECTDIR}/power.o -o ${OBJECTDIR}/power.o power.c 
+	
+${OBJECTDIR}/lowpower.o: lowpower.c  .generated_files/flags/free/0d4cd724fe30061bc652094496b558c0a7c7e92d .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/lowpower.o.d 
+	@${RM} ${OBJECTDIR}/lowpower.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/lowpower.o.d" -MT "${OBJECTDIR}/lowpower.o.d" -MT ${OBJECTDIR}/lowpower.o -o ${OBJECTDIR}/lowpower.o lowpower.c 
+	
+${OBJECTDIR}/clock.o: clock.c  .generated_files/flags/free/8e3a7dbff96ce7af74b3859962cc7a3372b0a1f8 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/clock.o.d 
+	@${RM} ${OBJECTDIR}/clock.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/clock.o.d" -MT "${OBJECTDIR}/clock.o.d" -MT ${OBJECTDIR}/clock.o -o ${OBJECTDIR}/clock.o clock.c 
+	
+${OBJECTDIR}/bus.o: bus.c  .generated_files/flags/free/a62b23aac4aa1b30c338ac5b20ec586264b42d10 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/bus.o.d 
+	@${RM} ${OBJECTDIR}/bus.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/bus.o.d" -MT "${OBJECTDIR}/bus.o.d" -MT ${OBJECTDIR}/bus.o -o ${OBJECTDIR}/bus.o bus.c 
+	
+${OBJECTDIR}/profile.o: profile.c  .generated_files/flags/free/0bbc418fb68df11d4be965bf239c077cd71951ba .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/profile.o.d 
+	@${RM} ${OBJECTDIR}/profile.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/profile.o.d" -MT "${OBJECTDIR}/profile.o.d" -MT ${OBJECTDIR}/profile.o -o ${OBJECTDIR}/profile.o profile.c 
+	
+${OBJECTDIR}/print.o: print.c  .generated_files/flags/free/0bbc418fb68df11d4be965bf239c077cd71951ba .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/print.o.d 
+	@${RM} ${OBJECTDIR}/print.o 
+	${MP_CC} $(MP_EXTRA_CC_PRE) -mcpu=$(MP_PROCESSOR_OPTION) -c  -x c -D__$(MP_PROCESSOR_OPTION)__   -mdfp="${DFP_DIR}/xc8"  -Wl,--gc-sections -O1 -ffunction-sections -fdata-sections -fshort-enums -funsigned-char -funsigned-bitfields -Wall -DXPRJ_free=$(CND_CONF)  $(COMPARISON_BUILD)  -gdwarf-3 -mconst-data-in-progmem -mno-const-data-in-config-mapped-progmem     -MD -MP -MF "${OBJECTDIR}/print.o.d" -MT "${OBJECTDIR}/print.o.d" -MT ${OBJECTDIR}/print.o -o ${OBJECTDIR}/print.o print.c 
+	
 ${OBJECTDIR}/main.o: main.c  .generated_files/flags/free/99f2003b87b4990016326fdaa83f2cef1a2a51c2 .generated_files/flags/free/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}" 
 	@${RM} ${OBJECTDIR}/main.o.d 
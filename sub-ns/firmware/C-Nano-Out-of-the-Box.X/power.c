@@ -0,0 +1,325 @@
+/*********************************************************************
+ *
+ *              Water Monitor Power Sequencing
+ *
+ *********************************************************************
+ * FileName:        power.c
+ * Dependencies:    power.h, systick.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Each rail can have a sense function, normally an ADC0 reading of the
+ * rail against its tolerance.  A sensed rail moves the sequence on as
+ * soon as it is good and faults if it is not good by POWER_TIMEOUT, a
+ * fault switches every rail off.  Rails without sense wait
+ * POWER_SETTLE, the fixed delay the sequence always used.
+ *
+ * This board brings none of the switched rails back to an ADC pin, so
+ * all the sense entries are NULL for now.
+ *
+ ********************************************************************/
+
+#include "power.h"
+#include "hal.h"
+#include "systick.h"
+#include "profile.h"
+
+typedef struct
+{
+    PORT_t *port;
+    uint8_t pin;
+    bool (*good)(void);                                                         // NULL: wait POWER_SETTLE
+} power_rail_t;
+
+static const power_rail_t power_rails[POWER_RAILS] =
+{
+    {&PORTC, PIN2_bm, NULL},                                                    // 5V_SW_ENABLE
+    {&PORTD, PIN7_bm, NULL},                                                    // 3V3_SW_ENABLE
+    {&PORTD, PIN2_bm, NULL},                                                    // BIAS_ENABLE
+};
+
+static volatile power_state_t power_state = POWER_OFF;
+static volatile bool power_done = false;
+static uint8_t power_rail;                                                      // Rail being waited on
+static uint16_t power_elapsed;                                                  // Ticks on this rail
+
+static void POWER_Tick(void);
+static void POWER_Sequence(bool rising);
+static void POWER_Step(void);
+static void POWER_Finish(power_state_t state);
+
+
+/*********************************************************************
+ * Function:        void POWER_Initialize(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Takes a system tick callback
+ *
+ * Overview:        Hooks the sequencer into the tick, rails off
+ *
+ ********************************************************************/
+
+void POWER_Initialize(void)
+{
+    SYSTICK_AddCallback(POWER_Tick);
+}
+
+
+/*********************************************************************
+ * Function:        void POWER_Up(void)
+ *
+ * PreCondition:    POWER_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    5V rail switched on now, the rest from the tick
+ *
+ * Overview:        Starts the power up sequence.  Already on just
+ *                  reports done again.
+ *
+ ********************************************************************/
+
+void POWER_Up(void)
+{
+    ENTER_CRITICAL(U);
+    if(power_state == POWER_ON)
+    {
+        power_done = true;
+    }
+    else
+    {
+        power_state = POWER_RISING;
+        power_done = false;
+        power_rail = 0;
+        POWER_Step();
+    }
+    EXIT_CRITICAL(U);
+}
+
+
+/*********************************************************************
+ * Function:        void POWER_Down(void)
+ *
+ * PreCondition:    POWER_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    BIAS switched off now, the rest from the tick
+ *
+ * Overview:        Starts the power down sequence
+ *
+ ********************************************************************/
+
+void POWER_Down(void)
+{
+    ENTER_CRITICAL(D);
+    power_state = POWER_FALLING;
+    power_done = false;
+    power_rail = POWER_RAILS - 1;
+    POWER_Step();
+    EXIT_CRITICAL(D);
+}
+
+
+/*********************************************************************
+ * Function:        power_state_t POWER_State(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Where the sequence is
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+power_state_t POWER_State(void)
+{
+    return power_state;
+}
+
+
+/*********************************************************************
+ * Function:        bool POWER_Done(power_state_t *state, uint8_t *rail)
+ *
+ * PreCondition:    None
+ *
+ * Input:           state - receives POWER_ON, POWER_OFF or POWER_FAULT
+ *                  rail - receives the rail that faulted
+ *
+ * Output:          true once after each finished sequence
+ *
+ * Side Effects:    Clears the done flag
+ *
+ * Overview:        Polled from the main loop for the UART notification
+ *
+ ********************************************************************/
+
+bool POWER_Done(power_state_t *state, uint8_t *rail)
+{
+    bool done;
+
+    ENTER_CRITICAL(P);
+    done = power_done;
+    power_done = false;
+    *state = power_state;
+    *rail = power_rail;
+    EXIT_CRITICAL(P);
+
+    return done;
+}
+
+
+/*********************************************************************
+ * Function:        static void POWER_Step(void)
+ *
+ * PreCondition:    Interrupts off, power_rail set
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Switches power_rail and starts its wait
+ *
+ ********************************************************************/
+
+static void POWER_Step(void)
+{
+    const power_rail_t *rail = &power_rails[power_rail];
+
+    if(power_state == POWER_RISING)
+    {
+        HAL_PinSet(rail->port, rail->pin);
+    }
+    else
+    {
+        HAL_PinClear(rail->port, rail->pin);
+    }
+    power_elapsed = 0;
+}
+
+
+/*********************************************************************
+ * Function:        static void POWER_Finish(power_state_t state)
+ *
+ * PreCondition:    Interrupts off
+ *
+ * Input:           state - POWER_ON, POWER_OFF or POWER_FAULT
+ *
+ * Output:          None
+ *
+ * Side Effects:    A fault switches all rails off at once
+ *
+ * Overview:        Ends the sequence and flags it for POWER_Done()
+ *
+ ********************************************************************/
+
+static void POWER_Finish(power_state_t state)
+{
+    uint8_t i;
+
+    if(state == POWER_FAULT)
+    {
+        for(i = POWER_RAILS; i-- > 0; )
+        {
+            HAL_PinClear(power_rails[i].port, power_rails[i].pin);
+        }
+    }
+    power_state = state;
+    power_done = true;
+}
+
+
+/*********************************************************************
+ * Function:        static void POWER_Tick(void)
+ *
+ * PreCondition:    System tick interrupt
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Runs the sequence while it is moving
+ *
+ ********************************************************************/
+
+static void POWER_Tick(void)
+{
+    bool rising = (power_state == POWER_RISING);
+
+    if(!rising && (power_state != POWER_FALLING))
+    {
+        return;
+    }
+    PROFILE_START(P);
+    POWER_Sequence(rising);
+    PROFILE_STOP(P, PROFILE_POWER);
+}
+
+
+/*********************************************************************
+ * Function:        static void POWER_Sequence(bool rising)
+ *
+ * PreCondition:    System tick interrupt, sequence running
+ *
+ * Input:           rising - powering up
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Moves to the next rail once this one is good, or
+ *                  has settled if it has no sense.  No wait after the
+ *                  last rail unless it is sensed.
+ *
+ ********************************************************************/
+
+static void POWER_Sequence(bool rising)
+{
+    const power_rail_t *rail = &power_rails[power_rail];
+    bool last = rising ? (power_rail == POWER_RAILS - 1) : (power_rail == 0);
+
+    power_elapsed++;
+
+    if(rising && (rail->good != NULL))
+    {
+        if(!rail->good())
+        {
+            if(power_elapsed >= POWER_TIMEOUT)
+            {
+                POWER_Finish(POWER_FAULT);
+            }
+            return;
+        }
+    }
+    else if(!last && (power_elapsed < POWER_SETTLE))
+    {
+        return;
+    }
+
+    if(last)
+    {
+        POWER_Finish(rising ? POWER_ON : POWER_OFF);
+        return;
+    }
+    power_rail = rising ? (power_rail + 1) : (power_rail - 1);
+    POWER_Step();
+}
@@ -0,0 +1,39 @@
+/*********************************************************************
+ *
+ *              Water Monitor Power Sequencing Header
+ *
+ *********************************************************************
+ * FileName:        power.h
+ * Dependencies:    mcc_generated_files/mcc.h, systick.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Rails come up 5V, 3V3, BIAS and go down in reverse, one step per
+ * rail, stepped from the system tick so the CLI keeps running.
+ *
+ ********************************************************************/
+
+#ifndef POWER_H
+#define POWER_H
+
+#include "mcc_generated_files/mcc.h"
+#include "systick.h"
+
+#define POWER_RAILS         3
+#define POWER_RAIL_5V       0                                                   // 5V_SW_ENABLE = PC2
+#define POWER_RAIL_3V3      1                                                   // 3V3_SW_ENABLE = PD7
+#define POWER_RAIL_BIAS     2                                                   // BIAS_ENABLE = PD2
+#define POWER_SETTLE        SYSTICK_MS(50)                                      // Wait for a rail with no sense
+#define POWER_TIMEOUT       SYSTICK_MS(250)                                     // Sensed rail not good: fault
+
+typedef enum {POWER_OFF, POWER_RISING, POWER_ON, POWER_FALLING, POWER_FAULT} power_state_t;
+
+void POWER_Initialize(void);
+void POWER_Up(void);                                                            // Returns at once, see POWER_Done()
+void POWER_Down(void);                                                          // Also clears a fault
+power_state_t POWER_State(void);
+bool POWER_Done(power_state_t *state, uint8_t *rail);                           // True once per finished sequence
+
+#endif /* POWER_H */
@@ -0,0 +1,248 @@
+/*********************************************************************
+ *
+ *              Water Monitor Text Output
+ *
+ *********************************************************************
+ * FileName:        print.c
+ * Dependencies:    print.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Decimal digits come from subtracting powers of ten, at most 9
+ * subtractions per digit, so no 32 bit division (a library call of
+ * several hundred cycles on the AVR) is needed.  Hex is shifts only.
+ *
+ * Output goes to USART0_Write(), which waits while the TX ring buffer
+ * is full, the same as printf did through USART0_printCHAR().
+ *
+ ********************************************************************/
+
+#include "print.h"
+
+#define PRINT_DIGITS        10                                                  // 4294967295
+
+static const uint32_t print_powers[PRINT_DIGITS] PROGMEM =
+{
+    1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL,
+    10000UL, 1000UL, 100UL, 10UL, 1UL
+};
+
+static void PRINT_Digits(uint32_t value, uint8_t width);
+
+
+/*********************************************************************
+ * Function:        void PRINT_Text(const char *text)
+ *
+ * PreCondition:    USART0 initialized
+ *
+ * Input:           text - string in flash, PSTR() or PROGMEM
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits while the TX ring buffer is full
+ *
+ * Overview:        Sends a flash string, read a byte at a time
+ *
+ ********************************************************************/
+
+void PRINT_Text(const char *text)
+{
+    char ch;
+
+    while((ch = pgm_read_byte(text++)) != '\0')
+    {
+        USART0_Write(ch);
+    }
+}
+
+
+/*********************************************************************
+ * Function:        void PRINT_String(const char *text)
+ *
+ * PreCondition:    USART0 initialized
+ *
+ * Input:           text - string in RAM
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits while the TX ring buffer is full
+ *
+ * Overview:        Sends a RAM string
+ *
+ ********************************************************************/
+
+void PRINT_String(const char *text)
+{
+    while(*text != '\0')
+    {
+        USART0_Write(*text++);
+    }
+}
+
+
+/*********************************************************************
+ * Function:        void PRINT_Char(char ch)
+ *
+ * PreCondition:    USART0 initialized
+ *
+ * Input:           ch - character
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits while the TX ring buffer is full
+ *
+ * Overview:        Sends one character
+ *
+ ********************************************************************/
+
+void PRINT_Char(char ch)
+{
+    USART0_Write(ch);
+}
+
+
+/*********************************************************************
+ * Function:        void PRINT_Unsigned(uint32_t value)
+ *
+ * PreCondition:    USART0 initialized
+ *
+ * Input:           value - number to send
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits while the TX ring buffer is full
+ *
+ * Overview:        %u and %lu
+ *
+ ********************************************************************/
+
+void PRINT_Unsigned(uint32_t value)
+{
+    PRINT_Digits(value, 1);
+}
+
+
+/*********************************************************************
+ * Function:        void PRINT_Signed(int32_t value)
+ *
+ * PreCondition:    USART0 initialized
+ *
+ * Input:           value - number to send
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits while the TX ring buffer is full
+ *
+ * Overview:        %d and %ld
+ *
+ ********************************************************************/
+
+void PRINT_Signed(int32_t value)
+{
+    uint32_t magnitude = (uint32_t)value;
+
+    if(value < 0)
+    {
+        USART0_Write('-');
+        magnitude = 0UL - magnitude;                                            // Also right for INT32_MIN
+    }
+    PRINT_Digits(magnitude, 1);
+}
+
+
+/*********************************************************************
+ * Function:        void PRINT_Padded(uint32_t value, uint8_t width)
+ *
+ * PreCondition:    USART0 initialized
+ *
+ * Input:           value - number to send
+ *                  width - at least this many digits, 1 to 10
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits while the TX ring buffer is full
+ *
+ * Overview:        %03u and the like
+ *
+ ********************************************************************/
+
+void PRINT_Padded(uint32_t value, uint8_t width)
+{
+    PRINT_Digits(value, width);
+}
+
+
+/*********************************************************************
+ * Function:        void PRINT_Hex(uint32_t value, uint8_t digits)
+ *
+ * PreCondition:    USART0 initialized
+ *
+ * Input:           value - number to send
+ *                  digits - how many low nibbles, 1 to 8
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits while the TX ring buffer is full
+ *
+ * Overview:        %0nX, no prefix
+ *
+ ********************************************************************/
+
+void PRINT_Hex(uint32_t value, uint8_t digits)
+{
+    uint8_t nibble;
+
+    while(digits-- > 0)
+    {
+        nibble = (value >> (digits * 4)) & 0x0F;
+        USART0_Write((nibble < 10) ? ('0' + nibble) : ('A' - 10 + nibble));
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void PRINT_Digits(uint32_t value, uint8_t width)
+ *
+ * PreCondition:    USART0 initialized
+ *
+ * Input:           value - number to send
+ *                  width - minimum digits, 1 to PRINT_DIGITS
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits while the TX ring buffer is full
+ *
+ * Overview:        Counts each power of ten out of value.  Leading
+ *                  zeros are dropped until the digit count is within
+ *                  width of the end
+ *
+ ********************************************************************/
+
+static void PRINT_Digits(uint32_t value, uint8_t width)
+{
+    uint32_t power;
+    uint8_t digit;
+    uint8_t i;
+    bool leading = true;
+
+    for(i = 0; i < PRINT_DIGITS; i++)
+    {
+        power = pgm_read_dword(&print_powers[i]);
+        digit = '0';
+        while(value >= power)
+        {
+            value -= power;
+            digit++;
+        }
+        if((digit != '0') || (i >= PRINT_DIGITS - width))
+        {
+            leading = false;
+        }
+        if(!leading)
+        {
+            USART0_Write(digit);
+        }
+    }
+}
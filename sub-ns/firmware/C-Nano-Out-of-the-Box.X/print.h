@@ -0,0 +1,44 @@
+/*********************************************************************
+ *
+ *              Water Monitor Text Output Header
+ *
+ *********************************************************************
+ * FileName:        print.h
+ * Dependencies:    mcc_generated_files/mcc.h, avr/pgmspace.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * ASCII CLI replies without printf.  Text is sent from flash, numbers
+ * by fixed emitters, each straight into the USART0 TX ring buffer.
+ * Nothing parses a format at run time and vfprintf is not linked.
+ *
+ *      printf("\r\nBurst: %lu pulses\r\n", pulses);
+ *
+ * becomes
+ *
+ *      PRINT_Text(PSTR("\r\nBurst: "));
+ *      PRINT_Unsigned(pulses);
+ *      PRINT_Text(PSTR(" pulses\r\n"));
+ *
+ * PRINT_Text() takes flash strings only, PSTR() literals or PROGMEM
+ * arrays.  RAM strings go to PRINT_String().
+ *
+ ********************************************************************/
+
+#ifndef PRINT_H
+#define PRINT_H
+
+#include "mcc_generated_files/mcc.h"
+#include <avr/pgmspace.h>
+
+void PRINT_Text(const char *text);                                              // Flash string
+void PRINT_String(const char *text);                                            // RAM string
+void PRINT_Char(char ch);
+void PRINT_Unsigned(uint32_t value);                                            // Decimal, no padding
+void PRINT_Signed(int32_t value);                                               // Decimal, '-' if negative
+void PRINT_Padded(uint32_t value, uint8_t width);                               // Decimal, leading zeros to width
+void PRINT_Hex(uint32_t value, uint8_t digits);                                 // Upper case, digits 1-8
+
+#endif /* PRINT_H */
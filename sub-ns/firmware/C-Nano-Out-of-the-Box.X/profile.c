@@ -0,0 +1,262 @@
+/*********************************************************************
+ *
+ *              Water Monitor Profiling
+ *
+ *********************************************************************
+ * FileName:        profile.c
+ * Dependencies:    profile.h, clock.h, systick.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * A sample is the TCB2 difference between PROFILE_START and
+ * PROFILE_STOP, less the cost of an empty start and stop measured at
+ * start up.  TCB2 wraps every 65536 cycles (2.7ms at 24MHz), so a
+ * longer span is timed on the RTC counter instead, to about 730
+ * cycles at 24MHz.  Counts are CLK_PER cycles at whatever speed the
+ * clock ran, a span across CLOCK_Set() mixes the two.
+ *
+ * Samples come from interrupts too, so each update is atomic.
+ *
+ ********************************************************************/
+
+#include "profile.h"
+
+#if PROFILE_ENABLE
+
+#include "clock.h"
+#include "systick.h"
+#include <avr/pgmspace.h>
+
+#define PROFILE_FINE_MAX    64                                                  // RTC counts still safe on TCB2 at 24MHz
+
+typedef struct
+{
+    uint16_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+} profile_probe_stats_t;
+
+static profile_probe_stats_t profile_stats[PROFILE_PROBES];
+static uint16_t profile_overhead = 0;
+
+static const char profile_names[PROFILE_PROBES][12] PROGMEM =
+{
+    "Command",
+    "Board E/D",
+    "Power tick",
+    "ADC ISR",
+    "UART TX ISR",
+};
+
+static void PROFILE_Clear(profile_probe_stats_t *stats);
+
+
+/*********************************************************************
+ * Function:        void PROFILE_Initialize(void)
+ *
+ * PreCondition:    CLOCK_Initialize(), SYSTICK_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    All probes cleared
+ *
+ * Overview:        Times an empty probe, the smallest of a few is
+ *                  taken off every sample
+ *
+ ********************************************************************/
+
+void PROFILE_Initialize(void)
+{
+    profile_mark_t mark;
+    uint16_t cycles;
+    uint8_t i;
+
+    profile_overhead = 0xFFFF;
+    for(i = 0; i < 4; i++)
+    {
+        PROFILE_Mark(&mark);
+        cycles = CLOCK_Cycles() - mark.cycles;
+        if(cycles < profile_overhead)
+        {
+            profile_overhead = cycles;
+        }
+    }
+    for(i = 0; i < PROFILE_PROBES; i++)
+    {
+        PROFILE_Clear(&profile_stats[i]);
+    }
+}
+
+
+/*********************************************************************
+ * Function:        void PROFILE_Mark(profile_mark_t *mark)
+ *
+ * PreCondition:    PROFILE_Initialize()
+ *
+ * Input:           mark - filled with the start time
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        PROFILE_START(), the RTC first so TCB2 is read
+ *                  last, next to the measured code
+ *
+ ********************************************************************/
+
+void PROFILE_Mark(profile_mark_t *mark)
+{
+    mark->fine = SYSTICK_Fine();
+    mark->cycles = CLOCK_Cycles();
+}
+
+
+/*********************************************************************
+ * Function:        void PROFILE_Record(profile_probe_t probe,
+ *                                      const profile_mark_t *start)
+ *
+ * PreCondition:    PROFILE_Mark(start)
+ *
+ * Input:           probe - PROFILE_xxx
+ *                  start - from PROFILE_START()
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        PROFILE_STOP(), adds one sample.  Sum and count
+ *                  are halved together before the sum overflows, so
+ *                  the mean leans toward recent samples
+ *
+ ********************************************************************/
+
+void PROFILE_Record(profile_probe_t probe, const profile_mark_t *start)
+{
+    uint16_t now = CLOCK_Cycles();
+    uint16_t fine = SYSTICK_Fine() - start->fine;
+    profile_probe_stats_t *stats = &profile_stats[probe];
+    uint32_t cycles;
+
+    if(fine >= PROFILE_FINE_MAX)
+    {
+        cycles = ((uint32_t)fine * (CLOCK_Hz() >> 10)) >> 5;                    // TCB2 may have wrapped, x Hz / 32768
+    }
+    else
+    {
+        cycles = (uint16_t)(now - start->cycles);
+    }
+    cycles = (cycles > profile_overhead) ? (cycles - profile_overhead) : 0;
+
+    ENTER_CRITICAL(P);
+    if((stats->count == 0xFFFF) || (stats->sum + cycles < stats->sum))
+    {
+        stats->count >>= 1;
+        stats->sum >>= 1;
+    }
+    stats->count++;
+    stats->sum += cycles;
+    if(cycles < stats->min)
+    {
+        stats->min = cycles;
+    }
+    if(cycles > stats->max)
+    {
+        stats->max = cycles;
+    }
+    EXIT_CRITICAL(P);
+}
+
+
+/*********************************************************************
+ * Function:        bool PROFILE_Get(uint8_t probe, profile_stats_t *stats,
+ *                                   bool reset)
+ *
+ * PreCondition:    PROFILE_Initialize()
+ *
+ * Input:           probe - PROFILE_xxx
+ *                  stats - filled in, min and max 0 with no samples
+ *                  reset - clear the probe after reading
+ *
+ * Output:          False if there is no such probe
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Atomic copy of one probe
+ *
+ ********************************************************************/
+
+bool PROFILE_Get(uint8_t probe, profile_stats_t *stats, bool reset)
+{
+    profile_probe_stats_t copy;
+
+    if(probe >= PROFILE_PROBES)
+    {
+        return false;
+    }
+    ENTER_CRITICAL(G);
+    copy = profile_stats[probe];
+    if(reset)
+    {
+        PROFILE_Clear(&profile_stats[probe]);
+    }
+    EXIT_CRITICAL(G);
+
+    stats->count = copy.count;
+    stats->min = copy.count ? copy.min : 0;
+    stats->max = copy.max;
+    stats->mean = copy.count ? (copy.sum / copy.count) : 0;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        const char *PROFILE_Name(uint8_t probe)
+ *
+ * PreCondition:    None
+ *
+ * Input:           probe - PROFILE_xxx
+ *
+ * Output:          Name for the ASCII report in flash, for PRINT_Text(),
+ *                  "" if there is no such probe
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Probe names, in profile_probe_t order
+ *
+ ********************************************************************/
+
+const char *PROFILE_Name(uint8_t probe)
+{
+    return (probe < PROFILE_PROBES) ? profile_names[probe] : PSTR("");
+}
+
+
+/*********************************************************************
+ * Function:        static void PROFILE_Clear(profile_probe_stats_t *stats)
+ *
+ * PreCondition:    Interrupts off, or not yet running
+ *
+ * Input:           stats - probe to clear
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        No samples, min ready for the first one
+ *
+ ********************************************************************/
+
+static void PROFILE_Clear(profile_probe_stats_t *stats)
+{
+    stats->count = 0;
+    stats->min = 0xFFFFFFFFUL;
+    stats->max = 0;
+    stats->sum = 0;
+}
+
+#endif /* PROFILE_ENABLE */
@@ -0,0 +1,78 @@
+/*********************************************************************
+ *
+ *              Water Monitor Profiling Header
+ *
+ *********************************************************************
+ * FileName:        profile.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Cycle counts of named code paths, taken from the TCB2 counter that
+ * clock.c keeps free running.  Each probe keeps its min, max and mean
+ * in RAM, read with the IP command or OP_PROFILE.
+ *
+ * Off unless built with PROFILE_ENABLE set to 1 (or -DPROFILE_ENABLE=1).
+ * Off, PROFILE_START and PROFILE_STOP expand to nothing and profile.c
+ * is empty, so no code or RAM is left in the measured paths.
+ *
+ *      PROFILE_START(P);
+ *      ...code...
+ *      PROFILE_STOP(P, PROFILE_COMMAND);
+ *
+ ********************************************************************/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "mcc_generated_files/mcc.h"
+
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE      0                                                   // 1 for a profiling build
+#endif
+
+typedef enum
+{
+    PROFILE_COMMAND,                                                            // ASCII or binary command handler
+    PROFILE_BOARD,                                                              // BoardSetStatus(), E or D
+    PROFILE_POWER,                                                              // Power sequencer tick
+    PROFILE_ADC,                                                                // ADC0 result ISR
+    PROFILE_UART_TX,                                                            // USART0 data register empty ISR
+    PROFILE_PROBES
+} profile_probe_t;
+
+typedef struct
+{
+    uint16_t count;                                                             // Samples, halved with sum near overflow
+    uint32_t min;                                                               // CLK_PER cycles
+    uint32_t max;
+    uint32_t mean;
+} profile_stats_t;
+
+#if PROFILE_ENABLE
+
+typedef struct
+{
+    uint16_t cycles;                                                            // CLOCK_Cycles()
+    uint16_t fine;                                                              // SYSTICK_Fine(), for spans past 16 bits
+} profile_mark_t;
+
+#define PROFILE_START(P)        profile_mark_t P##_mark; PROFILE_Mark(&P##_mark)
+#define PROFILE_STOP(P, probe)  PROFILE_Record((probe), &P##_mark)
+
+void PROFILE_Initialize(void);                                                  // Measures the probe overhead
+void PROFILE_Mark(profile_mark_t *mark);
+void PROFILE_Record(profile_probe_t probe, const profile_mark_t *start);
+bool PROFILE_Get(uint8_t probe, profile_stats_t *stats, bool reset);            // False for no such probe
+const char *PROFILE_Name(uint8_t probe);                                        // Flash string
+
+#else
+
+#define PROFILE_START(P)
+#define PROFILE_STOP(P, probe)
+
+#endif
+
+#endif /* PROFILE_H */
@@ -0,0 +1,97 @@
+/*********************************************************************
+ *
+ *              Water Monitor Binary Protocol Header
+ *
+ *********************************************************************
+ * FileName:        protocol.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Framing for the binary host protocol.  Every frame, both ways, is
+ *
+ *      SYNC | OPCODE | LENGTH | PAYLOAD[LENGTH] | CRC16 low | CRC16 high
+ *
+ * CRC16 is CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over OPCODE,
+ * LENGTH and PAYLOAD.  A reply echoes the opcode with bit 7 set and
+ * carries a status byte as the first payload byte, followed by data.
+ * Unrequested messages also have bit 6 set.
+ *
+ ********************************************************************/
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "mcc_generated_files/mcc.h"
+
+#define PROTOCOL_SYNC           0xA5
+#define PROTOCOL_VERSION        1
+#define PROTOCOL_PAYLOAD_MAX    16
+#define PROTOCOL_REPLY          0x80                                            // Set in reply opcodes
+#define PROTOCOL_NOTIFY         0x40                                            // Also set in unrequested messages
+
+/* Opcodes */
+#define OP_PING                 0x00                                            // Reply: protocol version
+#define OP_ENABLE               0x01                                            // u8: 1 = Active, 0 = Standby. Notify 0xC1: u8 0 standby/1 active/2 fault, u8 rail
+#define OP_TRIGGER              0x02                                            // u8: 'I' internal, 'E' external
+#define OP_RATE                 0x03                                            // u8 'S'/'F', or u32 Hz. Reply: u32 Hz, u16 mHz, i32 ppm
+#define OP_LED                  0x04                                            // u8: 0 off, 1-7 LED
+#define OP_BIAS_SET             0x05                                            // u16: DAC code 0-1023
+#define OP_ADC_QUERY            0x06                                            // Reply: u16 bias ADC, u16 oversampled 16 bit, u16 mV
+#define OP_MODE                 0x07                                            // u8: 0 = back to ASCII CLI
+#define OP_WIDTH                0x08                                            // u8 unit (0 ticks, 1 ns, 2 %), u32. Reply: u16 ticks, u32 ns
+#define OP_BURST                0x09                                            // u32 pulses. Notify 0xC9: u32 pulses when done
+#define OP_COUNT                0x0A                                            // u8: 1 = reset after read. Reply: u32 pulses
+#define OP_SEQ_CLEAR            0x0B                                            // Stops and empties the sequence
+#define OP_SEQ_ADD              0x0C                                            // u8 LED, u8 0 count/1 ms, u32 amount, u16 bias (0xFFFF keep)
+#define OP_SEQ_START            0x0D                                            // u32 loops, 0 = until stopped. Notify 0xCD when done
+#define OP_SEQ_STOP             0x0E
+#define OP_RAMP_LINEAR          0x0F                                            // u16 start, stop, step, ms, u8 flags (bit 0 report values)
+#define OP_RAMP_TABLE           0x10                                            // Up to 7 u16 points appended, none clears. Reply: u8 length
+#define OP_RAMP_START           0x11                                            // u16 ms, u8 flags. Runs the table
+#define OP_RAMP_STOP            0x12                                            // Notify 0xD2 when a ramp finishes
+#define OP_RAMP_VALUE           0x13                                            // Notify only, 0xD3: u16 DAC code applied
+#define OP_ADC_AVERAGE          0x14                                            // u8: 2^n samples per ADC result, 0-7
+#define OP_LOOP_START           0x15                                            // u16 setpoint mV
+#define OP_LOOP_STOP            0x16
+#define OP_LOOP_GAINS           0x17                                            // u16 kp, ki, tolerance, none to read. Reply: same
+#define OP_LOOP_STATUS          0x18                                            // Reply: u8 running, u8 locked, u16 setpoint mV, bias mV, DAC. Notify 0xD8: u8 locked
+#define OP_BIAS_SET_MV          0x19                                            // u16 mV. Reply: u16 DAC code used
+#define OP_CALIBRATION          0x1A                                            // u16 DAC gain, i16 offset, u16 ADC gain, i16 offset, none to read
+#define OP_CALIBRATION_SAVE     0x1B                                            // Calibration to EEPROM
+#define OP_CONFIG_SAVE          0x1C                                            // u8: 1 = restore at power up
+#define OP_CONFIG_RESTORE       0x1D                                            // Notify 0xDD when a restore waiting for power up is applied
+#define OP_SLEEP_STATS          0x1E                                            // Reply: u32 s, u16 ms asleep, u32 ticks up, u32 wake ups. u8 1: u32 wake ups, u32 by the tick
+#define OP_CLOCK                0x1F                                            // 0 bytes read, u8 source to set. Reply: u8 source, u8 crystal, u32 Hz
+#define OP_CLOCK_MEASURE        0x20                                            // Notify 0xE0: u32 Hz, i32 ppm after 1s
+#define OP_SYNC                 0x21                                            // u8 0 off / 1 master / 2 slave, u32 delay ns, none to read. Reply: same
+#define OP_BUS_ADDRESS          0x22                                            // u8 1-254 sets and saves, none to read. Reply: u8 address
+#define OP_BAUD                 0x23                                            // u32 baud, none to read. Reply: u32 baud, i32 error ppm at 24MHz, u8 CLK2X. Notify: u32 baud on fallback
+#define OP_PROFILE              0x24                                            // u8 probe, u8 1 = reset after read. Reply: u16 samples, u32 min, max, mean cycles. PROFILE_ENABLE builds only
+
+/* Reply status */
+#define STATUS_OK               0x00
+#define STATUS_NOT_ENABLED      0x01                                            // Board in standby
+#define STATUS_INVALID          0x02                                            // Bad parameter
+#define STATUS_UNKNOWN_OP       0x03
+#define STATUS_BAD_LENGTH       0x04
+#define STATUS_BAD_CRC          0x05
+#define STATUS_BUSY             0x06                                            // Sequencer, ramp or bias loop owns the hardware
+
+typedef struct
+{
+    uint8_t opcode;
+    uint8_t length;
+    uint8_t payload[PROTOCOL_PAYLOAD_MAX];
+} protocol_frame_t;
+
+typedef enum {PROTOCOL_PENDING, PROTOCOL_FRAME, PROTOCOL_CRC_ERROR} protocol_result_t;
+
+protocol_result_t PROTOCOL_Receive(uint8_t ch, protocol_frame_t *frame);       // Feed one received byte
+void PROTOCOL_Reset(void);                                                      // Drop a partial frame
+void PROTOCOL_Send(uint8_t opcode, uint8_t status, const uint8_t *data, uint8_t length);
+uint16_t PROTOCOL_CRC16(uint16_t crc, uint8_t data);
+
+#endif /* PROTOCOL_H */
@@ -0,0 +1,429 @@
+/*********************************************************************
+ *
+ *              Water Monitor Bias Ramp
+ *
+ *********************************************************************
+ * FileName:        ramp.c
+ * Dependencies:    ramp.h, bias.h, systick.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * The DAC is written from the tick interrupt so steps are evenly
+ * spaced whatever the main loop is doing.  Reporting is left to the
+ * main loop through a small FIFO, values are dropped if it is full.
+ *
+ ********************************************************************/
+
+#include "ramp.h"
+#include "bias.h"
+#include "systick.h"
+
+#define RAMP_FIFO_SIZE      16                                                  // Power of 2
+
+typedef enum {RAMP_LINEAR, RAMP_TABLE} ramp_profile_t;
+
+static uint16_t ramp_table[RAMP_TABLE_SIZE];
+static uint8_t ramp_table_length = 0;
+
+static volatile bool ramp_running = false;
+static volatile bool ramp_done = false;
+static ramp_profile_t ramp_profile;
+static bool ramp_emit;
+static uint16_t ramp_value;                                                     // Linear: last value applied
+static uint16_t ramp_stop;
+static uint16_t ramp_step;
+static uint8_t ramp_index;                                                      // Table: next entry
+static uint16_t ramp_interval;                                                  // Ticks per step
+static uint16_t ramp_countdown;
+
+static uint16_t ramp_fifo[RAMP_FIFO_SIZE];
+static volatile uint8_t ramp_fifo_head = 0;
+static volatile uint8_t ramp_fifo_tail = 0;
+
+static void RAMP_Apply(uint16_t value);
+static void RAMP_Tick(void);
+static bool RAMP_Start(uint16_t interval_ms, bool emit);
+
+
+/*********************************************************************
+ * Function:        void RAMP_Initialize(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Takes a system tick callback
+ *
+ * Overview:        Hooks the step timer into the tick
+ *
+ ********************************************************************/
+
+void RAMP_Initialize(void)
+{
+    SYSTICK_AddCallback(RAMP_Tick);
+}
+
+
+/*********************************************************************
+ * Function:        bool RAMP_StartLinear(uint16_t start, uint16_t stop,
+ *                          uint16_t step, uint16_t interval_ms, bool emit)
+ *
+ * PreCondition:    Board active
+ *
+ * Input:           start, stop - DAC codes, either direction
+ *                  step - DAC codes per interval, at least 1
+ *                  interval_ms - 1 to RAMP_INTERVAL_MAX
+ *                  emit - report every value applied
+ *
+ * Output:          false if out of range
+ *
+ * Side Effects:    start applied at once
+ *
+ * Overview:        Steps from start to stop, the last step is cut
+ *                  short so stop is always reached
+ *
+ ********************************************************************/
+
+bool RAMP_StartLinear(uint16_t start, uint16_t stop, uint16_t step, uint16_t interval_ms, bool emit)
+{
+    if((start > BIAS_DAC_MAX) || (stop > BIAS_DAC_MAX) || (step == 0))
+    {
+        return false;
+    }
+    RAMP_Stop();
+    ramp_profile = RAMP_LINEAR;
+    ramp_stop = stop;
+    ramp_step = step;
+    ramp_value = start;
+    return RAMP_Start(interval_ms, emit);
+}
+
+
+/*********************************************************************
+ * Function:        void RAMP_TableClear(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Stops a running ramp
+ *
+ * Overview:        Empties the table profile
+ *
+ ********************************************************************/
+
+void RAMP_TableClear(void)
+{
+    RAMP_Stop();
+    ramp_table_length = 0;
+}
+
+
+/*********************************************************************
+ * Function:        bool RAMP_TableAdd(uint16_t value)
+ *
+ * PreCondition:    Ramp not running
+ *
+ * Input:           value - DAC code
+ *
+ * Output:          false if full, running or out of range
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Appends a point to the table profile
+ *
+ ********************************************************************/
+
+bool RAMP_TableAdd(uint16_t value)
+{
+    if(ramp_running || (value > BIAS_DAC_MAX) || (ramp_table_length >= RAMP_TABLE_SIZE))
+    {
+        return false;
+    }
+    ramp_table[ramp_table_length++] = value;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        uint8_t RAMP_TableLength(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Points in the table
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+uint8_t RAMP_TableLength(void)
+{
+    return ramp_table_length;
+}
+
+
+/*********************************************************************
+ * Function:        bool RAMP_StartTable(uint16_t interval_ms, bool emit)
+ *
+ * PreCondition:    Board active
+ *
+ * Input:           interval_ms - 1 to RAMP_INTERVAL_MAX
+ *                  emit - report every value applied
+ *
+ * Output:          false if the table is empty or interval out of range
+ *
+ * Side Effects:    First point applied at once
+ *
+ * Overview:        Steps through the table once
+ *
+ ********************************************************************/
+
+bool RAMP_StartTable(uint16_t interval_ms, bool emit)
+{
+    if(ramp_table_length == 0)
+    {
+        return false;
+    }
+    RAMP_Stop();
+    ramp_profile = RAMP_TABLE;
+    ramp_index = 0;
+    return RAMP_Start(interval_ms, emit);
+}
+
+
+/*********************************************************************
+ * Function:        void RAMP_Stop(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    DAC left at the last value applied
+ *
+ * Overview:        Abandons the profile
+ *
+ ********************************************************************/
+
+void RAMP_Stop(void)
+{
+    ramp_running = false;
+}
+
+
+/*********************************************************************
+ * Function:        bool RAMP_Running(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          true while the ramp owns the DAC
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Manual bias commands are refused while running
+ *
+ ********************************************************************/
+
+bool RAMP_Running(void)
+{
+    return ramp_running;
+}
+
+
+/*********************************************************************
+ * Function:        bool RAMP_Done(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          true once after the profile finished
+ *
+ * Side Effects:    Clears the done flag
+ *
+ * Overview:        Polled from the main loop for the UART notification
+ *
+ ********************************************************************/
+
+bool RAMP_Done(void)
+{
+    if(!ramp_done)
+    {
+        return false;
+    }
+    ramp_done = false;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        bool RAMP_GetApplied(uint16_t *value)
+ *
+ * PreCondition:    None
+ *
+ * Input:           value - receives the oldest unreported value
+ *
+ * Output:          false if nothing is waiting
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Main loop side of the report FIFO
+ *
+ ********************************************************************/
+
+bool RAMP_GetApplied(uint16_t *value)
+{
+    uint8_t tail = ramp_fifo_tail;
+
+    if(tail == ramp_fifo_head)
+    {
+        return false;
+    }
+    *value = ramp_fifo[tail];
+    ramp_fifo_tail = (tail + 1) & (RAMP_FIFO_SIZE - 1);
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        static bool RAMP_Start(uint16_t interval_ms, bool emit)
+ *
+ * PreCondition:    Profile set up, ramp stopped
+ *
+ * Input:           interval_ms - 1 to RAMP_INTERVAL_MAX
+ *                  emit - report every value applied
+ *
+ * Output:          false if interval out of range
+ *
+ * Side Effects:    First value applied
+ *
+ * Overview:        Common start for both profiles
+ *
+ ********************************************************************/
+
+static bool RAMP_Start(uint16_t interval_ms, bool emit)
+{
+    if((interval_ms == 0) || (interval_ms > RAMP_INTERVAL_MAX))
+    {
+        return false;
+    }
+    ramp_interval = SYSTICK_MS(interval_ms);
+    ramp_countdown = ramp_interval;
+    ramp_emit = emit;
+    ramp_done = false;
+    ramp_fifo_tail = ramp_fifo_head;                                            // Nothing left from the last run
+
+    ENTER_CRITICAL(R);
+    if(ramp_profile == RAMP_LINEAR)
+    {
+        RAMP_Apply(ramp_value);
+    }
+    else
+    {
+        RAMP_Apply(ramp_table[ramp_index++]);
+    }
+    ramp_running = true;
+    EXIT_CRITICAL(R);
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        static void RAMP_Apply(uint16_t value)
+ *
+ * PreCondition:    Interrupts off
+ *
+ * Input:           value - DAC code
+ *
+ * Output:          None
+ *
+ * Side Effects:    Queues value for reporting if emit set
+ *
+ * Overview:        Writes one step to the DAC
+ *
+ ********************************************************************/
+
+static void RAMP_Apply(uint16_t value)
+{
+    uint8_t next;
+
+    BIAS_SetDAC(value);
+    if(ramp_emit)
+    {
+        next = (ramp_fifo_head + 1) & (RAMP_FIFO_SIZE - 1);
+        if(next != ramp_fifo_tail)
+        {
+            ramp_fifo[ramp_fifo_head] = value;
+            ramp_fifo_head = next;
+        }
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void RAMP_Tick(void)
+ *
+ * PreCondition:    System tick interrupt
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Applies the next step every ramp_interval ticks
+ *
+ ********************************************************************/
+
+static void RAMP_Tick(void)
+{
+    bool last;
+
+    if(!ramp_running || (--ramp_countdown != 0))
+    {
+        return;
+    }
+    ramp_countdown = ramp_interval;
+
+    if(ramp_profile == RAMP_LINEAR)
+    {
+        if(ramp_value < ramp_stop)
+        {
+            ramp_value = ((ramp_stop - ramp_value) > ramp_step) ? (ramp_value + ramp_step) : ramp_stop;
+        }
+        else if(ramp_value > ramp_stop)
+        {
+            ramp_value = ((ramp_value - ramp_stop) > ramp_step) ? (ramp_value - ramp_step) : ramp_stop;
+        }
+        RAMP_Apply(ramp_value);
+        last = (ramp_value == ramp_stop);
+    }
+    else
+    {
+        last = (ramp_index >= ramp_table_length);
+        if(!last)
+        {
+            RAMP_Apply(ramp_table[ramp_index++]);
+            last = (ramp_index >= ramp_table_length);
+        }
+    }
+
+    if(last)
+    {
+        ramp_running = false;
+        ramp_done = true;
+    }
+}
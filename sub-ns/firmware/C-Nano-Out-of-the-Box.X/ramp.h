@@ -0,0 +1,40 @@
+/*********************************************************************
+ *
+ *              Water Monitor Bias Ramp Header
+ *
+ *********************************************************************
+ * FileName:        ramp.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Drives the bias DAC through a linear or table profile from the
+ * system tick, one step per interval.  Applied values can be read
+ * back for RAMP_VALUE frames, see DV_RAMP_SETTINGS.json.
+ *
+ ********************************************************************/
+
+#ifndef RAMP_H
+#define RAMP_H
+
+#include "mcc_generated_files/mcc.h"
+
+#define RAMP_TABLE_SIZE     64
+#define RAMP_INTERVAL_MAX   60000                                               // ms
+#define RAMP_FRAME_START    0x03                                                // Data Visualizer start of frame
+#define RAMP_FRAME_END      ((uint8_t)~RAMP_FRAME_START)                        // Ones' complement end of frame
+
+void RAMP_Initialize(void);
+bool RAMP_StartLinear(uint16_t start, uint16_t stop, uint16_t step, uint16_t interval_ms, bool emit);
+void RAMP_TableClear(void);
+bool RAMP_TableAdd(uint16_t value);                                             // False if full or above DAC range
+uint8_t RAMP_TableLength(void);
+bool RAMP_StartTable(uint16_t interval_ms, bool emit);                          // False if the table is empty
+void RAMP_Stop(void);
+bool RAMP_Running(void);
+bool RAMP_Done(void);                                                           // True once when the profile ends
+bool RAMP_GetApplied(uint16_t *value);                                          // Next value to report, if emit set
+
+#endif /* RAMP_H */
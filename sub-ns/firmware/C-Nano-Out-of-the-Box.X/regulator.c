@@ -0,0 +1,407 @@
+/*********************************************************************
+ *
+ *              Water Monitor Bias Regulator
+ *
+ *********************************************************************
+ * FileName:        regulator.c
+ * Dependencies:    regulator.h, bias.h, systick.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * The loop runs from the system tick every REGULATOR_PERIOD ticks on
+ * the latest averaged ADC result.  The DAC is inverted, so the loop
+ * output is the drive below BIAS_DAC_MAX: more drive, more bias.
+ *
+ * The integrator is kept in DAC codes with 16 fractional bits and is
+ * clamped to the DAC range.  It also stops integrating while the
+ * output is saturated in the direction of the error (anti-windup).
+ *
+ ********************************************************************/
+
+#include "regulator.h"
+#include "bias.h"
+#include "systick.h"
+
+#define REGULATOR_ERROR_MAX     32767                                           // Keeps gain * error inside int32
+#define REGULATOR_DRIVE_MAX     ((int32_t)BIAS_DAC_MAX << 16)
+
+static volatile bool regulator_running = false;
+static volatile bool regulator_locked = false;
+static volatile bool regulator_lock_changed = false;
+static uint16_t regulator_setpoint;
+static uint16_t regulator_kp = REGULATOR_KP_DEFAULT;
+static uint16_t regulator_ki = REGULATOR_KI_DEFAULT;
+static uint16_t regulator_tolerance = REGULATOR_TOL_DEFAULT;
+static int32_t regulator_integral;                                              // Drive, DAC codes << 16
+static uint8_t regulator_countdown = REGULATOR_PERIOD;
+static uint8_t regulator_in_tolerance;                                          // Consecutive updates
+
+static void REGULATOR_Tick(void);
+static void REGULATOR_SetLocked(bool locked);
+
+
+/*********************************************************************
+ * Function:        void REGULATOR_Initialize(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Takes a system tick callback
+ *
+ * Overview:        Hooks the loop into the tick, loop stopped
+ *
+ ********************************************************************/
+
+void REGULATOR_Initialize(void)
+{
+    SYSTICK_AddCallback(REGULATOR_Tick);
+}
+
+
+/*********************************************************************
+ * Function:        bool REGULATOR_Start(uint16_t setpoint)
+ *
+ * PreCondition:    Board active, nothing else driving the DAC
+ *
+ * Input:           setpoint - BIAS_ReadADC16() counts
+ *
+ * Output:          false if setpoint is 0
+ *
+ * Side Effects:    Takes over the bias DAC
+ *
+ * Overview:        Starts or retargets the loop.  The integrator
+ *                  starts from the present DAC value so the output
+ *                  does not jump.
+ *
+ ********************************************************************/
+
+bool REGULATOR_Start(uint16_t setpoint)
+{
+    if(setpoint == 0)
+    {
+        return false;
+    }
+    ENTER_CRITICAL(R);
+    if(!regulator_running)
+    {
+        regulator_integral = (int32_t)(BIAS_DAC_MAX - BIAS_GetDAC()) << 16;
+        regulator_countdown = REGULATOR_PERIOD;
+    }
+    regulator_setpoint = setpoint;
+    regulator_in_tolerance = 0;
+    REGULATOR_SetLocked(false);
+    regulator_running = true;
+    EXIT_CRITICAL(R);
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        void REGULATOR_Stop(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    DAC left at the last loop output
+ *
+ * Overview:        Back to open loop
+ *
+ ********************************************************************/
+
+void REGULATOR_Stop(void)
+{
+    ENTER_CRITICAL(S);
+    regulator_running = false;
+    REGULATOR_SetLocked(false);
+    EXIT_CRITICAL(S);
+}
+
+
+/*********************************************************************
+ * Function:        void REGULATOR_SetGains(uint16_t kp, uint16_t ki,
+ *                                          uint16_t tolerance)
+ *
+ * PreCondition:    None
+ *
+ * Input:           kp, ki - DAC codes per count, 16 fractional bits
+ *                  tolerance - lock window, counts either side
+ *
+ * Output:          None
+ *
+ * Side Effects:    Drops lock, takes effect at the next update
+ *
+ * Overview:        Loop tuning
+ *
+ ********************************************************************/
+
+void REGULATOR_SetGains(uint16_t kp, uint16_t ki, uint16_t tolerance)
+{
+    ENTER_CRITICAL(G);
+    regulator_kp = kp;
+    regulator_ki = ki;
+    regulator_tolerance = tolerance;
+    regulator_in_tolerance = 0;
+    REGULATOR_SetLocked(false);
+    EXIT_CRITICAL(G);
+}
+
+
+/*********************************************************************
+ * Function:        void REGULATOR_GetGains(uint16_t *kp, uint16_t *ki,
+ *                                          uint16_t *tolerance)
+ *
+ * PreCondition:    None
+ *
+ * Input:           Pointers for the present tuning
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting and saving
+ *
+ ********************************************************************/
+
+void REGULATOR_GetGains(uint16_t *kp, uint16_t *ki, uint16_t *tolerance)
+{
+    *kp = regulator_kp;
+    *ki = regulator_ki;
+    *tolerance = regulator_tolerance;
+}
+
+
+/*********************************************************************
+ * Function:        bool REGULATOR_Running(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          true while the loop owns the DAC
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Manual bias commands are refused while running
+ *
+ ********************************************************************/
+
+bool REGULATOR_Running(void)
+{
+    return regulator_running;
+}
+
+
+/*********************************************************************
+ * Function:        bool REGULATOR_Locked(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          true once the bias has stayed within tolerance
+ *                  for REGULATOR_LOCK_COUNT updates
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Lost as soon as one update is outside tolerance
+ *
+ ********************************************************************/
+
+bool REGULATOR_Locked(void)
+{
+    return regulator_locked;
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t REGULATOR_GetSetpoint(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Last setpoint, BIAS_ReadADC16() counts
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+uint16_t REGULATOR_GetSetpoint(void)
+{
+    uint16_t setpoint;
+
+    ENTER_CRITICAL(P);
+    setpoint = regulator_setpoint;
+    EXIT_CRITICAL(P);
+
+    return setpoint;
+}
+
+
+/*********************************************************************
+ * Function:        bool REGULATOR_LockChanged(bool *locked)
+ *
+ * PreCondition:    None
+ *
+ * Input:           locked - receives the new lock state
+ *
+ * Output:          true once after each change
+ *
+ * Side Effects:    Clears the change flag
+ *
+ * Overview:        Polled from the main loop for the UART notification
+ *
+ ********************************************************************/
+
+bool REGULATOR_LockChanged(bool *locked)
+{
+    bool changed;
+
+    ENTER_CRITICAL(L);
+    changed = regulator_lock_changed;
+    regulator_lock_changed = false;
+    *locked = regulator_locked;
+    EXIT_CRITICAL(L);
+
+    return changed;
+}
+
+
+/*********************************************************************
+ * Function:        static void REGULATOR_SetLocked(bool locked)
+ *
+ * PreCondition:    Interrupts off
+ *
+ * Input:           locked - new state
+ *
+ * Output:          None
+ *
+ * Side Effects:    Flags a change for REGULATOR_LockChanged()
+ *
+ * Overview:        Lock state with change detect
+ *
+ ********************************************************************/
+
+static void REGULATOR_SetLocked(bool locked)
+{
+    if(regulator_locked != locked)
+    {
+        regulator_locked = locked;
+        regulator_lock_changed = true;
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void REGULATOR_Tick(void)
+ *
+ * PreCondition:    System tick interrupt
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Writes the bias DAC while running
+ *
+ * Overview:        One PI update every REGULATOR_PERIOD ticks
+ *
+ ********************************************************************/
+
+static void REGULATOR_Tick(void)
+{
+    int32_t error, drive, proportional, integral_step;
+    uint16_t dac;
+
+    if(!regulator_running || (--regulator_countdown != 0))
+    {
+        return;
+    }
+    regulator_countdown = REGULATOR_PERIOD;
+
+    error = (int32_t)regulator_setpoint - BIAS_ReadADC16();                     // Positive: bias too low, more drive
+
+    if((error <= (int32_t)regulator_tolerance) && (error >= -(int32_t)regulator_tolerance))
+    {
+        if(regulator_in_tolerance < REGULATOR_LOCK_COUNT)
+        {
+            regulator_in_tolerance++;
+        }
+        else
+        {
+            REGULATOR_SetLocked(true);
+        }
+    }
+    else
+    {
+        regulator_in_tolerance = 0;
+        REGULATOR_SetLocked(false);
+    }
+
+    if(error > REGULATOR_ERROR_MAX)
+    {
+        error = REGULATOR_ERROR_MAX;
+    }
+    else if(error < -REGULATOR_ERROR_MAX)
+    {
+        error = -REGULATOR_ERROR_MAX;
+    }
+
+    proportional = error * regulator_kp;
+    if(proportional > REGULATOR_DRIVE_MAX)
+    {
+        proportional = REGULATOR_DRIVE_MAX;
+    }
+    else if(proportional < -REGULATOR_DRIVE_MAX)
+    {
+        proportional = -REGULATOR_DRIVE_MAX;
+    }
+
+    drive = regulator_integral + proportional;
+    if(!((drive >= REGULATOR_DRIVE_MAX) && (error > 0)) &&                      // No integration into saturation
+       !((drive <= 0) && (error < 0)))
+    {
+        integral_step = error * regulator_ki;
+        if(integral_step > REGULATOR_DRIVE_MAX)
+        {
+            integral_step = REGULATOR_DRIVE_MAX;
+        }
+        else if(integral_step < -REGULATOR_DRIVE_MAX)
+        {
+            integral_step = -REGULATOR_DRIVE_MAX;
+        }
+        regulator_integral += integral_step;
+        if(regulator_integral > REGULATOR_DRIVE_MAX)
+        {
+            regulator_integral = REGULATOR_DRIVE_MAX;
+        }
+        else if(regulator_integral < 0)
+        {
+            regulator_integral = 0;
+        }
+        drive = regulator_integral + proportional;
+    }
+
+    if(drive <= 0)
+    {
+        dac = BIAS_DAC_MAX;
+    }
+    else if(drive >= REGULATOR_DRIVE_MAX)
+    {
+        dac = 0;
+    }
+    else
+    {
+        dac = BIAS_DAC_MAX - (uint16_t)((drive + 0x8000) >> 16);
+    }
+    BIAS_SetDAC(dac);
+}
@@ -0,0 +1,40 @@
+/*********************************************************************
+ *
+ *              Water Monitor Bias Regulator Header
+ *
+ *********************************************************************
+ * FileName:        regulator.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * PI loop holding BIAS_READ (ADC0) at a setpoint by trimming the bias
+ * DAC.  Setpoint and tolerance are in BIAS_ReadADC16() counts, gains
+ * in DAC codes per count, 16 fractional bits.
+ *
+ ********************************************************************/
+
+#ifndef REGULATOR_H
+#define REGULATOR_H
+
+#include "mcc_generated_files/mcc.h"
+
+#define REGULATOR_PERIOD        4                                               // Ticks per update, 256Hz
+#define REGULATOR_LOCK_COUNT    32                                              // Updates in tolerance to lock, 125ms
+#define REGULATOR_KP_DEFAULT    1024                                            // 1/64 DAC code per count
+#define REGULATOR_KI_DEFAULT    128                                             // 1/512 DAC code per count per update
+#define REGULATOR_TOL_DEFAULT   64                                              // About 3mV at BIAS_READ
+
+void REGULATOR_Initialize(void);
+bool REGULATOR_Start(uint16_t setpoint);                                        // Bumpless from the present DAC value
+void REGULATOR_Stop(void);                                                      // DAC left where it is
+void REGULATOR_SetGains(uint16_t kp, uint16_t ki, uint16_t tolerance);
+void REGULATOR_GetGains(uint16_t *kp, uint16_t *ki, uint16_t *tolerance);
+bool REGULATOR_Running(void);
+bool REGULATOR_Locked(void);
+uint16_t REGULATOR_GetSetpoint(void);
+bool REGULATOR_LockChanged(bool *locked);                                       // True once per lock or unlock
+
+#endif /* REGULATOR_H */
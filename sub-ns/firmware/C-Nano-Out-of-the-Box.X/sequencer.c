@@ -0,0 +1,364 @@
+/*********************************************************************
+ *
+ *              Water Monitor Wavelength Sequencer
+ *
+ *********************************************************************
+ * FileName:        sequencer.c
+ * Dependencies:    sequencer.h, trigger.h, led.h, bias.h, systick.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * LED and bias only change while no trigger is going out:
+ *
+ * COUNT entries run as a hardware burst, the next entry starts from
+ * the burst end interrupt with the gate already closed.
+ *
+ * DWELL entries run the trigger free, the system tick counts the
+ * time down and then asks for a trigger blank, the next entry starts
+ * from the TCA0 interrupt while TRIG1 is held low, see TRIGGER_AtBlank.
+ *
+ ********************************************************************/
+
+#include "sequencer.h"
+#include "trigger.h"
+#include "led.h"
+#include "bias.h"
+#include "systick.h"
+
+static sequencer_entry_t sequencer_entries[SEQUENCER_ENTRIES];
+static uint8_t sequencer_length = 0;
+static volatile uint8_t sequencer_index = 0;
+static volatile bool sequencer_running = false;
+static volatile bool sequencer_done = false;
+static volatile uint32_t sequencer_dwell = 0;                                   // Ticks left, 0 when not counting
+static uint32_t sequencer_loops = 0;
+static uint32_t sequencer_loop = 0;
+
+static void SEQUENCER_Enter(void);
+static void SEQUENCER_Next(void);
+static void SEQUENCER_Tick(void);
+
+
+/*********************************************************************
+ * Function:        void SEQUENCER_Initialize(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Takes a system tick callback
+ *
+ * Overview:        Hooks the dwell timer into the tick
+ *
+ ********************************************************************/
+
+void SEQUENCER_Initialize(void)
+{
+    SYSTICK_AddCallback(SEQUENCER_Tick);
+}
+
+
+/*********************************************************************
+ * Function:        void SEQUENCER_Clear(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Stops a running sequence
+ *
+ * Overview:        Empties the entry list
+ *
+ ********************************************************************/
+
+void SEQUENCER_Clear(void)
+{
+    SEQUENCER_Stop();
+    sequencer_length = 0;
+}
+
+
+/*********************************************************************
+ * Function:        bool SEQUENCER_Add(const sequencer_entry_t *entry)
+ *
+ * PreCondition:    Sequence not running
+ *
+ * Input:           entry - LED, mode, amount and bias
+ *
+ * Output:          false if the list is full, running, or the entry
+ *                  is out of range
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Appends an entry
+ *
+ ********************************************************************/
+
+bool SEQUENCER_Add(const sequencer_entry_t *entry)
+{
+    if(sequencer_running || (sequencer_length >= SEQUENCER_ENTRIES))
+    {
+        return false;
+    }
+    if((entry->led > LED_COUNT) || (entry->amount == 0) ||
+       ((entry->mode == SEQUENCER_DWELL) && (entry->amount > SEQUENCER_DWELL_MAX)) ||
+       ((entry->mode != SEQUENCER_COUNT) && (entry->mode != SEQUENCER_DWELL)) ||
+       ((entry->bias > BIAS_DAC_MAX) && (entry->bias != BIAS_UNCHANGED)))
+    {
+        return false;
+    }
+    sequencer_entries[sequencer_length++] = *entry;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        uint8_t SEQUENCER_Length(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Number of entries
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+uint8_t SEQUENCER_Length(void)
+{
+    return sequencer_length;
+}
+
+
+/*********************************************************************
+ * Function:        bool SEQUENCER_Start(uint32_t loops)
+ *
+ * PreCondition:    Board active, trigger rate set
+ *
+ * Input:           loops - passes through the list, 0 = until stopped
+ *
+ * Output:          false if the list is empty
+ *
+ * Side Effects:    Takes over the trigger, LED and bias
+ *
+ * Overview:        Starts at the first entry
+ *
+ ********************************************************************/
+
+bool SEQUENCER_Start(uint32_t loops)
+{
+    if(sequencer_length == 0)
+    {
+        return false;
+    }
+    SEQUENCER_Stop();
+    TRIGGER_Pause();                                                            // First switch with nothing going out
+
+    sequencer_loops = loops;
+    sequencer_loop = 0;
+    sequencer_index = 0;
+    sequencer_done = false;
+    sequencer_running = true;
+    TRIGGER_SetBurstCallback(SEQUENCER_Next);
+
+    ENTER_CRITICAL(S);
+    SEQUENCER_Enter();
+    EXIT_CRITICAL(S);
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        void SEQUENCER_Stop(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Trigger paused and LEDs off if it was running
+ *
+ * Overview:        Abandons the sequence
+ *
+ ********************************************************************/
+
+void SEQUENCER_Stop(void)
+{
+    bool running;
+
+    ENTER_CRITICAL(T);
+    running = sequencer_running;
+    sequencer_running = false;
+    sequencer_dwell = 0;
+    TRIGGER_SetBurstCallback(NULL);
+    TRIGGER_AtBlank(NULL);
+    EXIT_CRITICAL(T);
+
+    if(running)
+    {
+        TRIGGER_Pause();
+        LED_Set(0);
+    }
+}
+
+
+/*********************************************************************
+ * Function:        bool SEQUENCER_Running(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          true while a sequence owns the trigger
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Manual commands are refused while running
+ *
+ ********************************************************************/
+
+bool SEQUENCER_Running(void)
+{
+    return sequencer_running;
+}
+
+
+/*********************************************************************
+ * Function:        bool SEQUENCER_Done(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          true once after the last loop finished
+ *
+ * Side Effects:    Clears the done flag
+ *
+ * Overview:        Polled from the main loop for the UART notification
+ *
+ ********************************************************************/
+
+bool SEQUENCER_Done(void)
+{
+    if(!sequencer_done)
+    {
+        return false;
+    }
+    sequencer_done = false;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        static void SEQUENCER_Enter(void)
+ *
+ * PreCondition:    Interrupts off, in the gap between triggers
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Switches LED and bias, starts the trigger
+ *
+ * Overview:        Runs the entry at sequencer_index
+ *
+ ********************************************************************/
+
+static void SEQUENCER_Enter(void)
+{
+    const sequencer_entry_t *entry = &sequencer_entries[sequencer_index];
+
+    LED_Set(entry->led);
+    if(entry->bias != BIAS_UNCHANGED)
+    {
+        BIAS_SetDAC(entry->bias);
+    }
+
+    if(entry->mode == SEQUENCER_COUNT)
+    {
+        sequencer_dwell = 0;
+        TRIGGER_StartBurst(entry->amount);                                      // Burst end calls SEQUENCER_Next
+    }
+    else
+    {
+        sequencer_dwell = SYSTICK_MS(entry->amount);
+        TRIGGER_Run();                                                          // No restart if already running
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static void SEQUENCER_Next(void)
+ *
+ * PreCondition:    Called from the burst end or trigger blank
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Moves to the next entry, or finishes
+ *
+ ********************************************************************/
+
+static void SEQUENCER_Next(void)
+{
+    if(!sequencer_running)
+    {
+        return;
+    }
+    if(++sequencer_index >= sequencer_length)
+    {
+        sequencer_index = 0;
+        sequencer_loop++;
+        if((sequencer_loops != 0) && (sequencer_loop >= sequencer_loops))
+        {
+            sequencer_running = false;
+            TRIGGER_SetBurstCallback(NULL);
+            TRIGGER_Pause();
+            LED_Set(0);
+            sequencer_done = true;
+            return;
+        }
+    }
+    SEQUENCER_Enter();
+}
+
+
+/*********************************************************************
+ * Function:        static void SEQUENCER_Tick(void)
+ *
+ * PreCondition:    System tick interrupt
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Dwell count down, the switch itself waits for a
+ *                  trigger blank
+ *
+ ********************************************************************/
+
+static void SEQUENCER_Tick(void)
+{
+    if(sequencer_running && (sequencer_dwell != 0))
+    {
+        if(--sequencer_dwell == 0)
+        {
+            TRIGGER_AtBlank(SEQUENCER_Next);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+/*********************************************************************
+ *
+ *              Water Monitor Wavelength Sequencer Header
+ *
+ *********************************************************************
+ * FileName:        sequencer.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Steps through a list of (LED, pulse count or dwell time, bias)
+ * entries without the host.  Runs from the trigger interrupts and
+ * the system tick.
+ *
+ ********************************************************************/
+
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include "mcc_generated_files/mcc.h"
+
+#define SEQUENCER_ENTRIES   16
+#define SEQUENCER_DWELL_MAX 4000000UL                                           // ms, keeps SYSTICK_MS in 32 bits
+
+typedef enum {SEQUENCER_COUNT, SEQUENCER_DWELL} sequencer_mode_t;
+
+typedef struct
+{
+    uint8_t led;                                                                // 0 to LED_COUNT
+    sequencer_mode_t mode;
+    uint32_t amount;                                                            // Pulses, or ms for DWELL
+    uint16_t bias;                                                              // DAC code, BIAS_UNCHANGED to keep
+} sequencer_entry_t;
+
+void SEQUENCER_Initialize(void);
+void SEQUENCER_Clear(void);
+bool SEQUENCER_Add(const sequencer_entry_t *entry);                             // False if full or invalid
+uint8_t SEQUENCER_Length(void);
+bool SEQUENCER_Start(uint32_t loops);                                           // 0 loops = until stopped
+void SEQUENCER_Stop(void);
+bool SEQUENCER_Running(void);
+bool SEQUENCER_Done(void);                                                      // True once when the loops finish
+
+#endif /* SEQUENCER_H */
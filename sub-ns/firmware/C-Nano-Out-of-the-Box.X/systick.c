@@ -0,0 +1,332 @@
+/*********************************************************************
+ *
+ *              Water Monitor System Tick
+ *
+ *********************************************************************
+ * FileName:        systick.c
+ * Dependencies:    systick.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * The RTC periodic interrupt timer is clocked from the internal 32.768kHz
+ * oscillator, so the tick is independent of the main clock and keeps
+ * running in standby sleep.  The RTC counter runs free from the same
+ * clock for timing shorter than a tick.  With a 32.768kHz crystal
+ * fitted the clock module moves both onto it.
+ *
+ * In standby with nothing counting ticks the PIT is slowed to 1Hz, so
+ * it stops waking the part every millisecond.  The ticks in between
+ * are made up from the RTC counter, on every read and interrupt, so
+ * SYSTICK_Get() keeps time either way.
+ *
+ ********************************************************************/
+
+#include "systick.h"
+#include "hal.h"
+
+static volatile uint32_t systick_count = 0;
+static void (*systick_callbacks[SYSTICK_CALLBACKS])(void);
+static volatile uint8_t systick_callback_count = 0;
+static volatile uint8_t systick_interrupts = 0;                                 // PIT interrupts, wraps
+static volatile bool systick_slow = false;
+static uint16_t systick_mark;                                                   // RTC counter at the last tick made up
+
+static void SYSTICK_Catch_Up(void);
+static uint8_t SYSTICK_Period(void);
+
+
+/*********************************************************************
+ * Function:        void SYSTICK_Initialize(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Enables RTC PIT interrupt
+ *
+ * Overview:        Starts the 1024Hz tick and the RTC counter
+ *
+ ********************************************************************/
+
+void SYSTICK_Initialize(void)
+{
+    SYSTICK_SetSource(RTC_CLKSEL_OSC32K_gc);                                    // 32.768kHz internal oscillator
+    RTC.PITINTCTRL = RTC_PI_bm;
+}
+
+
+/*********************************************************************
+ * Function:        void SYSTICK_SetSource(uint8_t clksel)
+ *
+ * PreCondition:    The new 32.768kHz source is running
+ *
+ * Input:           clksel - RTC_CLKSEL_OSC32K_gc or RTC_CLKSEL_XOSC32K_gc
+ *
+ * Output:          None
+ *
+ * Side Effects:    RTC counter and the tick in progress restart
+ *
+ * Overview:        The RTC only changes clock while it is stopped
+ *
+ ********************************************************************/
+
+void SYSTICK_SetSource(uint8_t clksel)
+{
+    RTC.PITCTRLA = 0;
+    RTC.CTRLA = 0;
+    while((RTC.PITSTATUS & RTC_CTRLBUSY_bm) || RTC.STATUS)                      // Wait for RTC and PIT synchronisation
+    {
+        ;
+    }
+    RTC.CLKSEL = clksel;
+    RTC.PER = 0xFFFF;
+    RTC.CTRLA = RTC_PRESCALER_DIV1_gc                                           // SYSTICK_FINE_HZ, wraps every 2s
+              | RTC_RUNSTDBY_bm
+              | RTC_RTCEN_bm;
+    systick_mark = RTC.CNT;
+    RTC.PITCTRLA = SYSTICK_Period()
+                 | RTC_PITEN_bm;
+}
+
+
+/*********************************************************************
+ * Function:        void SYSTICK_SetSlow(bool slow)
+ *
+ * PreCondition:    SYSTICK_Initialize()
+ *
+ * Input:           slow - true for a 1Hz PIT, false for the tick
+ *
+ * Output:          None
+ *
+ * Side Effects:    Waits for PIT synchronisation on a change, a few
+ *                  32.768kHz cycles
+ *
+ * Overview:        Only slow while no callback needs every tick,
+ *                  callbacks run once a second meanwhile
+ *
+ ********************************************************************/
+
+void SYSTICK_SetSlow(bool slow)
+{
+    if(slow == systick_slow)
+    {
+        return;
+    }
+    ENTER_CRITICAL(S);
+    if(slow)
+    {
+        systick_mark = RTC.CNT;
+    }
+    else
+    {
+        SYSTICK_Catch_Up();
+    }
+    systick_slow = slow;
+    EXIT_CRITICAL(S);
+
+    while(RTC.PITSTATUS & RTC_CTRLBUSY_bm)                                      // Writes while busy are ignored
+    {
+        ;
+    }
+    RTC.PITCTRLA = SYSTICK_Period()
+                 | RTC_PITEN_bm;
+}
+
+
+/*********************************************************************
+ * Function:        uint32_t SYSTICK_Get(void)
+ *
+ * PreCondition:    SYSTICK_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          Ticks since start-up
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Atomic read of the tick counter
+ *
+ ********************************************************************/
+
+uint32_t SYSTICK_Get(void)
+{
+    uint32_t ticks;
+
+    ENTER_CRITICAL(T);
+    if(systick_slow)
+    {
+        SYSTICK_Catch_Up();
+    }
+    ticks = systick_count;
+    EXIT_CRITICAL(T);
+
+    return ticks;
+}
+
+
+/*********************************************************************
+ * Function:        uint16_t SYSTICK_Fine(void)
+ *
+ * PreCondition:    SYSTICK_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          RTC counter, SYSTICK_FINE_HZ, wraps at 65536
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For measuring short intervals, subtract two reads
+ *
+ ********************************************************************/
+
+uint16_t SYSTICK_Fine(void)
+{
+    uint16_t count;
+
+    ENTER_CRITICAL(F);
+    count = RTC.CNT;                                                            // 16 bit read through TEMP
+    EXIT_CRITICAL(F);
+
+    return count;
+}
+
+
+/*********************************************************************
+ * Function:        bool SYSTICK_Expired(uint32_t start, uint32_t ticks)
+ *
+ * PreCondition:    SYSTICK_Initialize()
+ *
+ * Input:           start - tick value from SYSTICK_Get()
+ *                  ticks - period
+ *
+ * Output:          True once the period has passed
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Wrap safe timeout check
+ *
+ ********************************************************************/
+
+bool SYSTICK_Expired(uint32_t start, uint32_t ticks)
+{
+    return ((uint32_t)(SYSTICK_Get() - start) >= ticks);
+}
+
+
+/*********************************************************************
+ * Function:        uint8_t SYSTICK_Interrupts(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          PIT interrupt count, wraps at 256
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Compare two reads to see if the tick interrupted
+ *
+ ********************************************************************/
+
+uint8_t SYSTICK_Interrupts(void)
+{
+    return systick_interrupts;
+}
+
+
+/*********************************************************************
+ * Function:        bool SYSTICK_AddCallback(void (*callback)(void))
+ *
+ * PreCondition:    None
+ *
+ * Input:           callback - run every tick from the RTC PIT ISR
+ *
+ * Output:          False if all SYSTICK_CALLBACKS slots are taken
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Registers periodic work, keep callbacks short
+ *
+ ********************************************************************/
+
+bool SYSTICK_AddCallback(void (*callback)(void))
+{
+    if(systick_callback_count >= SYSTICK_CALLBACKS)
+    {
+        return false;
+    }
+    systick_callbacks[systick_callback_count] = callback;
+    systick_callback_count++;                                                   // Slot filled before ISR sees it
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        static void SYSTICK_Catch_Up(void)
+ *
+ * PreCondition:    Interrupts off, slow PIT
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Adds the whole ticks the RTC counter passed since
+ *                  the last call, under 2s apart so it can't wrap
+ *
+ ********************************************************************/
+
+static void SYSTICK_Catch_Up(void)
+{
+    uint16_t ticks = (uint16_t)(RTC.CNT - systick_mark) / (SYSTICK_FINE_HZ / SYSTICK_HZ);
+
+    systick_count += ticks;
+    systick_mark += ticks * (SYSTICK_FINE_HZ / SYSTICK_HZ);
+}
+
+
+/*********************************************************************
+ * Function:        static uint8_t SYSTICK_Period(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          PITCTRLA period for the current rate
+ *
+ * Side Effects:    None
+ *
+ * Overview:        32768 / 32 = 1024Hz, or 1Hz while slow
+ *
+ ********************************************************************/
+
+static uint8_t SYSTICK_Period(void)
+{
+    return systick_slow ? RTC_PERIOD_CYC32768_gc : RTC_PERIOD_CYC32_gc;
+}
+
+
+ISR(RTC_PIT_vect)
+{
+    uint8_t i;
+
+    HAL_ClearFlags(&RTC.PITINTFLAGS, RTC_PI_bm);
+    systick_interrupts++;
+    if(systick_slow)
+    {
+        SYSTICK_Catch_Up();
+    }
+    else
+    {
+        systick_count++;
+    }
+    for(i = 0; i < systick_callback_count; i++)
+    {
+        systick_callbacks[i]();
+    }
+}
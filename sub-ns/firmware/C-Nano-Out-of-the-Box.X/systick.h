@@ -0,0 +1,37 @@
+/*********************************************************************
+ *
+ *              Water Monitor System Tick Header
+ *
+ *********************************************************************
+ * FileName:        systick.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Free running tick from the RTC periodic interrupt (OSC32K / 32).
+ * Used for timeouts and housekeeping instead of _delay_ms().
+ *
+ ********************************************************************/
+
+#ifndef SYSTICK_H
+#define SYSTICK_H
+
+#include "mcc_generated_files/mcc.h"
+
+#define SYSTICK_HZ          1024UL                                              // 32.768kHz / 32
+#define SYSTICK_MS(ms)      ((uint32_t)(((uint32_t)(ms) * SYSTICK_HZ + 999UL) / 1000UL))
+#define SYSTICK_CALLBACKS   5                                                   // Periodic jobs run from the tick ISR
+#define SYSTICK_FINE_HZ     32768UL                                             // RTC counter rate
+
+void SYSTICK_Initialize(void);                                                  // Start RTC PIT tick
+void SYSTICK_SetSource(uint8_t clksel);                                         // OSC32K or a 32.768kHz crystal
+void SYSTICK_SetSlow(bool slow);                                                // 1Hz PIT while no tick user runs
+uint32_t SYSTICK_Get(void);                                                     // Ticks since start-up
+uint16_t SYSTICK_Fine(void);                                                    // RTC counter, 30.5us steps
+bool SYSTICK_Expired(uint32_t start, uint32_t ticks);                           // True once ticks passed since start
+uint8_t SYSTICK_Interrupts(void);                                               // PIT interrupt count, wraps
+bool SYSTICK_AddCallback(void (*callback)(void));                               // Called every tick, in interrupt context
+
+#endif /* SYSTICK_H */
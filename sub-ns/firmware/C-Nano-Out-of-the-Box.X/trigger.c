@@ -0,0 +1,1407 @@
+/*********************************************************************
+ *
+ *              Water Monitor Internal Trigger
+ *
+ *********************************************************************
+ * FileName:        trigger.c
+ * Dependencies:    trigger.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * Frequency synthesis for the internal trigger.  Every prescaler is
+ * tried in split mode, then in 16 bit mode, and the setting closest
+ * to the requested rate wins.  Ties keep split mode and the smallest
+ * prescaler, which gives the finest pulse width steps.
+ *
+ * Pulse width is the compare value, high for that many ticks.  It is
+ * kept across rate changes as ns, or as percent for a duty cycle.
+ *
+ * TCB0 and TCB1 cascade into a 32 bit pulse counter.  Normally they
+ * count rising edges on the TRIG1 pin itself:
+ *
+ *      PC3 pin                  -> CH2 -> TCB0 event count, low 16 bits
+ *      TCB0 OVF                 -> CH3 -> TCB1 cascade, high 16 bits
+ *
+ * Burst mode borrows them and gates the waveform with a CCL RS latch,
+ * all in hardware so the pulse count is exact at any rate:
+ *
+ *      TCA0 CMP0 (end of pulse) -> CH1 -> TCB0 event count, low 16 bits
+ *      TCB0 OVF                 -> CH3 -> TCB1 cascade, high 16 bits
+ *      TCB1 CAPT (N reached)    -> CH4 -> LUT3 = latch reset
+ *      software event           -> CH5 -> LUT2 = latch set
+ *      LUT1 = TCA0 WO0 AND latch (LINK) -> PC3
+ *
+ * TCB0 starts at -N so its first overflow comes after N mod 65536
+ * pulses, TCB1 then fires after ceil(N / 65536) overflows.  Pulses
+ * counted by each hardware setup are folded into count_offset before
+ * the TCBs are reprogrammed, so the total never loses a pulse.
+ *
+ * Sync runs in hardware too.  A master routes the TRIG1 pin event,
+ * already on CH2 for the counter, to EVOUTA.  A slave restarts TCA0
+ * from SYNC_IN on CH0, so every master pulse re-phases it.  The slave
+ * period is made SYNC_MARGIN longer than the rate asks for, so the
+ * restart always comes before its own wrap and it never doubles a
+ * pulse.  The slave delay moves the pulse inside the period:
+ *
+ *      CMP2 = delay, CMP0 = delay + width
+ *      LUT1 = TCA0 WO0 AND NOT TCA0 WO2 -> PC3
+ *
+ * so CMP0 still marks the end of the pulse for bursts.  With no delay LUT1 is WO0 alone as before.
+ *
+ * A blank holds TRIG1 low for whole periods without stopping TCA0,
+ * for output enables to change under.  The compare is set for no high
+ * ticks, CMP0BUF = CMP2 in 16 bit mode and HCMP0 = 0 in split mode,
+ * which the timer only acts on from the next period.  The interrupt
+ * at the first blank period (CMP0, or HUNF in split mode) runs the
+ * callback, then the compare is put back for the period after.  The
+ * hardware keeps the blank however late the interrupt is, so pulses
+ * are skipped at high rates but never cut short.  HCMP0 has no
+ * buffer, so a split mode width change goes through a blank as well.
+ *
+ ********************************************************************/
+
+#include "trigger.h"
+#include "hal.h"
+
+#define TRIGGER_DIVIDERS    8
+#define SPLIT_PERIOD_MAX    256UL
+#define SINGLE_PERIOD_MAX   65536UL
+#define BURST_WORD          65536UL                                             // Pulses per TCB0 overflow
+#define SYNC_MARGIN(period) ((period) / 64 + 1)                                 // Slave waits 1.6% longer for SYNC_IN
+
+static const uint16_t trigger_dividers[TRIGGER_DIVIDERS] = {1, 2, 4, 8, 16, 64, 256, 1024};
+
+static uint32_t trigger_clock = F_CPU;                                          // TCA0 runs from CLK_PER
+
+static trigger_config_t trigger_config =                                        // 'S' until a rate is set
+{
+    TRIGGER_SPLIT, TCA_SPLIT_CLKSEL_DIV64_gc, 64, 251, 125
+};
+static trigger_width_t trigger_width_unit = TRIGGER_WIDTH_PERCENT;             // Requested width, ticks kept as ns
+static uint32_t trigger_width = 50;
+static volatile bool burst_done = false;                                        // Set by TCB1 ISR
+static volatile bool burst_active = false;
+static uint32_t burst_count = 0;
+static volatile uint32_t count_offset = 0;                                      // Pulses before the current TCB setup
+static void (*volatile burst_callback)(void) = NULL;                            // Replaces burst_done when set
+static void (*volatile blank_callback)(void) = NULL;
+static volatile bool blank_armed = false;                                       // Compare holds the blank value
+static uint32_t count_zero = 0;                                                 // Total at the last reset
+static trigger_sync_t trigger_sync = TRIGGER_SYNC_OFF;
+static uint32_t trigger_delay = 0;                                              // Requested slave delay, ns
+static uint16_t trigger_delay_ticks = 0;                                        // As loaded into CMP2
+
+static void TRIGGER_Apply(bool start);
+static void TRIGGER_Update_Compare(void);
+static void TRIGGER_Burst_Off(void);
+static void TRIGGER_Count_Mode(void);
+static uint32_t TRIGGER_Count_Hardware(void);
+static uint64_t TRIGGER_Millihertz(uint32_t ticks);
+static uint32_t TRIGGER_Ns_To_Ticks(uint32_t ns);
+static void TRIGGER_Sync_Route(void);
+static uint16_t TRIGGER_Delay_Ticks(void);
+static void TRIGGER_Blank_Start(void);
+static void TRIGGER_Blank_Done(bool restore);
+
+
+/*********************************************************************
+ * Function:        bool TRIGGER_SetFrequency(uint32_t hz)
+ *
+ * PreCondition:    None
+ *
+ * Input:           hz - requested trigger rate
+ *
+ * Output:          false if hz is outside TRIGGER_MIN_HZ..TRIGGER_MAX_HZ
+ *
+ * Side Effects:    TCA0 restarted, pulse width kept
+ *
+ * Overview:        Searches prescaler, period and mode for the rate
+ *
+ ********************************************************************/
+
+bool TRIGGER_SetFrequency(uint32_t hz)
+{
+    trigger_config_t best = trigger_config;
+    uint64_t best_error = UINT64_MAX;
+    uint64_t ticks, target, achieved, error;
+    uint32_t period, period_max;
+    uint8_t mode, i;
+
+    if((hz < TRIGGER_MIN_HZ) || (hz > TRIGGER_MAX_HZ))
+    {
+        return false;
+    }
+    target = (uint64_t)hz * 1000;
+
+    for(mode = TRIGGER_SPLIT; mode <= TRIGGER_16BIT; mode++)
+    {
+        period_max = (mode == TRIGGER_SPLIT) ? SPLIT_PERIOD_MAX : SINGLE_PERIOD_MAX;
+        for(i = 0; i < TRIGGER_DIVIDERS; i++)
+        {
+            ticks = (uint64_t)hz * trigger_dividers[i];
+            period = (trigger_clock + ticks / 2) / ticks;                       // Rounded
+            if(period < 2)
+            {
+                break;                                                          // Larger prescalers only get worse
+            }
+            if(period > period_max)
+            {
+                continue;
+            }
+            achieved = TRIGGER_Millihertz((uint32_t)trigger_dividers[i] * period);
+            error = (achieved > target) ? (achieved - target) : (target - achieved);
+            if(error < best_error)
+            {
+                best_error = error;
+                best.mode = mode;
+                best.clksel = i << 1;                                           // CLKSEL_DIVx_gc in prescaler order
+                best.divider = trigger_dividers[i];
+                best.period = period;
+            }
+        }
+    }
+
+    trigger_config = best;
+    TRIGGER_Update_Compare();
+    TRIGGER_Apply(true);
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        void TRIGGER_SetPreset(uint8_t speed)
+ *
+ * PreCondition:    None
+ *
+ * Input:           speed - S (1.5kHz) or F (8MHz)
+ *
+ * Output:          None
+ *
+ * Side Effects:    TCA0 restarted
+ *
+ * Overview:        The original TCA0_init settings, kept so 'RS' and
+ *                  'RF' give exactly the same waveform as before
+ *
+ ********************************************************************/
+
+void TRIGGER_SetPreset(uint8_t speed)
+{
+    trigger_config.mode = TRIGGER_SPLIT;
+    if(speed == 'S')
+    {
+        trigger_config.clksel = TCA_SPLIT_CLKSEL_DIV64_gc;                      // HPER = 250, HCMP0 = 125
+        trigger_config.divider = 64;
+        trigger_config.period = 251;
+    }
+    else
+    {
+        trigger_config.clksel = TCA_SPLIT_CLKSEL_DIV1_gc;                       // HPER = 2, HCMP0 = 1
+        trigger_config.divider = 1;
+        trigger_config.period = 3;
+    }
+    TRIGGER_Update_Compare();
+    TRIGGER_Apply(true);
+}
+
+
+/*********************************************************************
+ * Function:        bool TRIGGER_SetWidth(trigger_width_t unit, uint32_t value)
+ *
+ * PreCondition:    A rate has been set
+ *
+ * Input:           unit - ticks of the current prescaler, ns or percent
+ *                  value - width in that unit
+ *
+ * Output:          false if the width rounds to less than one tick or
+ *                  leaves less than one tick low
+ *
+ * Side Effects:    Compare register updated, timer keeps running.
+ *                  Running in split mode it skips a pulse, HCMP0 has
+ *                  no buffer so the blank writes it
+ *
+ * Overview:        Sets pulse width independent of the period
+ *
+ ********************************************************************/
+
+bool TRIGGER_SetWidth(trigger_width_t unit, uint32_t value)
+{
+    uint32_t ticks;
+
+    switch(unit)
+    {
+        case TRIGGER_WIDTH_TICKS:
+            ticks = value;
+            break;
+        case TRIGGER_WIDTH_NS:
+            ticks = TRIGGER_Ns_To_Ticks(value);
+            break;
+        default:
+            if(value > 100)
+            {
+                return false;
+            }
+            ticks = (trigger_config.period * value) / 100;
+            break;
+    }
+    if((ticks < 1) || (ticks >= trigger_config.period - trigger_delay_ticks))
+    {
+        return false;
+    }
+
+    ENTER_CRITICAL(W);
+    trigger_config.compare = ticks;                                             // Read by the blank interrupt
+    if((TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm) && !blank_armed)              // A blank puts it back when done
+    {
+        if(trigger_config.mode == TRIGGER_SPLIT)
+        {
+            if(!burst_active)
+            {
+                TRIGGER_Blank_Start();                                          // No buffer, HUNF writes HCMP0
+            }
+        }
+        else
+        {
+            TCA0.SINGLE.CMP0BUF = ticks + trigger_delay_ticks;                  // Takes effect at next UPDATE
+        }
+    }
+    EXIT_CRITICAL(W);
+
+    if(unit == TRIGGER_WIDTH_PERCENT)
+    {
+        trigger_width_unit = TRIGGER_WIDTH_PERCENT;                             // Duty follows the period
+        trigger_width = value;
+    }
+    else
+    {
+        trigger_width_unit = TRIGGER_WIDTH_NS;                                  // Width stays fixed
+        trigger_width = TRIGGER_GetWidthNs();
+    }
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        uint32_t TRIGGER_GetWidthNs(void)
+ *
+ * PreCondition:    A rate has been set
+ *
+ * Input:           None
+ *
+ * Output:          Pulse width in ns, rounded
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Width actually applied, a whole number of ticks
+ *
+ ********************************************************************/
+
+uint32_t TRIGGER_GetWidthNs(void)
+{
+    uint64_t ticks = (uint64_t)trigger_config.compare * trigger_config.divider;
+
+    return (ticks * 1000000000ULL + trigger_clock / 2) / trigger_clock;
+}
+
+
+/*********************************************************************
+ * Function:        bool TRIGGER_StartBurst(uint32_t pulses)
+ *
+ * PreCondition:    A rate has been set
+ *
+ * Input:           pulses - 1 to 2^32 - 1
+ *
+ * Output:          false if pulses is 0
+ *
+ * Side Effects:    TCA0 restarted in 16 bit mode, same waveform
+ *
+ * Overview:        Emits exactly pulses triggers at the current rate and
+ *                  width, then TRIG1 stays low.  TRIGGER_BurstDone
+ *                  reports the end
+ *
+ ********************************************************************/
+
+bool TRIGGER_StartBurst(uint32_t pulses)
+{
+    if(pulses == 0)
+    {
+        return false;
+    }
+    trigger_config.mode = TRIGGER_16BIT;                                        // Split period fits, CCL needs WO0
+    TRIGGER_Apply(false);                                                       // Held while the gate is armed
+
+    ENTER_CRITICAL(S);
+    count_offset += TRIGGER_Count_Hardware();                                   // TCA0 stopped, nothing to count
+    EXIT_CRITICAL(S);
+    burst_count = pulses;
+    burst_done = false;
+
+    EVSYS.CHANNEL1 = EVSYS_CHANNEL1_TCA0_CMP0_LCMP0_gc;
+    EVSYS.CHANNEL4 = EVSYS_CHANNEL4_TCB1_CAPT_gc;
+    EVSYS.CHANNEL5 = EVSYS_CHANNEL_OFF_gc;                                      // Software event only
+    EVSYS.USERTCB0COUNT = EVSYS_USER_CHANNEL1_gc;
+    EVSYS.USERCCLLUT3A = EVSYS_USER_CHANNEL4_gc;
+    EVSYS.USERCCLLUT2A = EVSYS_USER_CHANNEL5_gc;
+
+    TCB0.CTRLA = 0;
+    TCB1.CTRLA = 0;
+    TCB0.CNT = (uint16_t)(0 - pulses);                                          // First overflow after N mod 65536
+    TCB1.CCMP = (pulses - 1) / BURST_WORD;                                      // CAPT on overflow ceil(N / 65536)
+    TCB1.CNT = 0;
+    HAL_ClearFlags(&TCB1.INTFLAGS, TCB_CAPT_bm);
+    TCB1.INTCTRL = TCB_CAPT_bm;
+    burst_active = true;
+    TCB1.CTRLA = TCB_CLKSEL_EVENT_gc | TCB_CASCADE_bm | TCB_ENABLE_bm;
+    TCB0.CTRLA = TCB_CLKSEL_EVENT_gc | TCB_ENABLE_bm;
+
+    CCL.CTRLA = 0;
+    CCL.SEQCTRL1 = CCL_SEQSEL_RS_gc;                                            // LUT2 set, LUT3 reset, out on LUT2
+    CCL.LUT2CTRLB = CCL_INSEL0_EVENTA_gc | CCL_INSEL1_MASK_gc;
+    CCL.LUT2CTRLC = CCL_INSEL2_MASK_gc;
+    CCL.TRUTH2 = 0x02;                                                          // OUT = IN0
+    CCL.LUT2CTRLA = CCL_ENABLE_bm;                                              // No OUTEN, PD3 is CLK_SEL
+    CCL.LUT3CTRLB = CCL_INSEL0_EVENTA_gc | CCL_INSEL1_MASK_gc;
+    CCL.LUT3CTRLC = CCL_INSEL2_MASK_gc;
+    CCL.TRUTH3 = 0x02;
+    CCL.LUT3CTRLA = CCL_ENABLE_bm;                                              // No OUTEN, PF3 is OE3
+    CCL.LUT1CTRLB = CCL_INSEL0_TCA0_gc | CCL_INSEL1_LINK_gc;
+    CCL.TRUTH1 = 0x08;                                                          // OUT = IN0 AND IN1
+    CCL.CTRLA = CCL_ENABLE_bm;
+
+    EVSYS.SWEVENTA = EVSYS_SWEVENTA_CH5_gc;                                     // Open the gate
+
+    TCA0.SINGLE.CNT = TCA0.SINGLE.PER;                                          // First pulse starts on the next tick
+    TCA0.SINGLE.CTRLA = trigger_config.clksel
+                      | TCA_SINGLE_ENABLE_bm;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        void TRIGGER_SetBurstCallback(void (*callback)(void))
+ *
+ * PreCondition:    None
+ *
+ * Input:           callback - NULL for the TRIGGER_BurstDone flag
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Lets the sequencer chain bursts from the burst end
+ *                  interrupt, callback may start the next burst
+ *
+ ********************************************************************/
+
+void TRIGGER_SetBurstCallback(void (*callback)(void))
+{
+    burst_callback = callback;
+}
+
+
+/*********************************************************************
+ * Function:        void TRIGGER_AtBlank(void (*callback)(void))
+ *
+ * PreCondition:    None
+ *
+ * Input:           callback - NULL cancels
+ *
+ * Output:          None
+ *
+ * Side Effects:    Skips at least one trigger pulse.  Replaces a
+ *                  callback still waiting
+ *
+ * Overview:        Calls callback while TRIG1 is held low for a whole
+ *                  period, from the TCA0 interrupt, see the blank in
+ *                  the description.  Stopped, it is called at once.
+ *                  In a burst it waits for the burst end, a blank
+ *                  would still count as a pulse
+ *
+ ********************************************************************/
+
+void TRIGGER_AtBlank(void (*callback)(void))
+{
+    ENTER_CRITICAL(B);
+    blank_callback = callback;
+    if(callback == NULL)
+    {
+        TRIGGER_Blank_Done(true);                                               // Just the compare back
+    }
+    else if(!(TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm))
+    {
+        TRIGGER_Blank_Done(false);
+    }
+    else if(!blank_armed && !burst_active)
+    {
+        TRIGGER_Blank_Start();
+    }
+    EXIT_CRITICAL(B);
+}
+
+
+/*********************************************************************
+ * Function:        void TRIGGER_SetClock(uint32_t hz)
+ *
+ * PreCondition:    None
+ *
+ * Input:           hz - new CLK_PER
+ *
+ * Output:          None
+ *
+ * Side Effects:    A free running trigger is searched again for the
+ *                  same whole Hz, or stopped if the new clock can't
+ *                  reach it.  A burst in progress is stopped
+ *
+ * Overview:        Call after every system clock change.  A stopped
+ *                  setting is kept in ticks, it is only ever started
+ *                  again at the clock it was made for
+ *
+ ********************************************************************/
+
+void TRIGGER_SetClock(uint32_t hz)
+{
+    uint32_t rate;
+
+    if(hz == trigger_clock)
+    {
+        return;
+    }
+    if(burst_active)
+    {
+        TRIGGER_Stop();
+    }
+    if(!(TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm))
+    {
+        trigger_clock = hz;
+        return;
+    }
+
+    rate = TRIGGER_GetFrequency(NULL);
+    trigger_clock = hz;
+    if(!TRIGGER_SetFrequency(rate))
+    {
+        TRIGGER_Stop();
+    }
+}
+
+
+/*********************************************************************
+ * Function:        uint32_t TRIGGER_GetClock(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          TCA0 clock in Hz before the prescaler
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For range checks
+ *
+ ********************************************************************/
+
+uint32_t TRIGGER_GetClock(void)
+{
+    return trigger_clock;
+}
+
+
+/*********************************************************************
+ * Function:        bool TRIGGER_SetSync(trigger_sync_t sync, uint32_t delay_ns)
+ *
+ * PreCondition:    None
+ *
+ * Input:           sync - off, master or slave
+ *                  delay_ns - slave pulse delay after SYNC_IN, the
+ *                  input synchroniser adds two or three CLK_PER
+ *                  cycles to every delay
+ *
+ * Output:          false during a burst, or if the delay and pulse
+ *                  width don't fit the period, nothing changed
+ *
+ * Side Effects:    A running trigger is restarted, a slave goes to
+ *                  16 bit mode
+ *
+ * Overview:        Sets this board's part on the sync line
+ *
+ ********************************************************************/
+
+bool TRIGGER_SetSync(trigger_sync_t sync, uint32_t delay_ns)
+{
+    trigger_sync_t old_sync = trigger_sync;
+    uint32_t old_delay = trigger_delay;
+
+    if((sync > TRIGGER_SYNC_SLAVE) || burst_active)
+    {
+        return false;
+    }
+    trigger_sync = sync;
+    trigger_delay = delay_ns;
+    if((sync == TRIGGER_SYNC_SLAVE) &&
+       (TRIGGER_Ns_To_Ticks(delay_ns) >= trigger_config.period - trigger_config.compare))
+    {
+        trigger_sync = old_sync;
+        trigger_delay = old_delay;
+        return false;
+    }
+
+    TRIGGER_Sync_Route();
+    if(TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm)
+    {
+        TRIGGER_Apply(true);
+    }
+    else
+    {
+        trigger_delay_ticks = TRIGGER_Delay_Ticks();
+    }
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        trigger_sync_t TRIGGER_GetSync(uint32_t *delay_ns)
+ *
+ * PreCondition:    None
+ *
+ * Input:           delay_ns - receives the slave delay, may be NULL
+ *
+ * Output:          Sync role
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Delay actually applied, a whole number of ticks
+ *
+ ********************************************************************/
+
+trigger_sync_t TRIGGER_GetSync(uint32_t *delay_ns)
+{
+    uint64_t ticks = (uint64_t)trigger_delay_ticks * trigger_config.divider;
+
+    if(delay_ns != NULL)
+    {
+        *delay_ns = (ticks * 1000000000ULL + trigger_clock / 2) / trigger_clock;
+    }
+    return trigger_sync;
+}
+
+
+/*********************************************************************
+ * Function:        void TRIGGER_Run(void)
+ *
+ * PreCondition:    A rate has been set
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Ends a burst
+ *
+ * Overview:        Free running trigger in 16 bit mode, the same
+ *                  waveform as split mode but with a CMP0 interrupt.
+ *                  Left alone if already running that way
+ *
+ ********************************************************************/
+
+void TRIGGER_Run(void)
+{
+    if((trigger_config.mode == TRIGGER_16BIT) && !burst_active &&
+       (TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm))
+    {
+        return;
+    }
+    trigger_config.mode = TRIGGER_16BIT;
+    TRIGGER_Apply(true);
+}
+
+
+/*********************************************************************
+ * Function:        void TRIGGER_Pause(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Ends a burst, TRIG1 low
+ *
+ * Overview:        Stops TCA0 but keeps the rate setting
+ *
+ ********************************************************************/
+
+void TRIGGER_Pause(void)
+{
+    TRIGGER_Apply(false);
+}
+
+
+/*********************************************************************
+ * Function:        bool TRIGGER_BurstDone(uint32_t *pulses)
+ *
+ * PreCondition:    None
+ *
+ * Input:           pulses - receives the burst length
+ *
+ * Output:          true once after each completed burst
+ *
+ * Side Effects:    Clears the done flag
+ *
+ * Overview:        Polled from the main loop for the UART notification
+ *
+ ********************************************************************/
+
+bool TRIGGER_BurstDone(uint32_t *pulses)
+{
+    if(!burst_done)
+    {
+        return false;
+    }
+    burst_done = false;
+    *pulses = burst_count;
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        void TRIGGER_Initialize(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    TCB0, TCB1 and EVSYS channels 2, 3 claimed
+ *
+ * Overview:        Starts the pulse counter, runs from power up
+ *
+ ********************************************************************/
+
+void TRIGGER_Initialize(void)
+{
+    EVSYS.CHANNEL2 = EVSYS_CHANNEL2_PORTC_PIN3_gc;                              // TRIG1 pin, whatever drives it
+    EVSYS.CHANNEL3 = EVSYS_CHANNEL3_TCB0_OVF_gc;
+    EVSYS.USERTCB1COUNT = EVSYS_USER_CHANNEL3_gc;
+    TRIGGER_Count_Mode();
+}
+
+
+/*********************************************************************
+ * Function:        uint32_t TRIGGER_GetCount(bool reset)
+ *
+ * PreCondition:    TRIGGER_Initialize called
+ *
+ * Input:           reset - start counting from zero again
+ *
+ * Output:          Pulses on TRIG1 since start-up or the last reset,
+ *                  wraps at 2^32
+ *
+ * Side Effects:    None
+ *
+ * Overview:        The hardware counters keep running, a reset only
+ *                  moves the zero point, so no pulse is lost between
+ *                  the read and the reset
+ *
+ ********************************************************************/
+
+uint32_t TRIGGER_GetCount(bool reset)
+{
+    uint32_t total, count;
+
+    ENTER_CRITICAL(C);
+    total = count_offset + TRIGGER_Count_Hardware();
+    count = total - count_zero;
+    if(reset)
+    {
+        count_zero = total;
+    }
+    EXIT_CRITICAL(C);
+
+    return count;
+}
+
+
+/*********************************************************************
+ * Function:        void TRIGGER_Stop(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    TRIG1 = PC3 back to port control, low
+ *
+ * Overview:        Stops TCA0, the CCL route and any burst
+ *
+ ********************************************************************/
+
+void TRIGGER_Stop(void)
+{
+    TCA0.SINGLE.CTRLA = 0;
+    TCA0.SINGLE.CTRLB = 0;                                                      // Also clears HCMP0EN in split mode
+    TRIGGER_Burst_Off();
+    CCL.LUT1CTRLA = 0;
+    HAL_PinClear(&PORTC, PIN3_bm);
+    TRIGGER_Blank_Done(false);                                                  // TRIG1 low, a waiting change can go
+}
+
+
+/*********************************************************************
+ * Function:        void TRIGGER_GetState(trigger_state_t *state)
+ *
+ * PreCondition:    None
+ *
+ * Input:           state - receives the settings
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Timer setting, requested width and whether the
+ *                  trigger is free running, for saving
+ *
+ ********************************************************************/
+
+void TRIGGER_GetState(trigger_state_t *state)
+{
+    state->timer = trigger_config;
+    state->width_unit = trigger_width_unit;
+    state->width = trigger_width;
+    state->running = !burst_active && (TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm);
+    state->sync = trigger_sync;
+    state->delay = trigger_delay;
+}
+
+
+/*********************************************************************
+ * Function:        bool TRIGGER_SetState(const trigger_state_t *state)
+ *
+ * PreCondition:    None
+ *
+ * Input:           state - from TRIGGER_GetState(), maybe stored
+ *
+ * Output:          false if the state could not have come from
+ *                  TRIGGER_GetState(), nothing changed
+ *
+ * Side Effects:    TCA0 restarted or stopped
+ *
+ * Overview:        Restores a saved trigger without a new search
+ *
+ ********************************************************************/
+
+bool TRIGGER_SetState(const trigger_state_t *state)
+{
+    const trigger_config_t *timer = &state->timer;
+    uint8_t i;
+
+    for(i = 0; (i < TRIGGER_DIVIDERS) && (trigger_dividers[i] != timer->divider); i++)
+    {
+        ;
+    }
+    if((i == TRIGGER_DIVIDERS) || (timer->clksel != (i << 1)) ||
+       (timer->mode > TRIGGER_16BIT) || (timer->period < 2) ||
+       (timer->period > ((timer->mode == TRIGGER_SPLIT) ? SPLIT_PERIOD_MAX : SINGLE_PERIOD_MAX)) ||
+       (timer->compare < 1) || (timer->compare >= timer->period) ||
+       ((state->width_unit != TRIGGER_WIDTH_NS) && (state->width_unit != TRIGGER_WIDTH_PERCENT)) ||
+       (state->sync > TRIGGER_SYNC_SLAVE))
+    {
+        return false;
+    }
+
+    trigger_config = *timer;
+    trigger_width_unit = state->width_unit;
+    trigger_width = state->width;
+    trigger_sync = state->sync;
+    trigger_delay = state->delay;                                               // Limited to the gap when applied
+    trigger_delay_ticks = TRIGGER_Delay_Ticks();
+    TRIGGER_Sync_Route();
+    if(state->running)
+    {
+        TRIGGER_Apply(true);
+    }
+    else
+    {
+        TRIGGER_Stop();
+    }
+    return true;
+}
+
+
+/*********************************************************************
+ * Function:        const trigger_config_t *TRIGGER_GetConfig(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          Current timer setting
+ *
+ * Side Effects:    None
+ *
+ * Overview:        For reporting
+ *
+ ********************************************************************/
+
+const trigger_config_t *TRIGGER_GetConfig(void)
+{
+    return &trigger_config;
+}
+
+
+/*********************************************************************
+ * Function:        uint32_t TRIGGER_GetFrequency(uint16_t *millihertz)
+ *
+ * PreCondition:    A rate has been set
+ *
+ * Input:           millihertz - receives the fractional part, may be NULL
+ *
+ * Output:          Achieved rate in whole Hz
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Exact rate from the prescaler and period in use
+ *
+ ********************************************************************/
+
+uint32_t TRIGGER_GetFrequency(uint16_t *millihertz)
+{
+    uint64_t achieved = TRIGGER_Millihertz((uint32_t)trigger_config.divider * trigger_config.period);
+
+    if(millihertz != NULL)
+    {
+        *millihertz = achieved % 1000;
+    }
+    return achieved / 1000;
+}
+
+
+/*********************************************************************
+ * Function:        int32_t TRIGGER_GetErrorPpm(uint32_t hz)
+ *
+ * PreCondition:    A rate has been set
+ *
+ * Input:           hz - rate that was asked for
+ *
+ * Output:          (achieved - hz) / hz in parts per million
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Synthesis error report
+ *
+ ********************************************************************/
+
+int32_t TRIGGER_GetErrorPpm(uint32_t hz)
+{
+    int64_t achieved = TRIGGER_Millihertz((uint32_t)trigger_config.divider * trigger_config.period);
+    int64_t target = (int64_t)hz * 1000;
+
+    return ((achieved - target) * 1000000) / target;
+}
+
+
+/*********************************************************************
+ * Function:        static void TRIGGER_Update_Compare(void)
+ *
+ * PreCondition:    trigger_config period and prescaler set
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Requested width in ticks for a new rate, limited to
+ *                  1 to period - 1 ticks so the output still toggles
+ *
+ ********************************************************************/
+
+static void TRIGGER_Update_Compare(void)
+{
+    uint32_t ticks;
+
+    if(trigger_width_unit == TRIGGER_WIDTH_PERCENT)
+    {
+        ticks = (trigger_config.period * trigger_width) / 100;                  // 50% gives the original HPER / 2
+    }
+    else
+    {
+        ticks = TRIGGER_Ns_To_Ticks(trigger_width);
+    }
+    if(ticks < 1)
+    {
+        ticks = 1;
+    }
+    else if(ticks >= trigger_config.period)
+    {
+        ticks = trigger_config.period - 1;
+    }
+    trigger_config.compare = ticks;
+}
+
+
+/*********************************************************************
+ * Function:        static uint32_t TRIGGER_Ns_To_Ticks(uint32_t ns)
+ *
+ * PreCondition:    None
+ *
+ * Input:           ns - time
+ *
+ * Output:          Ticks of the current prescaler, rounded
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Saturates rather than wrapping for huge widths
+ *
+ ********************************************************************/
+
+static uint32_t TRIGGER_Ns_To_Ticks(uint32_t ns)
+{
+    uint64_t scale = (uint64_t)trigger_config.divider * 1000000000ULL;
+    uint64_t ticks = ((uint64_t)ns * trigger_clock + scale / 2) / scale;
+
+    return (ticks > UINT32_MAX) ? UINT32_MAX : ticks;
+}
+
+
+/*********************************************************************
+ * Function:        static void TRIGGER_Sync_Route(void)
+ *
+ * PreCondition:    TRIGGER_Initialize()
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    EVSYS channel 0 claimed by a slave
+ *
+ * Overview:        SYNC_OUT and SYNC_IN for trigger_sync, the TCA0
+ *                  event input itself is set in TRIGGER_Apply
+ *
+ ********************************************************************/
+
+static void TRIGGER_Sync_Route(void)
+{
+    if(trigger_sync == TRIGGER_SYNC_MASTER)
+    {
+        HAL_PinClear(&PORTA, PIN2_bm);
+        HAL_PinOutput(&PORTA, PIN2_bm);                                         // SYNC_OUT = PA2
+        EVSYS.USEREVSYSEVOUTA = EVSYS_USER_CHANNEL2_gc;                         // TRIG1 pin event
+    }
+    else
+    {
+        EVSYS.USEREVSYSEVOUTA = EVSYS_USER_OFF_gc;
+        HAL_PinInput(&PORTA, PIN2_bm);
+    }
+    if(trigger_sync == TRIGGER_SYNC_SLAVE)
+    {
+        EVSYS.CHANNEL0 = EVSYS_CHANNEL0_PORTA_PIN3_gc;                          // SYNC_IN = PA3
+        EVSYS.USERTCA0CNTB = EVSYS_USER_CHANNEL0_gc;
+    }
+    else
+    {
+        EVSYS.USERTCA0CNTB = EVSYS_USER_OFF_gc;
+        EVSYS.CHANNEL0 = EVSYS_CHANNEL_OFF_gc;
+    }
+}
+
+
+/*********************************************************************
+ * Function:        static uint16_t TRIGGER_Delay_Ticks(void)
+ *
+ * PreCondition:    trigger_config period, prescaler and compare set
+ *
+ * Input:           None
+ *
+ * Output:          Slave delay in ticks, 0 when not a slave
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Limited so the pulse still ends inside the period,
+ *                  a rate or width change can shrink the gap
+ *
+ ********************************************************************/
+
+static uint16_t TRIGGER_Delay_Ticks(void)
+{
+    uint32_t ticks;
+
+    if(trigger_sync != TRIGGER_SYNC_SLAVE)
+    {
+        return 0;
+    }
+    ticks = TRIGGER_Ns_To_Ticks(trigger_delay);
+    if(ticks >= trigger_config.period - trigger_config.compare)
+    {
+        ticks = trigger_config.period - trigger_config.compare - 1;
+    }
+    return ticks;
+}
+
+
+/*********************************************************************
+ * Function:        static uint64_t TRIGGER_Millihertz(uint32_t ticks)
+ *
+ * PreCondition:    None
+ *
+ * Input:           ticks - CLK_PER cycles per trigger
+ *
+ * Output:          Rate in mHz, rounded
+ *
+ * Side Effects:    None
+ *
+ * Overview:        64 bit so 1024 x 65536 ticks keep their fraction
+ *
+ ********************************************************************/
+
+static uint64_t TRIGGER_Millihertz(uint32_t ticks)
+{
+    return ((uint64_t)trigger_clock * 1000 + ticks / 2) / ticks;
+}
+
+
+/*********************************************************************
+ * Function:        static void TRIGGER_Burst_Off(void)
+ *
+ * PreCondition:    None
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    CCL left disabled
+ *
+ * Overview:        Releases the burst latch, TCBs back to counting
+ *                  TRIG1
+ *
+ ********************************************************************/
+
+static void TRIGGER_Burst_Off(void)
+{
+    if(burst_active)                                                            // Cancelled, keep what was sent
+    {
+        ENTER_CRITICAL(B);
+        count_offset += TRIGGER_Count_Hardware();
+        TRIGGER_Count_Mode();
+        EXIT_CRITICAL(B);
+    }
+    CCL.CTRLA = 0;                                                              // LUT registers locked while enabled
+    CCL.SEQCTRL1 = CCL_SEQSEL_DISABLE_gc;
+    CCL.LUT2CTRLA = 0;
+    CCL.LUT3CTRLA = 0;
+}
+
+
+/*********************************************************************
+ * Function:        static void TRIGGER_Apply(bool start)
+ *
+ * PreCondition:    trigger_config filled in
+ *
+ * Input:           start - false leaves TCA0 stopped for a burst
+ *
+ * Output:          None
+ *
+ * Side Effects:    TCA0 hard reset, any burst cancelled
+ *
+ * Overview:        Loads trigger_config into TCA0 and CCL LUT1
+ *
+ ********************************************************************/
+
+static void TRIGGER_Apply(bool start)
+{
+    /* set waveform output on PORT C */
+    PORTMUX.TCAROUTEA = PORTMUX_TCA0_PORTC_gc;
+
+    TCA0.SINGLE.CTRLA = 0;                                                      // CTRLD can only change while stopped
+    HAL_TimerCommand(&TCA0, TCA_SINGLE_CMD_RESET_gc);
+    TRIGGER_Burst_Off();                                                        // Also disables CCL
+    TRIGGER_Blank_Done(false);                                                  // TRIG1 low until started again
+    if(trigger_sync == TRIGGER_SYNC_SLAVE)
+    {
+        trigger_config.mode = TRIGGER_16BIT;                                    // Restart event, CMP2 and WO2 need it
+    }
+
+    if(trigger_config.mode == TRIGGER_SPLIT)
+    {
+        CCL.LUT1CTRLA = 0;                                                      // PC3 back to TCA0 WO3
+
+        TCA0.SPLIT.CTRLD = TCA_SPLIT_SPLITM_bm;
+        TCA0.SPLIT.CTRLB = TCA_SPLIT_HCMP0EN_bm;    /* enable compare channel 0 for the higher byte */
+        TCA0.SPLIT.HPER = trigger_config.period - 1;
+        TCA0.SPLIT.HCMP0 = trigger_config.compare;
+        TCA0.SPLIT.CTRLA = trigger_config.clksel                               /* set clock source */
+                         | (start ? TCA_SPLIT_ENABLE_bm : 0);                   /* start timer */
+    }
+    else
+    {
+        trigger_delay_ticks = TRIGGER_Delay_Ticks();
+        TCA0.SINGLE.CTRLB = TCA_SINGLE_WGMODE_SINGLESLOPE_gc;                   // No CMPnEN, PC0 and PC2 stay port pins
+        TCA0.SINGLE.PER = trigger_config.period - 1;
+        TCA0.SINGLE.CMP0 = trigger_delay_ticks + trigger_config.compare;
+        TCA0.SINGLE.CMP2 = trigger_delay_ticks;
+        if(trigger_sync == TRIGGER_SYNC_SLAVE)
+        {
+            TCA0.SINGLE.PER = ((trigger_config.period + SYNC_MARGIN(trigger_config.period)) > SINGLE_PERIOD_MAX) ?
+                              (SINGLE_PERIOD_MAX - 1) :
+                              (trigger_config.period + SYNC_MARGIN(trigger_config.period) - 1);
+            TCA0.SINGLE.EVCTRL = TCA_SINGLE_CNTBEI_bm                           // SYNC_IN on CH0
+                               | TCA_SINGLE_EVACTB_RESTART_POSEDGE_gc;
+        }
+
+        CCL.LUT1CTRLB = CCL_INSEL0_TCA0_gc                                      // IN0 = TCA0 WO0
+                      | CCL_INSEL1_MASK_gc;
+        if(trigger_delay_ticks)
+        {
+            CCL.LUT1CTRLC = CCL_INSEL2_TCA0_gc;                                 // IN2 = TCA0 WO2
+            CCL.TRUTH1 = 0x0A;                                                  // OUT = IN0 AND NOT IN2
+        }
+        else
+        {
+            CCL.LUT1CTRLC = CCL_INSEL2_MASK_gc;
+            CCL.TRUTH1 = 0x02;                                                  // OUT = IN0
+        }
+        CCL.LUT1CTRLA = CCL_OUTEN_bm                                            // LUT1 OUT = PC3 = TRIG1
+                      | CCL_ENABLE_bm;
+        CCL.CTRLA = CCL_ENABLE_bm;
+
+        TCA0.SINGLE.CTRLA = trigger_config.clksel
+                          | (start ? TCA_SINGLE_ENABLE_bm : 0);
+    }
+}
+
+
+/*********************************************************************
+ * Function:        ISR(TCB1_INT_vect)
+ *
+ * PreCondition:    Burst running
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Sets burst_done
+ *
+ * Overview:        Last pulse is out and the gate already closed in
+ *                  hardware, stop the timers so TRIG1 stays low
+ *
+ ********************************************************************/
+
+ISR(TCB1_INT_vect)
+{
+    TCA0.SINGLE.CTRLA = 0;
+    count_offset += burst_count;
+    TRIGGER_Count_Mode();                                                       // Clears CAPT
+    TRIGGER_Blank_Done(false);                                                  // Held for the burst
+    if(burst_callback != NULL)
+    {
+        burst_callback();
+    }
+    else
+    {
+        burst_done = true;
+    }
+}
+
+
+/*********************************************************************
+ * Function:        ISR(TCA0_CMP0_vect)
+ *
+ * PreCondition:    Blank started in 16 bit mode
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Disarms itself
+ *
+ * Overview:        First blank period, run the blank callback
+ *
+ ********************************************************************/
+
+ISR(TCA0_CMP0_vect)
+{
+    HAL_ClearFlags(&TCA0.SINGLE.INTFLAGS, TCA_SINGLE_CMP0_bm);
+    if(blank_armed && (TCA0.SINGLE.CMP0 == trigger_delay_ticks))                // Buffer loaded, no pulse this period
+    {
+        TRIGGER_Blank_Done(true);
+    }
+    if(!blank_armed)
+    {
+        TCA0.SINGLE.INTCTRL &= ~TCA_SINGLE_CMP0_bm;
+    }
+}
+
+
+/*********************************************************************
+ * Function:        ISR(TCA0_HUNF_vect)
+ *
+ * PreCondition:    Blank started in split mode
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    Disarms itself
+ *
+ * Overview:        A period ended with HCMP0 already 0, the next one
+ *                  has no pulse
+ *
+ ********************************************************************/
+
+ISR(TCA0_HUNF_vect)
+{
+    HAL_ClearFlags(&TCA0.SPLIT.INTFLAGS, TCA_SPLIT_HUNF_bm);
+    TRIGGER_Blank_Done(true);
+}
+
+
+/*********************************************************************
+ * Function:        static void TRIGGER_Blank_Start(void)
+ *
+ * PreCondition:    TCA0 running, interrupts off
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    TCA0 CMP0 or HUNF interrupt enabled
+ *
+ * Overview:        Zero width compare, acted on from the next period
+ *                  so a pulse already high is finished
+ *
+ ********************************************************************/
+
+static void TRIGGER_Blank_Start(void)
+{
+    if(trigger_config.mode == TRIGGER_SPLIT)
+    {
+        TCA0.SPLIT.HCMP0 = 0;                                                   // No buffer, high ticks end at HUNF
+        HAL_ClearFlags(&TCA0.SPLIT.INTFLAGS, TCA_SPLIT_HUNF_bm);
+        TCA0.SPLIT.INTCTRL |= TCA_SPLIT_HUNF_bm;
+    }
+    else
+    {
+        TCA0.SINGLE.CMP0BUF = trigger_delay_ticks;                              // CMP0 = CMP2, WO0 AND NOT WO2 never high
+        HAL_ClearFlags(&TCA0.SINGLE.INTFLAGS, TCA_SINGLE_CMP0_bm);
+        TCA0.SINGLE.INTCTRL |= TCA_SINGLE_CMP0_bm;
+    }
+    blank_armed = true;
+}
+
+
+/*********************************************************************
+ * Function:        static void TRIGGER_Blank_Done(bool restore)
+ *
+ * PreCondition:    Interrupts off, TRIG1 held low
+ *
+ * Input:           restore - put the compare back, false when TCA0
+ *                  is stopped and about to be set up again
+ *
+ * Output:          None
+ *
+ * Side Effects:    Runs and clears blank_callback
+ *
+ * Overview:        The callback goes first, a 16 bit compare written
+ *                  back can load at the next UPDATE, a tick later at
+ *                  the fastest rates
+ *
+ ********************************************************************/
+
+static void TRIGGER_Blank_Done(bool restore)
+{
+    void (*callback)(void) = blank_callback;
+
+    blank_callback = NULL;
+    if(callback != NULL)
+    {
+        callback();
+    }
+    if(blank_armed && restore)
+    {
+        if(trigger_config.mode == TRIGGER_SPLIT)
+        {
+            TCA0.SPLIT.HCMP0 = trigger_config.compare;
+            TCA0.SPLIT.INTCTRL &= ~TCA_SPLIT_HUNF_bm;
+        }
+        else
+        {
+            TCA0.SINGLE.CMP0BUF = trigger_delay_ticks + trigger_config.compare;
+            TCA0.SINGLE.INTCTRL &= ~TCA_SINGLE_CMP0_bm;
+        }
+    }
+    blank_armed = false;
+}
+
+
+/*********************************************************************
+ * Function:        static void TRIGGER_Count_Mode(void)
+ *
+ * PreCondition:    EVSYS channels 2 and 3 set up
+ *
+ * Input:           None
+ *
+ * Output:          None
+ *
+ * Side Effects:    TCB0 and TCB1 cleared, ends burst_active
+ *
+ * Overview:        32 bit free running count of TRIG1 rising edges
+ *
+ ********************************************************************/
+
+static void TRIGGER_Count_Mode(void)
+{
+    TCB0.CTRLA = 0;
+    TCB1.CTRLA = 0;
+    TCB1.INTCTRL = 0;
+    HAL_ClearFlags(&TCB1.INTFLAGS, TCB_CAPT_bm);
+    burst_active = false;
+
+    EVSYS.USERTCB0COUNT = EVSYS_USER_CHANNEL2_gc;
+    TCB0.CTRLB = TCB_CNTMODE_INT_gc;
+    TCB0.CCMP = 0xFFFF;                                                         // Full 16 bits, OVF carries
+    TCB0.CNT = 0;
+    TCB1.CTRLB = TCB_CNTMODE_INT_gc;
+    TCB1.CCMP = 0xFFFF;
+    TCB1.CNT = 0;
+    TCB1.CTRLA = TCB_CLKSEL_EVENT_gc | TCB_CASCADE_bm | TCB_ENABLE_bm;
+    TCB0.CTRLA = TCB_CLKSEL_EVENT_gc | TCB_ENABLE_bm;
+}
+
+
+/*********************************************************************
+ * Function:        static uint32_t TRIGGER_Count_Hardware(void)
+ *
+ * PreCondition:    Interrupts off, the TCB ISR and this share TEMP
+ *
+ * Input:           None
+ *
+ * Output:          Pulses counted since the TCBs were last set up
+ *
+ * Side Effects:    None
+ *
+ * Overview:        Reads the high word twice so a carry between the
+ *                  two reads is caught
+ *
+ ********************************************************************/
+
+static uint32_t TRIGGER_Count_Hardware(void)
+{
+    uint16_t high, low;
+
+    if(burst_active && (TCB1.INTFLAGS & TCB_CAPT_bm))
+    {
+        return burst_count;                                                     // Done, ISR not run yet
+    }
+    do
+    {
+        high = TCB1.CNT;
+        low = TCB0.CNT;
+    } while(high != TCB1.CNT);
+
+    if(burst_active)
+    {
+        return (((uint32_t)high << 16) | low) - (uint16_t)(0 - burst_count);    // Started from the preset
+    }
+    return ((uint32_t)high << 16) | low;
+}
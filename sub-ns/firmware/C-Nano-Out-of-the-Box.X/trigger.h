@@ -0,0 +1,80 @@
+/*********************************************************************
+ *
+ *              Water Monitor Internal Trigger Header
+ *
+ *********************************************************************
+ * FileName:        trigger.h
+ * Dependencies:    mcc_generated_files/mcc.h
+ * Processor:       AVR64DD32
+ * Compiler:        MPLAB XC8 Compiler
+ *
+ * Description:
+ *
+ * TCA0 internal trigger on TRIG1 = PC3.  8 bit split mode drives PC3
+ * from HCMP0 (WO3) as before.  Rates split mode can't reach use 16 bit
+ * single slope mode, its WO0 pin is OE6 = PC0 so the waveform is
+ * taken to PC3 through CCL LUT1 instead.  TCB0/TCB1 count pulses on
+ * PC3, burst mode also uses EVSYS channels 1 to 5 and CCL LUT2/LUT3.
+ *
+ * Boards run together over a shared sync line.  The master copies
+ * TRIG1 to SYNC_OUT = PA2 (EVOUTA).  Slaves take SYNC_IN = PA3 on EVSYS
+ * channel 0 and restart TCA0 on its rising edge, each after its own
+ * delay.
+ *
+ ********************************************************************/
+
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include "mcc_generated_files/mcc.h"
+
+#define TRIGGER_MIN_HZ      1UL
+#define TRIGGER_MAX_HZ      (TRIGGER_GetClock() / 2)                            // Two ticks, one high one low
+
+typedef enum {TRIGGER_SPLIT, TRIGGER_16BIT} trigger_mode_t;
+typedef enum {TRIGGER_WIDTH_TICKS, TRIGGER_WIDTH_NS, TRIGGER_WIDTH_PERCENT} trigger_width_t;
+typedef enum {TRIGGER_SYNC_OFF, TRIGGER_SYNC_MASTER, TRIGGER_SYNC_SLAVE} trigger_sync_t;
+
+typedef struct
+{
+    trigger_mode_t mode;
+    uint8_t clksel;                                                             // TCA_SINGLE_CLKSEL_x_gc
+    uint16_t divider;                                                           // Prescaler value for clksel
+    uint32_t period;                                                            // Ticks per trigger, PER + 1
+    uint16_t compare;                                                           // Ticks high, pulse width
+} trigger_config_t;
+
+typedef struct
+{
+    trigger_config_t timer;
+    trigger_width_t width_unit;                                                 // NS or PERCENT
+    uint32_t width;
+    bool running;                                                               // Free running, bursts are not kept
+    trigger_sync_t sync;
+    uint32_t delay;                                                             // Slave delay, ns
+} trigger_state_t;
+
+void TRIGGER_Initialize(void);                                                  // Starts the pulse counter
+bool TRIGGER_SetFrequency(uint32_t hz);                                         // False if out of range
+bool TRIGGER_SetWidth(trigger_width_t unit, uint32_t value);                    // False if not 1 to period - 1 ticks
+uint32_t TRIGGER_GetWidthNs(void);                                              // Applied pulse width
+void TRIGGER_SetPreset(uint8_t speed);                                          // Legacy 'S' and 'F' settings
+void TRIGGER_Stop(void);                                                        // Waveform off, TRIG1 low
+bool TRIGGER_StartBurst(uint32_t pulses);                                       // Exactly pulses triggers, then stop
+bool TRIGGER_BurstDone(uint32_t *pulses);                                       // True once per finished burst
+uint32_t TRIGGER_GetCount(bool reset);                                          // Pulses on TRIG1, optionally zeroed
+void TRIGGER_SetBurstCallback(void (*callback)(void));                          // Burst end, interrupt context
+void TRIGGER_AtBlank(void (*callback)(void));                                   // TRIG1 held low, interrupt context
+void TRIGGER_SetClock(uint32_t hz);                                             // CLK_PER changed, keeps the rate
+bool TRIGGER_SetSync(trigger_sync_t sync, uint32_t delay_ns);                   // False if the delay leaves no gap
+trigger_sync_t TRIGGER_GetSync(uint32_t *delay_ns);                             // Delay as applied, whole ticks
+uint32_t TRIGGER_GetClock(void);
+void TRIGGER_Run(void);                                                         // Free running, 16 bit mode
+void TRIGGER_Pause(void);                                                       // Stopped, rate kept
+const trigger_config_t *TRIGGER_GetConfig(void);
+uint32_t TRIGGER_GetFrequency(uint16_t *millihertz);                            // Achieved rate, Hz and fraction
+int32_t TRIGGER_GetErrorPpm(uint32_t hz);                                       // Achieved against requested
+void TRIGGER_GetState(trigger_state_t *state);                                  // Everything needed to restore
+bool TRIGGER_SetState(const trigger_state_t *state);                            // False if the state is not valid
+
+#endif /* TRIGGER_H */